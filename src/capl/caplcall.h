@@ -0,0 +1,358 @@
+/**
+ * @file caplcall.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Calls of CAPL functions with the parameter block built from the C++ signature.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * VIACaplFunction::Call takes the parameters as one block of memory laid
+ * out like a call stack:
+ *
+ *   64 bit: the parameters in order, 8 bytes each. An array takes 16 bytes,
+ *           the pointer first, then the number of elements.
+ *   32 bit: the parameters in reverse order, the last one at offset 0,
+ *           4 bytes each and 8 for a double. An array takes 8 bytes, the
+ *           number of elements first, then the pointer.
+ *
+ * CaplCallback<R(Args...)> works out every offset at compile time from Args,
+ * so a call is a few stores into a block on the stack. Bind checks the
+ * result type, the number and the types of the parameters against the CAPL
+ * function once, a function with another signature is not bound.
+ *
+ * CaplOffset and CaplParam<T>::Load read a block back with the same layout,
+ * for the CAPL side of the host tools.
+ */
+#ifndef CAPLCALL_H
+#define CAPLCALL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#include "VIA.h"
+#include "VIA_CDLL.h"
+
+/* Bytes of one parameter word on the CAPL call stack. */
+static const size_t kCaplWord = sizeof(void*);
+
+/**
+ * @brief A CAPL array parameter: elements and their number.
+ */
+template <typename T>
+struct CaplArray
+{
+    CaplArray(T* elements, uint32_t count) : data(elements), size(count) {}
+
+    /* A C array, e.g. a string literal with its terminating zero. No strlen. */
+    template <size_t N>
+    CaplArray(T (&elements)[N]) : data(elements), size((uint32_t)N) {}
+
+    T*       data;
+    uint32_t size;
+};
+
+/* A CAPL char array, the size counts the terminating zero. */
+typedef CaplArray<const char> CaplString;
+
+/* A zero terminated string of unknown length, the length is counted here. */
+inline CaplString CaplText(const char* text)
+{
+    return CaplString(text, (uint32_t)strlen(text) + 1);
+}
+
+/**
+ * @brief CAPL type letter and stack size of a C++ parameter type.
+ *
+ * Scalars are widened to a full word, so no byte of their slot is left
+ * undefined.
+ */
+template <typename T>
+struct CaplParam;
+
+template <typename T, char Type>
+struct CaplIntegerParam
+{
+    static const char   kType  = Type;
+    static const size_t kBytes = kCaplWord;
+
+    static void Store(uint8_t* at, T value)
+    {
+        uintptr_t word = std::is_signed<T>::value ? (uintptr_t)(intptr_t)value : (uintptr_t)value;
+        memcpy(at, &word, sizeof(word));
+    }
+
+    static T Load(const uint8_t* at)
+    {
+        uintptr_t word;
+        memcpy(&word, at, sizeof(word));
+        return (T)word;
+    }
+};
+
+template <> struct CaplParam<int32_t>  : CaplIntegerParam<int32_t, 'L'> {};
+template <> struct CaplParam<uint32_t> : CaplIntegerParam<uint32_t, 'D'> {};
+template <> struct CaplParam<int16_t>  : CaplIntegerParam<int16_t, 'I'> {};
+template <> struct CaplParam<uint16_t> : CaplIntegerParam<uint16_t, 'W'> {};
+template <> struct CaplParam<uint8_t>  : CaplIntegerParam<uint8_t, 'B'> {};
+template <> struct CaplParam<char>     : CaplIntegerParam<char, 'C'> {};
+
+template <>
+struct CaplParam<double>
+{
+    static const char   kType  = 'F';
+    static const size_t kBytes = 8;
+
+    static void Store(uint8_t* at, double value) { memcpy(at, &value, sizeof(value)); }
+
+    static double Load(const uint8_t* at)
+    {
+        double value;
+        memcpy(&value, at, sizeof(value));
+        return value;
+    }
+};
+
+template <typename T>
+struct CaplParam<CaplArray<T> >
+{
+    static const char   kType  = CaplParam<typename std::remove_const<T>::type>::kType;
+    static const size_t kBytes = 2 * kCaplWord;
+
+    static void Store(uint8_t* at, const CaplArray<T>& array)
+    {
+        uintptr_t size = array.size;
+        if (kCaplWord == 8)
+        {
+            memcpy(at, &array.data, sizeof(array.data));
+            memcpy(at + kCaplWord, &size, sizeof(size));
+        }
+        else
+        {
+            memcpy(at, &size, sizeof(size));
+            memcpy(at + kCaplWord, &array.data, sizeof(array.data));
+        }
+    }
+
+    static CaplArray<T> Load(const uint8_t* at)
+    {
+        T* data;
+        uintptr_t size;
+        memcpy(&data, at + (kCaplWord == 8 ? 0 : kCaplWord), sizeof(data));
+        memcpy(&size, at + (kCaplWord == 8 ? kCaplWord : 0), sizeof(size));
+        return CaplArray<T>(data, (uint32_t)size);
+    }
+};
+
+/**
+ * @brief Size and layout of a parameter list.
+ */
+template <typename... Args>
+struct CaplPack;
+
+template <>
+struct CaplPack<>
+{
+    static const size_t kSize = 0;
+
+    static void Store(uint8_t* params) { (void)params; }
+};
+
+template <typename First, typename... Rest>
+struct CaplPack<First, Rest...>
+{
+    static const size_t kSize = CaplParam<First>::kBytes + CaplPack<Rest...>::kSize;
+
+    static void Store(uint8_t* params, const First& first, const Rest&... rest)
+    {
+        if (kCaplWord == 8)
+        {
+            /* in order: first at the start, the rest behind it */
+            CaplParam<First>::Store(params, first);
+            CaplPack<Rest...>::Store(params + CaplParam<First>::kBytes, rest...);
+        }
+        else
+        {
+            /* reverse order: the rest at the start, first behind it */
+            CaplParam<First>::Store(params + CaplPack<Rest...>::kSize, first);
+            CaplPack<Rest...>::Store(params, rest...);
+        }
+    }
+};
+
+/**
+ * @brief Offset of parameter I in the block of a parameter list.
+ */
+template <size_t I, typename... Args>
+struct CaplOffset;
+
+template <typename First, typename... Rest>
+struct CaplOffset<0, First, Rest...>
+{
+    /* 64 bit: at the start, 32 bit: behind the rest */
+    static const size_t kValue = kCaplWord == 8 ? 0 : CaplPack<Rest...>::kSize;
+};
+
+template <size_t I, typename First, typename... Rest>
+struct CaplOffset<I, First, Rest...>
+{
+    static const size_t kValue = (kCaplWord == 8 ? CaplParam<First>::kBytes : 0) + CaplOffset<I - 1, Rest...>::kValue;
+};
+
+/**
+ * @brief Result type letter and how the result is fetched.
+ */
+template <typename R>
+struct CaplResult;
+
+template <>
+struct CaplResult<void>
+{
+    static const char kType = 'V';
+
+    static VIAResult Call(VIACaplFunction* function, void* result, void* params)
+    {
+        (void)result;
+        uint32 ignored;
+        return function->Call(&ignored, params);
+    }
+};
+
+template <typename R, char Type>
+struct CaplIntegerResult
+{
+    static const char kType = Type;
+
+    static VIAResult Call(VIACaplFunction* function, R* result, void* params)
+    {
+        uint32 value = 0;
+        VIAResult rc = function->Call(&value, params);
+        if (result != nullptr)
+        {
+            *result = (R)value;
+        }
+        return rc;
+    }
+};
+
+template <> struct CaplResult<uint32_t> : CaplIntegerResult<uint32_t, 'D'> {};
+template <> struct CaplResult<int32_t>  : CaplIntegerResult<int32_t, 'L'> {};
+
+template <>
+struct CaplResult<double>
+{
+    static const char kType = 'F';
+
+    static VIAResult Call(VIACaplFunction* function, double* result, void* params)
+    {
+        double value = 0.0;
+        VIAResult rc = function->CallReturnsDouble(&value, params);
+        if (result != nullptr)
+        {
+            *result = value;
+        }
+        return rc;
+    }
+};
+
+/**
+ * @brief A CAPL function called with a fixed C++ signature.
+ */
+template <typename Signature>
+class CaplCallback;
+
+template <typename R, typename... Args>
+class CaplCallback<R(Args...)>
+{
+public:
+    /* Bytes of the parameter block. */
+    static const size_t kParamSize = CaplPack<Args...>::kSize;
+
+    CaplCallback() : mCapl(nullptr), mFunction(nullptr) {}
+
+    /*
+     * Look up the CAPL function name of capl. Returns false and stays unbound
+     * if the program has no such function or its signature differs.
+     */
+    bool Bind(VIACapl* capl, const char* name)
+    {
+        Release();
+        VIACaplFunction* function = nullptr;
+        if (capl == nullptr || capl->GetCaplFunction(&function, name) != kVIA_OK || function == nullptr)
+        {
+            return false;
+        }
+        if (!Matches(function))
+        {
+            capl->ReleaseCaplFunction(function);
+            return false;
+        }
+        mCapl = capl;
+        mFunction = function;
+        return true;
+    }
+
+    /* Give the function handle back, at the latest at the end of the measurement. */
+    void Release()
+    {
+        if (mFunction != nullptr)
+        {
+            mCapl->ReleaseCaplFunction(mFunction);
+        }
+        mCapl = nullptr;
+        mFunction = nullptr;
+    }
+
+    bool IsBound() const { return mFunction != nullptr; }
+
+    /*
+     * Call the CAPL function, result may be nullptr. Returns
+     * kVIA_ObjectNotFound if the function is not bound.
+     */
+    VIAResult Call(R* result, Args... args) const
+    {
+        if (mFunction == nullptr)
+        {
+            return kVIA_ObjectNotFound;
+        }
+        /* at least one byte, a function without parameters still gets a valid pointer */
+        uint8_t params[kParamSize > 0 ? kParamSize : 1];
+        CaplPack<Args...>::Store(params, args...);
+        return CaplResult<R>::Call(mFunction, result, params);
+    }
+
+private:
+    CaplCallback(const CaplCallback&);
+    CaplCallback& operator=(const CaplCallback&);
+
+    static bool Matches(VIACaplFunction* function)
+    {
+        static const char types[sizeof...(Args) + 1] = {CaplParam<Args>::kType..., '\0'};
+        char type;
+        int32 count;
+
+        if (function->ResultType(&type) != kVIA_OK || type != CaplResult<R>::kType)
+        {
+            return false;
+        }
+        if (function->ParamCount(&count) != kVIA_OK || count != (int32)sizeof...(Args))
+        {
+            return false;
+        }
+        for (int32 i = 0; i < count; i++)
+        {
+            if (function->ParamType(&type, i) != kVIA_OK || type != types[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    VIACapl*         mCapl;
+    VIACaplFunction* mFunction;
+};
+
+#endif
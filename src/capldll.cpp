@@ -37,22 +37,36 @@
 #include "VIA_CDLL.h"
 #include "usbtmc.h"
 #include "RdWrtSrl.h"
+#include "itechdc.h"
+#include "opstats.h"
+#include "tracer.h"
+#include "flightrec.h"
+#include "minilogger.h"
+#include "ratelimit.h"
+#include "epoch.h"
+#include "handletable.h"
+#include "caplcall.h"
+#include "sampler.h"
+#include "monitor.h"
+#include "srqwatch.h"
+#include "settle.h"
+#include "sequence.h"
+#include "listmode.h"
+#include "datalog.h"
 
 
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <map>
-
-#if defined(_WIN64) || defined(__linux__)
-  #define X64
-#endif
+#include <mutex>
+#include <string>
+#include <vector>
 
 
 class CaplInstanceData;
-typedef std::map<uint32_t, CaplInstanceData*> VCaplMap;
-typedef std::map<uint32_t, VIACapl*> VServiceMap;
+typedef HandleTable<CaplInstanceData> VCaplTable;
+typedef HandleTable<VIACapl> VServiceTable;
 
 
 // ============================================================================
@@ -62,8 +76,60 @@ typedef std::map<uint32_t, VIACapl*> VServiceMap;
 static uint32_t data = 0;
 static char dlldata[100];
 
-VCaplMap    gCaplMap;
-VServiceMap gServiceMap;
+// Looked up by every exported function, see handletable.h. An instance
+// removed by appEnd is deleted through EpochRetire, so lookups and every use
+// of the instance belong inside an EpochGuard.
+VCaplTable    gCaplTable;
+VServiceTable gServiceTable;
+VIAService* gVIAService = nullptr;
+
+
+// ============================================================================
+// CANoe Write window
+//
+// Warnings and errors of the dll are written to the Write window through the
+// debug info service. A limiter merges repeated lines and caps the rate, so a
+// dead device cannot flood the Write window and slow the measurement.
+// ============================================================================
+
+#define WRITE_WINDOW_LINES_PER_SECOND 5.0
+#define WRITE_WINDOW_BURST            20.0
+#define WRITE_WINDOW_MERGE_NS         10000000000ULL
+
+static VIADebugInfoService* gDebugInfo = nullptr;
+static std::mutex           gDebugInfoMutex;
+
+static void sWriteDebugInfo(void* context, const char* text)
+{
+  (void)context;
+  std::lock_guard<std::mutex> lock(gDebugInfoMutex);
+  if (gDebugInfo!=nullptr)
+  {
+    gDebugInfo->WriteLogMessage("ITECHDC", text);
+  }
+}
+
+static LogRateLimiter gWriteWindowLimiter(WRITE_WINDOW_LINES_PER_SECOND, WRITE_WINDOW_BURST,
+                                          WRITE_WINDOW_MERGE_NS, sWriteDebugInfo, nullptr);
+
+static void sWriteWindowSink(int level, const char* text)
+{
+  (void)level;
+  gWriteWindowLimiter.Submit(text, LogClockNs());
+}
+
+// Stop writing to the Write window and give the debug info service back.
+static void sCloseWriteWindow()
+{
+  FileLoggerSetSink(nullptr, LOG_LEVEL_OFF);
+  gWriteWindowLimiter.Flush(LogClockNs());
+  std::lock_guard<std::mutex> lock(gDebugInfoMutex);
+  if (gDebugInfo!=nullptr)
+  {
+    gDebugInfo->Release();
+    gDebugInfo = nullptr;
+  }
+}
 
 
 // ============================================================================
@@ -74,8 +140,26 @@ VServiceMap gServiceMap;
 // A CAPL-DLL can be used by more than one CAPL-Block, so every piece of
 // information thats like a global variable in CAPL, must now be wrapped into
 // an instance of an object.
+//
+// Each block also owns its instruments: the sessions opened by the
+// dllItechNode* functions stay open until dllEnd and are not shared with
+// other blocks.
+//
+// Samples of dllItechSampleStart and the rules of dllItechRuleAdd are
+// measured on threads of the block, dllItechSrqStart waits for service
+// requests, dllItechSeqStart runs its steps and dllItechListRun chains the
+// LIST slots of the supplies on threads of the block.
+// Batches, rule events, requests and step results are handed to CAPL from
+// one VIA timer, which rings on the measurement thread like every other
+// CAPL event.
 // ============================================================================
-class CaplInstanceData
+
+// A service request reaches CAPL at most this late, the timer cannot ring on the SRQ itself.
+#define SRQ_DELIVERY_TICK_NS      1000000ULL
+// Step results reach CAPL at most this late, the steps themselves do not wait for CAPL.
+#define SEQUENCE_DELIVERY_TICK_NS 10000000ULL
+
+class CaplInstanceData final : public VIAOnTimerSink
 {
 public:
   CaplInstanceData(VIACapl* capl);
@@ -83,160 +167,189 @@ public:
   void GetCallbackFunctions();
   void ReleaseCallbackFunctions();
 
+  ItechDcContext& Devices() { return mDevices; }
+
   // Definition of the class function.
   // This class function will call the CAPL callback functions
   uint32_t ShowValue(uint32_t x);
   uint32_t ShowDates(int16_t x, uint32_t y, int16_t z);
-  void     DllInfo(const char* x);
-  void     ArrayValues(uint32_t flags, uint32_t numberOfDatabytes, uint8_t databytes[], uint8_t controlcode);
-  void     DllVersion(const char* y);
+  void     DllInfo(CaplString x);
+  void     ArrayValues(uint32_t flags, CaplArray<uint8_t> databytes, uint8_t controlcode);
+  void     DllVersion(CaplString y);
+
+  // Batched sample delivery to CALLBACK_ItechSamples
+  int32_t  StartSamples(TransportKind kind, int32_t device, const char* command, int32_t periodUs, int32_t batchSize, int32_t maxLatencyMs);
+  int32_t  StopSamples(bool deliver);
+
+  // Rule events delivered to CALLBACK_ItechRule
+  RuleMonitor& Rules() { return mMonitor; }
+  int32_t  StartMonitor(TransportKind kind, int32_t periodUs);
+  int32_t  StopMonitor(bool deliver);
+
+  // Service requests delivered to CALLBACK_ItechSrq
+  int32_t  StartRequests(TransportKind kind, int32_t serviceEnable, int32_t eventEnable, int32_t questionableEnable, int32_t pollUs);
+  int32_t  StopRequests(bool deliver);
+
+  // Timed steps, results delivered to CALLBACK_ItechSeqStep and CALLBACK_ItechSeqDone
+  SequenceRunner& Sequence() { return mSequence; }
+  int32_t  StartSequence(TransportKind kind);
+  int32_t  AbortSequence(bool deliver);
+
+  // Profiles run by the LIST mode of the supplies
+  ListRunner& List() { return mList; }
+  int32_t  LoadList(TransportKind kind, const double* values, int32_t count);
+  int32_t  RunList();
+
+  // Acquisitions in the memory of the supplies, read back in one block
+  int32_t  ConfigureDatalog(TransportKind kind, int32_t intervalUs, int32_t points, int32_t source);
+  int32_t  SendDatalog(const char* command);
+  int32_t  ReadDatalog(int32_t device, const char* command, double* values, int32_t count, int32_t timeoutMs);
+
+  // Stop sampling, monitoring, watching, the sequence and the list without delivering, give the timer back
+  void     StopMeasuring();
+  VIASTDDECL OnTimer(VIATime nanoseconds);
 
 private:
-
-  // Pointer of the CAPL callback functions
-  VIACaplFunction*  mShowValue;
-  VIACaplFunction*  mShowDates;
-  VIACaplFunction*  mDllInfo;
-  VIACaplFunction*  mArrayValues;
-  VIACaplFunction*  mDllVersion;
+  static int sMeasureSample(void* context, double* value);
+  static int sMeasureRule(void* context, int device, const char* command, double* value);
+  static int sQueryStatus(void* context, int device, const char* command, double* value);
+  static int sSendStep(void* context, const char* command);
+  static int sListExchange(void* context, const char* command, double* value);
+  static int sListStatus(void* context, const char* command, double* value);
+  bool       CreateTimer();
+  void       ArmTimer();
+  void       DeliverSamples(VIATime now, bool all);
+  void       DeliverEvents(VIATime now);
+  void       DeliverRequests(VIATime now);
+  void       DeliverSteps(VIATime now);
+  bool       DatalogSettings(TransportKind* kind, DatalogFormat* format) const;
+
+  // The CAPL callback functions, the call stack layout follows from the signature
+  CaplCallback<uint32_t(uint32_t)>                           mShowValue;
+  CaplCallback<uint32_t(int16_t, uint32_t, int16_t)>         mShowDates;
+  CaplCallback<void(CaplString)>                             mDllInfo;
+  CaplCallback<void(uint32_t, CaplArray<uint8_t>, uint8_t)>  mArrayValues;
+  CaplCallback<void(CaplString)>                             mDllVersion;
+  CaplCallback<void(CaplArray<double>, uint32_t, double)>    mSamples;
+  CaplCallback<void(int32_t, int32_t, double, double, double)> mRuleEvent;
+  CaplCallback<void(int32_t, int32_t, int32_t, int32_t, double)> mRequest;
+  CaplCallback<void(int32_t, int32_t, double, double)>       mSequenceStep;
+  CaplCallback<void(int32_t, int32_t, double)>               mSequenceDone;
 
   VIACapl*          mCapl;
+  ItechDcContext    mDevices;   // instrument sessions of this block
+
+  VIATimer*           mTimer;          // delivers samples, rule events, requests and step results
+
+  SampleStream        mSampleStream;
+  VIATime             mSampleTick;     // ring interval of mTimer while sampling
+  TransportKind       mSampleKind;
+  int32_t             mSampleDevice;
+  std::string         mSampleCommand;
+  std::vector<double> mSampleBatch;
+
+  RuleMonitor            mMonitor;
+  VIATime                mMonitorTick; // ring interval of mTimer while monitoring
+  TransportKind          mMonitorKind;
+  std::vector<RuleEvent> mEvents;
+
+  ServiceRequestWatcher            mWatcher;
+  TransportKind                    mWatchKind;
+  std::vector<ServiceRequestEvent> mRequests;
+
+  SequenceRunner                  mSequence;
+  TransportKind                   mSequenceKind;
+  bool                            mSequencePending; // started, CALLBACK_ItechSeqDone not called yet
+  size_t                          mStepsDelivered;
+  std::vector<SequenceStepResult> mSteps;
+
+  // The contexts of the list calls, one per port: the runner keeps the one of the Load.
+  struct ListPort
+  {
+    CaplInstanceData* inst;
+    TransportKind     kind;
+  };
+  ListPort                        mListUsb;
+  ListPort                        mListSerial;
+  ListRunner                      mList;
+
+  // The Dlog functions are thread safe: the settings are written and read under the mutex
+  mutable std::mutex              mDatalogMutex;
+  TransportKind                   mDatalogKind;
+  DatalogFormat                   mDatalogFormat;
+  bool                            mDatalogConfigured;
 };
 
 
 CaplInstanceData::CaplInstanceData(VIACapl* capl)
-  // This function will initialize the CAPL callback function
-  // with the NLL Pointer
  : mCapl(capl),
-   mShowValue(nullptr),
-   mShowDates(nullptr),
-   mDllInfo(nullptr),
-   mArrayValues(nullptr),
-   mDllVersion(nullptr)
+   mTimer(nullptr),
+   mSampleTick(0),
+   mSampleKind(kTransportUsb),
+   mSampleDevice(0),
+   mMonitorTick(0),
+   mMonitorKind(kTransportUsb),
+   mWatchKind(kTransportUsb),
+   mSequenceKind(kTransportUsb),
+   mSequencePending(false),
+   mStepsDelivered(0),
+   mListUsb{this, kTransportUsb},
+   mListSerial{this, kTransportSerial},
+   mDatalogKind(kTransportUsb),
+   mDatalogFormat(kDatalogAscii),
+   mDatalogConfigured(false)
 {}
 
-static bool sCheckParams(VIACaplFunction* f, char rtype, const char* ptype)
-{
-  char      type;
-  int32_t   pcount;
-  VIAResult rc;
-
-  // check return type
-  rc = f->ResultType(&type);
-  if (rc!=kVIA_OK || type!=rtype)
-  {
-    return false;
-  }
-
-  // check number of parameters
-  rc = f->ParamCount(&pcount);
-  if (rc!=kVIA_OK || strlen(ptype)!=pcount )
-  {
-    return false;
-  }
-
-  // check type of parameters
-  for (int32_t i=0; i<pcount; ++i)
-  {
-    rc = f->ParamType(&type, i);
-    if (rc!=kVIA_OK || type!=ptype[i])
-    {
-      return false;
-    }
-  }
-
-  return true;
-}
-
-static VIACaplFunction* sGetCaplFunc(VIACapl* capl, const char* fname, char rtype, const char* ptype)
-{
-  VIACaplFunction* f;
-
-  // get capl function object
-  VIAResult rc =  capl->GetCaplFunction(&f, fname);
-  if (rc!=kVIA_OK || f==nullptr)
-  {
-    return nullptr;
-  }
-
-  // check signature of function
-  if ( sCheckParams(f, rtype, ptype) )
-  {
-     return f;
-  }
-  else
-  {
-    capl->ReleaseCaplFunction(f);
-    return nullptr;
-  }
-}
-
 void CaplInstanceData::GetCallbackFunctions()
 {
   // Get a CAPL function handle. The handle stays valid until end of
-  // measurement or a call of ReleaseCaplFunction.
-  mShowValue   = sGetCaplFunc(mCapl, "CALLBACK_ShowValue", 'D', "D");
-  mShowDates   = sGetCaplFunc(mCapl, "CALLBACK_ShowDates", 'D', "IDI");
-  mDllInfo     = sGetCaplFunc(mCapl, "CALLBACK_DllInfo", 'V', "C");
-  mArrayValues = sGetCaplFunc(mCapl, "CALLBACK_ArrayValues", 'V', "DBB");
-  mDllVersion  = sGetCaplFunc(mCapl, "CALLBACK_DllVersion", 'V', "C");
+  // measurement or a call of ReleaseCaplFunction. A function whose
+  // signature differs from the member's is not bound.
+  mShowValue.Bind(mCapl, "CALLBACK_ShowValue");
+  mShowDates.Bind(mCapl, "CALLBACK_ShowDates");
+  mDllInfo.Bind(mCapl, "CALLBACK_DllInfo");
+  mArrayValues.Bind(mCapl, "CALLBACK_ArrayValues");
+  mDllVersion.Bind(mCapl, "CALLBACK_DllVersion");
+  mSamples.Bind(mCapl, "CALLBACK_ItechSamples");
+  mRuleEvent.Bind(mCapl, "CALLBACK_ItechRule");
+  mRequest.Bind(mCapl, "CALLBACK_ItechSrq");
+  mSequenceStep.Bind(mCapl, "CALLBACK_ItechSeqStep");
+  mSequenceDone.Bind(mCapl, "CALLBACK_ItechSeqDone");
 }
 
 void CaplInstanceData::ReleaseCallbackFunctions()
 {
   // Release all the requested Callback functions
-  mCapl->ReleaseCaplFunction(mShowValue);
-  mShowValue = nullptr;
-  mCapl->ReleaseCaplFunction(mShowDates);
-  mShowDates = nullptr;
-  mCapl->ReleaseCaplFunction(mDllInfo);
-  mDllInfo = nullptr;
-  mCapl->ReleaseCaplFunction(mArrayValues);
-  mArrayValues = nullptr;
-  mCapl->ReleaseCaplFunction(mDllVersion);
-  mDllVersion = nullptr;
+  mShowValue.Release();
+  mShowDates.Release();
+  mDllInfo.Release();
+  mArrayValues.Release();
+  mDllVersion.Release();
+  mSamples.Release();
+  mRuleEvent.Release();
+  mRequest.Release();
+  mSequenceStep.Release();
+  mSequenceDone.Release();
 }
 
-void CaplInstanceData::DllVersion(const char* y)
+void CaplInstanceData::DllVersion(CaplString y)
 {
-  // Prepare the parameters for the call stack of CAPL.
-  // Arrays uses a 8 byte (64 bit DLL: 12 byte) on the stack, 4 Bytes for the number of element,
-  // and 4 bytes (64 bit DLL: 8 byte) for the pointer to the array
-  int32_t sizeX = (int32_t)strlen(y)+1;
-
-#if defined(X64)
-  uint8_t params[16];              // parameters for call stack, 16 Bytes total (8 bytes per parameter, reverse order of parameters)
-  memcpy(params+8, &sizeX, 4);   // array size    of first parameter, 4 Bytes
-  memcpy(params+0, &y,     8);   // array pointer of first parameter, 8 Bytes
-#else
-  uint8_t params[8];               // parameters for call stack, 8 Bytes total
-  memcpy(params+0, &sizeX, 4);   // array size    of first parameter, 4 Bytes
-  memcpy(params+4, &y,     4);   // array pointer of first parameter, 4 Bytes
-#endif
-
-  if(mDllVersion!=nullptr)
+  if (mDllVersion.IsBound())
   {
-    uint32_t result; // dummy variable
-    VIAResult rc =  mDllVersion->Call(&result, params);
+    TraceScope trace(kTraceCallback, "CALLBACK_DllVersion", nullptr);
+    mDllVersion.Call(nullptr, y);
   }
 }
 
 
 uint32_t CaplInstanceData::ShowValue(uint32_t x)
 {
-#if defined(X64)
-  uint8_t params[8];               // parameters for call stack, 8 Bytes total
-  memcpy(params + 0, &x, 8);     // first parameter, 8 Bytes
-#else
-  void* params = &x;   // parameters for call stack
-#endif
-
   uint32_t result;
 
-  if(mShowValue!=nullptr)
+  if (mShowValue.IsBound())
   {
-    VIAResult rc =  mShowValue->Call(&result, params);
-    if (rc==kVIA_OK)
+    TraceScope trace(kTraceCallback, "CALLBACK_ShowValue", nullptr);
+    if (mShowValue.Call(&result, x)==kVIA_OK)
     {
        return result;
     }
@@ -246,27 +359,12 @@ uint32_t CaplInstanceData::ShowValue(uint32_t x)
 
 uint32_t CaplInstanceData::ShowDates(int16_t x, uint32_t y, int16_t z)
 {
-  // Prepare the parameters for the call stack of CAPL. The stack grows
-  // from top to down, so the first parameter in the parameter list is the last
-  // one in memory. CAPL uses also a 32 bit alignment for the parameters.
-
-#if defined(X64)
-  uint8_t params[24];          // parameters for call stack, 24 Bytes total (8 bytes per parameter, reverse order of parameters)
-  memcpy(params+16, &z, 2);  // third  parameter, offset 16, 2 Bytes
-  memcpy(params+ 8, &y, 4);  // second parameter, offset 8,  4 Bytes
-  memcpy(params+ 0, &x, 2);  // first  parameter, offset 0,  2 Bytes
-#else
-  uint8_t params[12];         // parameters for call stack, 12 Bytes total
-  memcpy(params+0, &z, 2);  // third  parameter, offset 0, 2 Bytes
-  memcpy(params+4, &y, 4);  // second parameter, offset 4, 4 Bytes
-  memcpy(params+8, &x, 2);  // first  parameter, offset 8, 2 Bytes
-#endif
-
   uint32_t result;
 
-  if(mShowDates!=nullptr)
+  if (mShowDates.IsBound())
   {
-    VIAResult rc =  mShowDates->Call(&result, params);
+    TraceScope trace(kTraceCallback, "CALLBACK_ShowDates", nullptr);
+    VIAResult rc = mShowDates.Call(&result, x, y, z);
     if (rc==kVIA_OK)
     {
        return rc;   // call successful
@@ -276,229 +374,812 @@ uint32_t CaplInstanceData::ShowDates(int16_t x, uint32_t y, int16_t z)
   return -1; // call failed
 }
 
-void CaplInstanceData::DllInfo(const char* x)
+void CaplInstanceData::DllInfo(CaplString x)
 {
-  // Prepare the parameters for the call stack of CAPL.
-  // Arrays uses a 8 byte (64 bit DLL: 12 byte) on the stack, 4 Bytes for the number of element,
-  // and 4 bytes (64 bit DLL: 8 byte) for the pointer to the array
-  int32_t sizeX = (int32)strlen(x)+1;
-
-#if defined(X64)
-  uint8_t params[16];              // parameters for call stack, 16 Bytes total (8 bytes per parameter, reverse order of parameters)
-  memcpy(params+8, &sizeX, 4);   // array size    of first parameter, 4 Bytes
-  memcpy(params+0, &x,     8);   // array pointer of first parameter, 8 Bytes
-#else
-  uint8_t params[8];               // parameters for call stack, 8 Bytes total
-  memcpy(params+0, &sizeX, 4);   // array size    of first parameter, 4 Bytes
-  memcpy(params+4, &x,     4);   // array pointer of first parameter, 4 Bytes
-#endif
+  if (mDllInfo.IsBound())
+  {
+    TraceScope trace(kTraceCallback, "CALLBACK_DllInfo", nullptr);
+    mDllInfo.Call(nullptr, x);
+  }
+}
 
-  if(mDllInfo!=nullptr)
+void CaplInstanceData::ArrayValues(uint32_t flags, CaplArray<uint8_t> databytes, uint8_t controlcode)
+{
+  if (mArrayValues.IsBound())
   {
-    uint32_t result; // dummy variable
-    VIAResult rc =  mDllInfo->Call(&result, params);
+    TraceScope trace(kTraceCallback, "CALLBACK_ArrayValues", nullptr);
+    mArrayValues.Call(nullptr, flags, databytes, controlcode);
   }
 }
 
-void CaplInstanceData::ArrayValues(uint32_t flags, uint32_t numberOfDatabytes, uint8_t databytes[], uint8_t controlcode)
+// Runs on the sample thread, the sessions of the block are shared with its CAPL calls.
+int CaplInstanceData::sMeasureSample(void* context, double* value)
 {
-  // Prepare the parameters for the call stack of CAPL. The stack grows
-  // from top to down, so the first parameter in the parameter list is the last
-  // one in memory. CAPL uses also a 32 bit alignment for the parameters.
-  // Arrays uses a 8 byte (64 bit DLL: 12 byte) on the stack, 4 Bytes for the number of element,
-  // and 4 bytes (64 bit DLL: 8 byte) for the pointer to the array
+  CaplInstanceData* inst = static_cast<CaplInstanceData*>(context);
+  char reply[ITECHDC_REPLY_SIZE];
+  return inst->Devices().Exchange(inst->mSampleKind, inst->mSampleCommand.c_str(), reply, value, inst->mSampleDevice);
+}
 
-#if defined(X64)
-  uint8_t params[32];                           // parameters for call stack, 32 Bytes total (8 bytes per parameter, reverse order of parameters)
-  memcpy(params+24, &controlcode,       1);   // third parameter,                  offset 24, 1 Bytes
-  memcpy(params+16, &numberOfDatabytes, 4);   // second parameter (array size),    offset 16, 4 Bytes
-  memcpy(params+ 8, &databytes,         8);   // second parameter (array pointer), offset  8, 8 Bytes
-  memcpy(params+ 0, &flags,             4);   // first  parameter,                 offset  0, 4 Bytes
-#else
-  uint8_t params[16];                           // parameters for call stack, 16 Bytes total
-  memcpy(params+ 0, &controlcode,       1);   // third parameter,                  offset  0, 1 Bytes
-  memcpy(params+ 4, &numberOfDatabytes, 4);   // second parameter (array size),    offset  4, 4 Bytes
-  memcpy(params+ 8, &databytes,         4);   // second parameter (array pointer), offset  8, 4 Bytes
-  memcpy(params+12, &flags,             4);   // first  parameter,                 offset 12, 4 Bytes
-#endif
+// Runs on the monitor thread, one instrument at a time.
+int CaplInstanceData::sMeasureRule(void* context, int device, const char* command, double* value)
+{
+  CaplInstanceData* inst = static_cast<CaplInstanceData*>(context);
+  char reply[ITECHDC_REPLY_SIZE];
+  return inst->Devices().Exchange(inst->mMonitorKind, command, reply, value, device);
+}
 
-  if(mArrayValues!=nullptr)
-  {
-    uint32_t result; // dummy variable
-    VIAResult rc =  mArrayValues ->Call(&result, params);
-  }
+// Runs on the watcher threads, only after a request and where the instrument has to be polled.
+int CaplInstanceData::sQueryStatus(void* context, int device, const char* command, double* value)
+{
+  CaplInstanceData* inst = static_cast<CaplInstanceData*>(context);
+  char reply[ITECHDC_REPLY_SIZE];
+  return inst->Devices().Exchange(inst->mWatchKind, command, reply, value, device);
+}
 
+// Runs on the sequence thread, a step goes to every instrument of the block like dllItechNodeWrite.
+int CaplInstanceData::sSendStep(void* context, const char* command)
+{
+  CaplInstanceData* inst = static_cast<CaplInstanceData*>(context);
+  char reply[ITECHDC_REPLY_SIZE];
+  // The reply of a query step is read, or it would be taken for the answer to the next query
+  return inst->Devices().Exchange(inst->mSequenceKind, command, strchr(command, '?')!=nullptr ? reply : nullptr, nullptr);
 }
 
-CaplInstanceData* GetCaplInstanceData(uint32_t handle)
+// Upload and the slot commands of the list thread, to every instrument of the block.
+int CaplInstanceData::sListExchange(void* context, const char* command, double* value)
+{
+  ListPort* port = static_cast<ListPort*>(context);
+  char reply[ITECHDC_REPLY_SIZE];
+  return port->inst->Devices().Exchange(port->kind, command, value!=nullptr ? reply : nullptr, value);
+}
+
+// The operation status of every instrument of the block, or'ed: a slot runs until it ended on all.
+int CaplInstanceData::sListStatus(void* context, const char* command, double* value)
 {
-  VCaplMap::iterator lSearchResult(gCaplMap.find(handle));
-  if ( gCaplMap.end()==lSearchResult )
+  ListPort* port = static_cast<ListPort*>(context);
+  std::vector<std::string> resources;
+  int status = port->inst->Devices().Resources(port->kind, &resources);
+  if (status<0)
   {
-    return nullptr;
-  } 
-  else 
+    return status;
+  }
+  int32_t bits = 0;
+  for (size_t i = 0; i<resources.size(); i++)
   {
-    return lSearchResult->second;
+    char reply[ITECHDC_REPLY_SIZE];
+    double condition = 0.0;
+    status = port->inst->Devices().Exchange(port->kind, command, reply, &condition, (int)i);
+    if (status<0)
+    {
+      return status;
+    }
+    bits |= (int32_t)condition;
   }
+  *value = bits;
+  return kTransportOk;
 }
 
-// ============================================================================
-// CaplInstanceData
-//
-// Data local for a single CAPL Block.
-//
-// A CAPL-DLL can be used by more than one CAPL-Block, so every piece of
-// information thats like a global variable in CAPL, must now be wrapped into
-// an instance of an object.
-// ============================================================================
-
-void CAPLEXPORT CAPLPASCAL appInit (uint32_t handle)
+bool CaplInstanceData::CreateTimer()
 {
-  CaplInstanceData* instance = GetCaplInstanceData(handle);
-  if ( nullptr==instance )
+  if (mTimer==nullptr)
   {
-    VServiceMap::iterator lSearchService(gServiceMap.find(handle));
-    if ( gServiceMap.end()!=lSearchService )
+    if (gVIAService==nullptr || gVIAService->CreateTimer(&mTimer, nullptr, this, "ItechDelivery")!=kVIA_OK)
     {
-      VIACapl* service = lSearchService->second;
-      try
-      {
-        instance = new CaplInstanceData(service);
-      }
-      catch ( std::bad_alloc& )
-      {
-        return; // proceed without change
-      }
-      instance->GetCallbackFunctions();
-      gCaplMap[handle] = instance;
+      mTimer = nullptr;
     }
   }
+  return mTimer!=nullptr;
 }
 
-void CAPLEXPORT CAPLPASCAL appEnd (uint32_t handle)
+// Ring at the shortest interval of sampling, monitoring, watching and the sequence, not at all if none runs.
+void CaplInstanceData::ArmTimer()
 {
-  CaplInstanceData* inst = GetCaplInstanceData(handle);
-  if (inst==nullptr)
+  VIATime tick = 0;
+  if (mSampleStream.IsRunning())
+  {
+    tick = mSampleTick;
+  }
+  if (mMonitor.IsRunning() && (tick==0 || mMonitorTick<tick))
+  {
+    tick = mMonitorTick;
+  }
+  if ((mSequence.IsRunning() || mSequencePending) && (tick==0 || (VIATime)SEQUENCE_DELIVERY_TICK_NS<tick))
+  {
+    tick = SEQUENCE_DELIVERY_TICK_NS;
+  }
+  if (mWatcher.IsRunning())
+  {
+    tick = SRQ_DELIVERY_TICK_NS; // the shortest there is
+  }
+  if (mTimer==nullptr)
   {
     return;
   }
-  inst->ReleaseCallbackFunctions();
+  if (tick>0)
+  {
+    mTimer->SetTimer(tick);
+  }
+  else
+  {
+    mTimer->CancelTimer();
+  }
+}
 
-  delete inst;
-  inst = nullptr;
-  gCaplMap.erase(handle);
+static VIATime sSimTime()
+{
+  VIATime now = 0;
+  if (gVIAService!=nullptr)
+  {
+    gVIAService->GetCurrentSimTime(&now);
+  }
+  return now;
 }
 
-int32_t CAPLEXPORT CAPLPASCAL appSetValue (uint32_t handle, int32_t x)
+// Returns 0, -1 for invalid arguments or a stream running already, -2 if the CAPL
+// program has no CALLBACK_ItechSamples and -3 if CANoe provides no timer.
+int32_t CaplInstanceData::StartSamples(TransportKind kind, int32_t device, const char* command, int32_t periodUs, int32_t batchSize, int32_t maxLatencyMs)
 {
-  CaplInstanceData* inst = GetCaplInstanceData(handle);
-  if (inst==nullptr)
+  if (device<0 || command==nullptr || periodUs<0 || batchSize<1 || batchSize>SAMPLE_MAX_BATCH || maxLatencyMs<=0
+      || mSampleStream.IsRunning())
   {
     return -1;
   }
+  if (!mSamples.IsBound())
+  {
+    return -2;
+  }
+  if (!CreateTimer())
+  {
+    return -3;
+  }
 
-  return inst->ShowValue(x);
+  mSampleKind = kind;
+  mSampleDevice = device;
+  mSampleCommand = command;
+  mSampleBatch.assign(batchSize, 0.0);
+  uint64_t maxLatency = (uint64_t)maxLatencyMs*1000000;
+  if (mSampleStream.Start(sMeasureSample, this, (uint64_t)periodUs*1000, (uint32_t)batchSize, maxLatency)!=0)
+  {
+    return -1;
+  }
+  // Ringing at a quarter of the latency, a batch waits at most 1.25 times max latency.
+  mSampleTick = maxLatency/4>0 ? maxLatency/4 : 1;
+  ArmTimer();
+  return 0;
 }
 
-int32_t CAPLEXPORT CAPLPASCAL appReadData (uint32_t handle, int32_t a)
+// Stop measuring; deliver: hand the samples still queued to CAPL. Returns the
+// number of samples lost because CAPL did not keep up.
+int32_t CaplInstanceData::StopSamples(bool deliver)
 {
-  CaplInstanceData* inst = GetCaplInstanceData(handle);
-  if (inst==nullptr)
+  mSampleStream.Stop();
+  ArmTimer();
+  if (deliver && !mSampleBatch.empty())
   {
-    return -1;
+    DeliverSamples(sSimTime(), true);
   }
+  uint64_t dropped = mSampleStream.Dropped();
+  return dropped>INT32_MAX ? INT32_MAX : (int32_t)dropped;
+}
 
-  int16_t  x = (a>=0) ? +1 : -1;
-  uint32_t y = abs(a);
-  int16_t  z = (int16)(a & 0x0f000000) >> 24;
-
-  inst->DllVersion("Version 1.1");
+// Returns 0, -1 if monitoring already, -2 if the CAPL program has no
+// CALLBACK_ItechRule and -3 if CANoe provides no timer.
+int32_t CaplInstanceData::StartMonitor(TransportKind kind, int32_t periodUs)
+{
+  if (periodUs<0 || mMonitor.IsRunning())
+  {
+    return -1;
+  }
+  if (!mRuleEvent.IsBound())
+  {
+    return -2;
+  }
+  if (!CreateTimer())
+  {
+    return -3;
+  }
+  mMonitorKind = kind;
+  if (mMonitor.Start(sMeasureRule, this, (uint64_t)periodUs*1000)!=0)
+  {
+    return -1;
+  }
+  // An event waits at most one period, but the timer rings at most every millisecond.
+  mMonitorTick = (uint64_t)periodUs*1000>1000000 ? (uint64_t)periodUs*1000 : 1000000;
+  ArmTimer();
+  return 0;
+}
 
-  inst->DllInfo("DLL: processing");
+// Stop monitoring; deliver: hand the events still queued to CAPL. Returns the
+// number of events lost because CAPL did not keep up.
+int32_t CaplInstanceData::StopMonitor(bool deliver)
+{
+  mMonitor.Stop();
+  ArmTimer();
+  if (deliver)
+  {
+    DeliverEvents(sSimTime());
+  }
+  uint64_t dropped = mMonitor.Dropped();
+  return dropped>INT32_MAX ? INT32_MAX : (int32_t)dropped;
+}
 
-  uint8_t databytes[8] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+// Returns 0, -1 for invalid arguments or if watching already, -2 if the CAPL program
+// has no CALLBACK_ItechSrq, -3 if CANoe provides no timer and -4 if there is no
+// instrument or its masks cannot be set.
+int32_t CaplInstanceData::StartRequests(TransportKind kind, int32_t serviceEnable, int32_t eventEnable, int32_t questionableEnable, int32_t pollUs)
+{
+  if (serviceEnable<0 || serviceEnable>255 || eventEnable<0 || eventEnable>255
+      || questionableEnable<0 || questionableEnable>65535 || pollUs<=0 || mWatcher.IsRunning())
+  {
+    return -1;
+  }
+  if (!mRequest.IsBound())
+  {
+    return -2;
+  }
+  if (!CreateTimer())
+  {
+    return -3;
+  }
 
-  inst->ArrayValues( 0xaabbccdd, sizeof(databytes), databytes, 0x01);
+  std::vector<std::string> resources;
+  if (mDevices.Resources(kind, &resources)<0 || resources.empty())
+  {
+    return -4;
+  }
+  // Start from clear registers, an event left from before would hold the summary up
+  char command[96];
+  snprintf(command, sizeof(command), "*CLS;*ESE %d;STAT:QUES:ENAB %d;*SRE %d", eventEnable, questionableEnable, serviceEnable);
+  for (size_t i = 0; i<resources.size(); i++)
+  {
+    if (mDevices.Exchange(kind, command, nullptr, nullptr, (int)i)<0)
+    {
+      return -4;
+    }
+  }
 
-  return inst->ShowDates( x, y, z);
+  mWatchKind = kind;
+  if (mWatcher.Start(kind, resources, (uint8_t)serviceEnable, sQueryStatus, this, (uint64_t)pollUs*1000)!=0)
+  {
+    return -1;
+  }
+  ArmTimer();
+  return 0;
 }
 
-
-// ============================================================================
-// VIARegisterCDLL
-// ============================================================================
-
-VIACLIENT(void) VIARegisterCDLL (VIACapl* service)
+// Stop watching and disable the requests; deliver: hand the requests still queued
+// to CAPL. Returns the number of requests lost because CAPL did not keep up.
+int32_t CaplInstanceData::StopRequests(bool deliver)
 {
-  uint32_t  handle;
-  VIAResult result;
-
-  if (service==nullptr)
+  bool watching = mWatcher.IsRunning();
+  mWatcher.Stop();
+  ArmTimer();
+  if (watching)
   {
-    return;
+    mDevices.Exchange(mWatchKind, "*SRE 0", nullptr, nullptr);
+  }
+  if (deliver)
+  {
+    DeliverRequests(sSimTime());
   }
+  uint64_t dropped = mWatcher.Dropped();
+  return dropped>INT32_MAX ? INT32_MAX : (int32_t)dropped;
+}
 
-  result = service->GetCaplHandle(&handle);
-  if(result!=kVIA_OK)
+// Returns 0, -1 if there are no steps or the sequence runs already and -3 if a
+// callback is bound but CANoe provides no timer. The callbacks are optional,
+// dllItechSeqResult reads the results as well.
+int32_t CaplInstanceData::StartSequence(TransportKind kind)
+{
+  if (mSequence.IsRunning())
   {
-    return;
+    return -1;
+  }
+  bool callbacks = mSequenceStep.IsBound() || mSequenceDone.IsBound();
+  if (callbacks && !CreateTimer())
+  {
+    return -3;
+  }
+  if (mSequencePending)
+  {
+    DeliverSteps(sSimTime()); // the run before ended, but the timer did not ring since
   }
 
-  // appInit (internal) resp. "DllInit" (CAPL code) has to follow
-  gServiceMap[handle] = service;
+  mSequenceKind = kind;
+  if (mSequence.Start(sSendStep, this)!=0)
+  {
+    return -1;
+  }
+  mStepsDelivered = 0;
+  mSequencePending = callbacks;
+  ArmTimer();
+  return 0;
 }
 
-void ClearAll()
+// Abort the sequence before its next step; deliver: hand the results still queued
+// and the end to CAPL. Returns the number of steps not run.
+int32_t CaplInstanceData::AbortSequence(bool deliver)
 {
-  // destroy objects created by this DLL
-  // may result from forgotten DllEnd calls
-  VCaplMap::iterator lIter=gCaplMap.begin();
-  const int32_t cNumberOfEntries = (int32_t)gCaplMap.size();
-  int32_t i = 0;
-  while ( lIter!=gCaplMap.end() && i<cNumberOfEntries )
+  int32_t notRun = mSequence.Abort();
+  if (deliver && mSequencePending)
   {
-    appEnd( (*lIter).first );
-    lIter = gCaplMap.begin(); // first element should have vanished
-    i++; // assure that no more erase trials take place than the original size of the map
+    DeliverSteps(sSimTime());
   }
+  ArmTimer();
+  return notRun;
+}
 
-  // just for clarity (would be done automatically)
-  gCaplMap.clear();
-  gServiceMap.clear();
+// values holds (voltage, current, width s) per step, count is their number (3 per step).
+// Returns the number of LIST slots, -1 for an invalid profile or if a profile runs, or
+// the status of the upload.
+int32_t CaplInstanceData::LoadList(TransportKind kind, const double* values, int32_t count)
+{
+  if (values==nullptr || count<3 || count%3!=0)
+  {
+    return -1;
+  }
+  ListPort* port = kind==kTransportSerial ? &mListSerial : &mListUsb;
+  return mList.Load(values, (uint32_t)(count/3), sListExchange, port);
 }
 
-void CAPLEXPORT CAPLPASCAL voidFct( void )
+// Returns 0, or -1 if no profile is loaded or it runs already.
+int32_t CaplInstanceData::RunList()
 {
-   // do something
-   data = 55;
+  return mList.Start(sListStatus);
 }
 
-uint32_t CAPLEXPORT CAPLPASCAL appLongFuncName( void )
+// Set up the acquisition of every supply of the block: points points intervalUs apart, started
+// by dllItechDlogStart (source 0) or armed by it for dllItechDlogTrigger or *TRG (source 1).
+// Asks for binary blocks, if a supply does not report "FORM REAL,32" back all of them send
+// ASCII. Returns 1 for binary, 0 for ASCII, -1 for invalid arguments or the
+// status of the exchange that failed.
+int32_t CaplInstanceData::ConfigureDatalog(TransportKind kind, int32_t intervalUs, int32_t points, int32_t source)
 {
-  return 1;
+  std::string commands;
+  if (intervalUs<=0 || points<=0 || DatalogCommands(intervalUs*1e-6, (uint32_t)points, source, &commands)<0)
+  {
+    return -1;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mDatalogMutex);
+    mDatalogConfigured = false;
+  }
+  int status = mDevices.Exchange(kind, commands.c_str(), nullptr, nullptr);
+  if (status<0)
+  {
+    return status;
+  }
+  status = mDevices.Exchange(kind, "FORM REAL,32", nullptr, nullptr);
+  std::vector<std::string> resources;
+  if (status>=0)
+  {
+    status = mDevices.Resources(kind, &resources);
+  }
+  if (status<0)
+  {
+    return status;
+  }
+
+  // A supply that does not know the format keeps ASCII or does not answer at all
+  DatalogFormat format = kDatalogReal32;
+  for (size_t i = 0; i<resources.size(); i++)
+  {
+    char reply[ITECHDC_REPLY_SIZE];
+    if (mDevices.Exchange(kind, "FORM?", reply, nullptr, (int)i)<0 || strncmp(reply, "REAL", 4)!=0)
+    {
+      format = kDatalogAscii;
+    }
+  }
+  if (format==kDatalogAscii)
+  {
+    status = mDevices.Exchange(kind, "FORM ASC", nullptr, nullptr);
+    if (status<0)
+    {
+      return status;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mDatalogMutex);
+  mDatalogKind = kind;
+  mDatalogFormat = format;
+  mDatalogConfigured = true;
+  return format==kDatalogReal32 ? 1 : 0;
 }
 
-void CAPLEXPORT CAPLPASCAL appPut(uint32_t x)
+// The port and format of the last dllItechDlogConfig, false if there was none or it failed.
+bool CaplInstanceData::DatalogSettings(TransportKind* kind, DatalogFormat* format) const
 {
-  data = x;
+  std::lock_guard<std::mutex> lock(mDatalogMutex);
+  *kind = mDatalogKind;
+  *format = mDatalogFormat;
+  return mDatalogConfigured;
 }
 
-uint32_t CAPLEXPORT CAPLPASCAL appGet(void)
+// "INIT:ACQ" or "TRIG:ACQ" to the supplies of the acquisition. Returns 0, -1 if it was not
+// configured, or the VISA status of the write.
+int32_t CaplInstanceData::SendDatalog(const char* command)
 {
-  return data;
+  TransportKind kind;
+  DatalogFormat format;
+  if (!DatalogSettings(&kind, &format))
+  {
+    return -1;
+  }
+  return mDevices.Exchange(kind, command, nullptr, nullptr);
 }
 
-int32_t CAPLEXPORT CAPLPASCAL appAdd(int32_t x, int32_t y)
+// The supply dllItechDlogRead waits for.
+struct DatalogDevice
 {
-  int32_t z = x + y;
+  ItechDcContext* devices;
+  TransportKind   kind;
+  int32_t         device;
+};
 
-  return z;
+static int sDatalogStatus(void* context, const char* command, double* value)
+{
+  DatalogDevice* source = static_cast<DatalogDevice*>(context);
+  char reply[ITECHDC_REPLY_SIZE];
+  return source->devices->Exchange(source->kind, command, reply, value, source->device);
 }
 
-int32_t CAPLEXPORT CAPLPASCAL appSubtract(int32_t x, int32_t y)
+// Wait until the acquisition of the device-th supply is done, then fetch command (e.g.
+// "FETC:ARR:VOLT?") in one reply, all within timeoutMs. Returns the number of values stored,
+// -1 for invalid arguments or before dllItechDlogConfig, or a VISA status.
+int32_t CaplInstanceData::ReadDatalog(int32_t device, const char* command, double* values, int32_t count, int32_t timeoutMs)
 {
-  int32_t z = x - y;
+  TransportKind kind;
+  DatalogFormat format;
+  if (!DatalogSettings(&kind, &format) || device<0 || command==nullptr || values==nullptr || count<=0
+      || timeoutMs<=0)
+  {
+    return -1;
+  }
+  uint64_t deadline = ItechNowNs()+(uint64_t)timeoutMs*1000000;
+  DatalogDevice source = { &mDevices, kind, device };
+  int status = WaitDatalog(sDatalogStatus, &source, (uint64_t)timeoutMs*1000000);
+  if (status<0)
+  {
+    return status;
+  }
+  uint64_t now = ItechNowNs();
+  uint32_t remainingMs = now<deadline ? (uint32_t)((deadline-now+999999)/1000000) : 1;
+  std::string data;
+  status = mDevices.QueryBlock(kind, command, &data, device, remainingMs);
+  if (status<0)
+  {
+    return status;
+  }
+  int points = DecodeDatalog(data, format, values, (uint32_t)count);
+  return points<0 ? kTransportErrorIo : points;
+}
+
+void CaplInstanceData::StopMeasuring()
+{
+  mSampleStream.Stop();
+  mMonitor.Stop();
+  mWatcher.Stop();
+  mSequence.Abort();
+  mSequencePending = false;
+  mList.Abort();
+  if (mTimer!=nullptr)
+  {
+    mTimer->CancelTimer();
+    gVIAService->ReleaseTimer(mTimer);
+    mTimer = nullptr;
+  }
+}
+
+// The first timestamp is the measurement time in seconds: the sample thread keeps
+// steady clock times, moved back from now by their age.
+void CaplInstanceData::DeliverSamples(VIATime now, bool all)
+{
+  uint64_t first;
+  uint32_t count;
+  while ((count = mSampleStream.TakeBatch(ItechNowNs(), all, mSampleBatch.data(), &first))>0)
+  {
+    uint64_t age = ItechNowNs()-first;
+    double firstTime = ((double)now-(double)age)/1e9;
+    TraceScope trace(kTraceCallback, "CALLBACK_ItechSamples", nullptr);
+    mSamples.Call(nullptr, CaplArray<double>(mSampleBatch.data(), count), count, firstTime);
+  }
+}
+
+// One call of CALLBACK_ItechRule per event, with the measurement time like the samples.
+void CaplInstanceData::DeliverEvents(VIATime now)
+{
+  mEvents.clear();
+  if (mMonitor.TakeEvents(&mEvents)==0)
+  {
+    return;
+  }
+  uint64_t steadyNow = ItechNowNs();
+  for (size_t i = 0; i<mEvents.size(); i++)
+  {
+    const RuleEvent& event = mEvents[i];
+    double time = ((double)now-(double)(steadyNow-event.time))/1e9;
+    TraceScope trace(kTraceCallback, "CALLBACK_ItechRule", nullptr);
+    mRuleEvent.Call(nullptr, event.rule, event.device, event.value, event.previous, time);
+  }
+}
+
+// One call of CALLBACK_ItechSrq per request, with the time the request arrived.
+void CaplInstanceData::DeliverRequests(VIATime now)
+{
+  mRequests.clear();
+  if (mWatcher.TakeEvents(&mRequests)==0)
+  {
+    return;
+  }
+  uint64_t steadyNow = ItechNowNs();
+  for (size_t i = 0; i<mRequests.size(); i++)
+  {
+    const ServiceRequestEvent& request = mRequests[i];
+    double time = ((double)now-(double)(steadyNow-request.time))/1e9;
+    TraceScope trace(kTraceCallback, "CALLBACK_ItechSrq", nullptr);
+    mRequest.Call(nullptr, request.device, request.statusByte, request.eventStatus, request.questionable, time);
+  }
+}
+
+// One call of CALLBACK_ItechSeqStep per step run, with the time it started, and
+// CALLBACK_ItechSeqDone once the sequence ended.
+void CaplInstanceData::DeliverSteps(VIATime now)
+{
+  if (!mSequencePending)
+  {
+    return;
+  }
+  // Asked before taking the results: once ended, every result is there
+  bool ended = !mSequence.IsRunning();
+  mSteps.clear();
+  mStepsDelivered += mSequence.Results(mStepsDelivered, &mSteps);
+  uint64_t steadyNow = ItechNowNs();
+  for (size_t i = 0; i<mSteps.size() && mSequenceStep.IsBound(); i++)
+  {
+    const SequenceStepResult& step = mSteps[i];
+    double time = ((double)now-(double)(steadyNow-step.time))/1e9;
+    TraceScope trace(kTraceCallback, "CALLBACK_ItechSeqStep", nullptr);
+    mSequenceStep.Call(nullptr, step.step, step.status, (double)step.errorNs/1e3, time);
+  }
+  if (ended)
+  {
+    mSequencePending = false;
+    if (mSequenceDone.IsBound())
+    {
+      TraceScope trace(kTraceCallback, "CALLBACK_ItechSeqDone", nullptr);
+      mSequenceDone.Call(nullptr, (int32_t)mSequence.Executed(), mSequence.Aborted() ? 1 : 0,
+                         (double)mSequence.MaxErrorNs()/1e3);
+    }
+  }
+}
+
+VIASTDDEF CaplInstanceData::OnTimer(VIATime nanoseconds)
+{
+  DeliverSamples(nanoseconds, false);
+  DeliverEvents(nanoseconds);
+  DeliverRequests(nanoseconds);
+  DeliverSteps(nanoseconds);
+  ArmTimer();
+  return kVIA_OK;
+}
+
+// Wait-free, call it inside an EpochGuard and use the result only there.
+CaplInstanceData* GetCaplInstanceData(uint32_t handle)
+{
+  return gCaplTable.Find(handle);
+}
+
+static void sDeleteInstance(void* instance)
+{
+  delete static_cast<CaplInstanceData*>(instance);
+}
+
+// ============================================================================
+// CaplInstanceData
+//
+// Data local for a single CAPL Block.
+//
+// A CAPL-DLL can be used by more than one CAPL-Block, so every piece of
+// information thats like a global variable in CAPL, must now be wrapped into
+// an instance of an object.
+// ============================================================================
+
+void CAPLEXPORT CAPLPASCAL appInit (uint32_t handle)
+{
+  EpochGuard guard;
+  CaplInstanceData* instance = GetCaplInstanceData(handle);
+  if ( nullptr==instance )
+  {
+    VIACapl* service = gServiceTable.Find(handle);
+    if ( nullptr!=service )
+    {
+      try
+      {
+        instance = new CaplInstanceData(service);
+      }
+      catch ( std::bad_alloc& )
+      {
+        return; // proceed without change
+      }
+      instance->GetCallbackFunctions();
+      if (!gCaplTable.Insert(handle, instance))
+      {
+        // more blocks than HANDLE_TABLE_CAPACITY
+        instance->ReleaseCallbackFunctions();
+        delete instance;
+      }
+    }
+  }
+}
+
+void CAPLEXPORT CAPLPASCAL appEnd (uint32_t handle)
+{
+  // Write the trace of the measurement so far, if tracing
+  if (TraceIsEnabled())
+  {
+    TraceDump(nullptr);
+  }
+  // Lines still queued by the logger go to the file now, merged repeats to the Write window
+  FileLoggerFlush();
+  gWriteWindowLimiter.Flush(LogClockNs());
+
+  CaplInstanceData* inst = gCaplTable.Remove(handle);
+  if (inst==nullptr)
+  {
+    return;
+  }
+  inst->StopMeasuring();
+  inst->ReleaseCallbackFunctions();
+  inst->Devices().Release();
+
+  // Another thread may have found the instance just before, it is deleted once that lookup is over
+  EpochRetire(inst, sDeleteInstance);
+  inst = nullptr;
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appSetValue (uint32_t handle, int32_t x)
+{
+  TraceScope trace(kTraceCapl, "dllSetValue", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+
+  return inst->ShowValue(x);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appReadData (uint32_t handle, int32_t a)
+{
+  TraceScope trace(kTraceCapl, "dllReadData", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+
+  int16_t  x = (a>=0) ? +1 : -1;
+  uint32_t y = abs(a);
+  int16_t  z = (int16)(a & 0x0f000000) >> 24;
+
+  inst->DllVersion("Version 1.1");
+
+  inst->DllInfo("DLL: processing");
+
+  uint8_t databytes[8] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+
+  inst->ArrayValues( 0xaabbccdd, databytes, 0x01);
+
+  return inst->ShowDates( x, y, z);
+}
+
+
+// ============================================================================
+// VIARegisterCDLL
+// ============================================================================
+
+VIACLIENT(void) VIARegisterCDLL (VIACapl* service)
+{
+  uint32_t  handle;
+  VIAResult result;
+
+  if (service==nullptr)
+  {
+    return;
+  }
+
+  result = service->GetCaplHandle(&handle);
+  if(result!=kVIA_OK)
+  {
+    return;
+  }
+
+  // appInit (internal) resp. "DllInit" (CAPL code) has to follow
+  gServiceTable.Insert(handle, service);
+}
+
+// ============================================================================
+// VIARequiredVersion, VIASetService
+//
+// CANoe asks for the VIA version the dll was built with and then hands over
+// its service, which provides the measurement time.
+// ============================================================================
+
+VIACLIENT(void) VIARequiredVersion (int32* majorversion, int32* minorversion)
+{
+  *majorversion = VIAMajorVersion;
+  *minorversion = VIAMinorVersion;
+}
+
+VIACLIENT(void) VIASetService (VIAService* service)
+{
+  gVIAService = service;
+}
+
+// Measurement time for the log lines, -1 outside a measurement or without CANoe.
+static int64_t sMeasurementTime()
+{
+  VIATime now;
+  if (gVIAService==nullptr || gVIAService->GetCurrentSimTime(&now)!=kVIA_OK)
+  {
+    return -1;
+  }
+  return (int64_t)now;
+}
+
+void ClearAll()
+{
+  // destroy objects created by this DLL
+  // may result from forgotten DllEnd calls
+  std::vector<uint32_t> handles = gCaplTable.Handles();
+  for (size_t i = 0; i<handles.size(); i++)
+  {
+    appEnd(handles[i]);
+  }
+
+  gCaplTable.Clear();
+  gServiceTable.Clear();
+  // no CAPL calls are running any more, the retired instances can go
+  EpochReclaim();
+
+  sCloseWriteWindow();
+
+  // write all queued log lines and stop the writer thread
+  FileLoggerShutdown();
+}
+
+void CAPLEXPORT CAPLPASCAL voidFct( void )
+{
+   // do something
+   data = 55;
+}
+
+uint32_t CAPLEXPORT CAPLPASCAL appLongFuncName( void )
+{
+  return 1;
+}
+
+void CAPLEXPORT CAPLPASCAL appPut(uint32_t x)
+{
+  data = x;
+}
+
+uint32_t CAPLEXPORT CAPLPASCAL appGet(void)
+{
+  return data;
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appAdd(int32_t x, int32_t y)
+{
+  int32_t z = x + y;
+
+  return z;
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appSubtract(int32_t x, int32_t y)
+{
+  int32_t z = x - y;
 
   return z;
 }
@@ -583,62 +1264,724 @@ void CAPLEXPORT CAPLPASCAL appPutDataOnePar(const uint8_t dataBlock[] )
 
 void CAPLEXPORT CAPLPASCAL appItechDcPowerOutput(uint32_t state )
 {
+  TraceScope trace(kTraceCapl, "dllItechDcPowerOutput", nullptr);
   ItechDcPowerOutput(state);
 }
 
 void CAPLEXPORT CAPLPASCAL appItechDcPowerWrite(char* command )
 {
+  TraceScope trace(kTraceCapl, "dllItechDcPowerWrite", command);
   ItechDcPowerWrite(command);
 }
 
 void CAPLEXPORT CAPLPASCAL appItechDcPowerQuery(char* command , char *resultString, double *result)
 {
+  TraceScope trace(kTraceCapl, "dllItechDcPowerQuery", command);
   ItechDcPowerQuery(command,resultString,result);
 }
 
 void CAPLEXPORT CAPLPASCAL appItechDcPowerWriteSerial(char* command )
 {
+  TraceScope trace(kTraceCapl, "dllItechDcPowerWriteSerial", command);
   ItechDcPowerWriteSerial(command);
 }
 
 void CAPLEXPORT CAPLPASCAL appItechDcPowerQuerySerial(char* command , char *resultString, double *result)
 {
+  TraceScope trace(kTraceCapl, "dllItechDcPowerQuerySerial", command);
   ItechDcPowerQuerySerial(command,resultString,result);
 }
+
+// The same on the instruments of one CAPL block: found and opened at the first call,
+// kept open until dllEnd. Returns the status of the last failed step, 0 otherwise
+// and -1 for an unknown handle.
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeWrite(uint32_t handle, char* command)
+{
+  TraceScope trace(kTraceCapl, "dllItechNodeWrite", command);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->Devices().Exchange(kTransportUsb, command, nullptr, nullptr);
+}
+
+// The reply is cut to size bytes with the terminator, e.g. elcount(resultString).
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeQuery(uint32_t handle, char* command, char* resultString, int32_t size, double* result)
+{
+  TraceScope trace(kTraceCapl, "dllItechNodeQuery", command);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr || size<=0)
+  {
+    return -1;
+  }
+  return inst->Devices().Exchange(kTransportUsb, command, resultString, result, -1, 0, (size_t)size);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeWriteSerial(uint32_t handle, char* command)
+{
+  TraceScope trace(kTraceCapl, "dllItechNodeWriteSerial", command);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->Devices().Exchange(kTransportSerial, command, nullptr, nullptr);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeQuerySerial(uint32_t handle, char* command, char* resultString, int32_t size, double* result)
+{
+  TraceScope trace(kTraceCapl, "dllItechNodeQuerySerial", command);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr || size<=0)
+  {
+    return -1;
+  }
+  return inst->Devices().Exchange(kTransportSerial, command, resultString, result, -1, 0, (size_t)size);
+}
+
+// Wait until the supplies of the node finished every command sent before, instead of a fixed
+// testWaitForTimeout: "*OPC?" is answered once the operations before it are complete. Returns 0,
+// the status of the supply that failed (0xBFFF0015 on timeout) or -1 for invalid arguments.
+int32_t CAPLEXPORT CAPLPASCAL appItechWaitComplete(uint32_t handle, int32_t timeoutMs)
+{
+  TraceScope trace(kTraceCapl, "dllItechWaitComplete", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr || timeoutMs<=0)
+  {
+    return -1;
+  }
+  return inst->Devices().WaitComplete(kTransportUsb, (uint32_t)timeoutMs);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechWaitCompleteSerial(uint32_t handle, int32_t timeoutMs)
+{
+  TraceScope trace(kTraceCapl, "dllItechWaitCompleteSerial", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr || timeoutMs<=0)
+  {
+    return -1;
+  }
+  return inst->Devices().WaitComplete(kTransportSerial, (uint32_t)timeoutMs);
+}
+
+// The quantity of one supply dllItechWaitSettled waits for.
+struct SettleQuantity
+{
+  ItechDcContext* devices;
+  TransportKind   kind;
+  int32_t         device;
+  const char*     command;
+};
+
+static int sMeasureSettle(void* context, double* value)
+{
+  SettleQuantity* quantity = static_cast<SettleQuantity*>(context);
+  char reply[ITECHDC_REPLY_SIZE];
+  return quantity->devices->Exchange(quantity->kind, quantity->command, reply, value, quantity->device);
+}
+
+static int32_t sWaitSettled(uint32_t handle, TransportKind kind, int32_t device, const char* quantity, double target,
+                            double tolerance, int32_t stableMs, int32_t timeoutMs)
+{
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr || device<0 || quantity==nullptr || tolerance<0.0 || stableMs<0 || timeoutMs<=0)
+  {
+    return -1;
+  }
+  SettleQuantity source = { &inst->Devices(), kind, device, quantity };
+  SettleResult result;
+  int status = WaitSettled(sMeasureSettle, &source, target, tolerance, (uint64_t)stableMs*1000000,
+                           (uint64_t)timeoutMs*1000000, &result);
+  if (status<0)
+  {
+    return status;
+  }
+  uint64_t settleMs = (result.settleNs+500000)/1000000;
+  return settleMs>INT32_MAX ? INT32_MAX : (int32_t)settleMs;
+}
+
+// Wait until quantity (e.g. "MEAS:VOLT?") of the device-th supply of the node stayed within
+// target +- tolerance for stableMs, at most timeoutMs. Measures every millisecond while the value
+// is off or moving and less often once it rests inside. Returns the settle time in ms, from the
+// call to the first value of the stable stretch, the status of a failed measurement, 0xBFFF0015
+// on timeout or -1 for invalid arguments.
+int32_t CAPLEXPORT CAPLPASCAL appItechWaitSettled(uint32_t handle, int32_t device, char* quantity, double target, double tolerance, int32_t stableMs, int32_t timeoutMs)
+{
+  TraceScope trace(kTraceCapl, "dllItechWaitSettled", quantity);
+  return sWaitSettled(handle, kTransportUsb, device, quantity, target, tolerance, stableMs, timeoutMs);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechWaitSettledSerial(uint32_t handle, int32_t device, char* quantity, double target, double tolerance, int32_t stableMs, int32_t timeoutMs)
+{
+  TraceScope trace(kTraceCapl, "dllItechWaitSettledSerial", quantity);
+  return sWaitSettled(handle, kTransportSerial, device, quantity, target, tolerance, stableMs, timeoutMs);
+}
+
+// Measure command (e.g. "MEAS:VOLT?") every periodUs (0: back to back) on the device-th instrument of the block and
+// call CALLBACK_ItechSamples(double samples[], dword count, double firstTime) once per
+// batch: when batchSize samples are there or the first one is maxLatencyMs old.
+// Not flagged thread safe, the VIA timer belongs to the measurement thread.
+int32_t CAPLEXPORT CAPLPASCAL appItechSampleStart(uint32_t handle, int32_t device, char* command, int32_t periodUs, int32_t batchSize, int32_t maxLatencyMs)
+{
+  TraceScope trace(kTraceCapl, "dllItechSampleStart", command);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StartSamples(kTransportUsb, device, command, periodUs, batchSize, maxLatencyMs);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechSampleStartSerial(uint32_t handle, int32_t device, char* command, int32_t periodUs, int32_t batchSize, int32_t maxLatencyMs)
+{
+  TraceScope trace(kTraceCapl, "dllItechSampleStartSerial", command);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StartSamples(kTransportSerial, device, command, periodUs, batchSize, maxLatencyMs);
+}
+
+// Stop sampling and deliver the samples still queued. Returns the number of samples dropped.
+int32_t CAPLEXPORT CAPLPASCAL appItechSampleStop(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechSampleStop", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StopSamples(true);
+}
+
+// Add a rule on the value of command (e.g. "MEAS:CURR?") of the device-th supply of the node.
+// kind 0: rises above limits[0], 1: falls below limits[0], 2: changes by limits[0] per second
+// or more, 3: the bits limits[0] (0: all) of the value change, e.g. CV/CC from a status
+// register. limits[1], if count is 2, is the hysteresis. Returns the rule id (> 0) or -1.
+int32_t CAPLEXPORT CAPLPASCAL appItechRuleAdd(uint32_t handle, int32_t device, char* command, int32_t kind, double limits[], int32_t count)
+{
+  TraceScope trace(kTraceCapl, "dllItechRuleAdd", command);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr || limits==nullptr || count<1)
+  {
+    return -1;
+  }
+  return inst->Rules().Add(device, command, (RuleKind)kind, limits[0], count>=2 ? limits[1] : 0.0);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechRuleRemove(uint32_t handle, int32_t rule)
+{
+  TraceScope trace(kTraceCapl, "dllItechRuleRemove", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->Rules().Remove(rule);
+}
+
+// Evaluate the rules of the node every periodUs and call
+// CALLBACK_ItechRule(long rule, long device, double value, double previous, double time)
+// for every rule that triggers. Not flagged thread safe, see dllItechSampleStart.
+int32_t CAPLEXPORT CAPLPASCAL appItechMonitorStart(uint32_t handle, int32_t periodUs)
+{
+  TraceScope trace(kTraceCapl, "dllItechMonitorStart", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StartMonitor(kTransportUsb, periodUs);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechMonitorStartSerial(uint32_t handle, int32_t periodUs)
+{
+  TraceScope trace(kTraceCapl, "dllItechMonitorStartSerial", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StartMonitor(kTransportSerial, periodUs);
+}
+
+// Stop evaluating and deliver the events still queued. Returns the number of events dropped.
+int32_t CAPLEXPORT CAPLPASCAL appItechMonitorStop(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechMonitorStop", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StopMonitor(true);
+}
+
+// Set *SRE, *ESE and STAT:QUES:ENAB on the supplies of the node and call
+// CALLBACK_ItechSrq(long device, long statusByte, long eventStatus, long questionable, double time)
+// for every service request, eventStatus and questionable read only if their summary bit
+// is set. A supply without SRQ is polled with "*STB?" every pollUs. Not flagged thread
+// safe, see dllItechSampleStart.
+int32_t CAPLEXPORT CAPLPASCAL appItechSrqStart(uint32_t handle, int32_t serviceEnable, int32_t eventEnable, int32_t questionableEnable, int32_t pollUs)
+{
+  TraceScope trace(kTraceCapl, "dllItechSrqStart", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StartRequests(kTransportUsb, serviceEnable, eventEnable, questionableEnable, pollUs);
+}
+
+// RS232 has no SRQ, the supply is always polled.
+int32_t CAPLEXPORT CAPLPASCAL appItechSrqStartSerial(uint32_t handle, int32_t serviceEnable, int32_t eventEnable, int32_t questionableEnable, int32_t pollUs)
+{
+  TraceScope trace(kTraceCapl, "dllItechSrqStartSerial", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StartRequests(kTransportSerial, serviceEnable, eventEnable, questionableEnable, pollUs);
+}
+
+// Stop watching, write "*SRE 0" and deliver the requests still queued. Returns the number dropped.
+int32_t CAPLEXPORT CAPLPASCAL appItechSrqStop(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechSrqStop", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StopRequests(true);
+}
+
+// Add a step: command is written offsetUs after dllItechSeqStart to the instruments of the node.
+// Returns the index of the step, or -1 for invalid arguments, more than 4096 steps or if the
+// sequence runs.
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqAdd(uint32_t handle, int32_t offsetUs, char* command)
+{
+  TraceScope trace(kTraceCapl, "dllItechSeqAdd", command);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr || offsetUs<0)
+  {
+    return -1;
+  }
+  return inst->Sequence().Add((uint64_t)offsetUs*1000, command);
+}
+
+// Remove the steps and their results. Returns 0, or -1 if the sequence runs.
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqClear(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechSeqClear", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->Sequence().Clear();
+}
+
+// Run the steps on a thread of raised priority, each at its offset from now. Calls
+// CALLBACK_ItechSeqStep(long step, long status, double errorUs, double time) per step
+// and CALLBACK_ItechSeqDone(long executed, long aborted, double maxErrorUs) at the end,
+// if the CAPL program has them. Not flagged thread safe, the VIA timer belongs to the
+// measurement thread.
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqStart(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechSeqStart", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StartSequence(kTransportUsb);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqStartSerial(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechSeqStartSerial", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->StartSequence(kTransportSerial);
+}
+
+// Abort before the next step and deliver the results still queued. Returns the number of
+// steps not run, 0 if the sequence ended already.
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqAbort(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechSeqAbort", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->AbortSequence(true);
+}
+
+// values receives the status, the timing error (start - offset) and the duration in
+// microseconds of one step. Returns the number of values, or -1 if the step did not run.
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqResult(uint32_t handle, int32_t step, double values[], int32_t count)
+{
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  SequenceStepResult result;
+  if (inst==nullptr || values==nullptr || count<0 || inst->Sequence().Result(step, &result)<0)
+  {
+    return -1;
+  }
+  double all[3] = { (double)result.status, (double)result.errorNs/1e3, (double)result.durationNs/1e3 };
+  int32_t filled = count<3 ? count : 3;
+  for (int32_t i = 0; i<filled; i++)
+  {
+    values[i] = all[i];
+  }
+  return filled;
+}
+
+// Compile the profile, (voltage, current, width in s) per step in values, count values in all,
+// to the LIST commands of the supplies of the node and upload it in one write. Profiles of
+// more than 100 steps take several LIST slots, at most 10. Returns the number of slots, -1 for
+// an invalid profile or if a profile runs, or the VISA status of the upload.
+int32_t CAPLEXPORT CAPLPASCAL appItechListLoad(uint32_t handle, double values[], int32_t count)
+{
+  TraceScope trace(kTraceCapl, "dllItechListLoad", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->LoadList(kTransportUsb, values, count);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechListLoadSerial(uint32_t handle, double values[], int32_t count)
+{
+  TraceScope trace(kTraceCapl, "dllItechListLoadSerial", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->LoadList(kTransportSerial, values, count);
+}
+
+// Trigger the loaded profile, slot after slot, through the port it was loaded with.
+// Returns 0, or -1 if no profile is loaded or it runs already.
+int32_t CAPLEXPORT CAPLPASCAL appItechListRun(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechListRun", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->RunList();
+}
+
+// Stop the profile with "ABOR". Returns 0 or the VISA status of the write.
+int32_t CAPLEXPORT CAPLPASCAL appItechListAbort(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechListAbort", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->List().Abort();
+}
+
+// Wait at most timeoutMs for the profile to end. Returns 0 when every slot ran, the
+// VISA status of the exchange that failed, 0xBFFF0010 after dllItechListAbort, 0xBFFF0015
+// if it still runs, or -1 if it was not started.
+int32_t CAPLEXPORT CAPLPASCAL appItechListWait(uint32_t handle, int32_t timeoutMs)
+{
+  TraceScope trace(kTraceCapl, "dllItechListWait", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr || timeoutMs<0)
+  {
+    return -1;
+  }
+  return inst->List().Wait((uint64_t)timeoutMs*1000000);
+}
+
+// Set up the acquisition in the memory of the supplies of the node: points samples intervalUs
+// apart, at most 65536, started by dllItechDlogStart (source 0) or armed by it for
+// dllItechDlogTrigger or the *TRG of dllItechListRun (source 1). Returns 1 if the supplies send
+// binary blocks, 0 if ASCII, -1 for invalid arguments or the VISA status that failed.
+int32_t CAPLEXPORT CAPLPASCAL appItechDlogConfig(uint32_t handle, int32_t intervalUs, int32_t points, int32_t source)
+{
+  TraceScope trace(kTraceCapl, "dllItechDlogConfig", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->ConfigureDatalog(kTransportUsb, intervalUs, points, source);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechDlogConfigSerial(uint32_t handle, int32_t intervalUs, int32_t points, int32_t source)
+{
+  TraceScope trace(kTraceCapl, "dllItechDlogConfigSerial", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->ConfigureDatalog(kTransportSerial, intervalUs, points, source);
+}
+
+// Start the acquisition, or arm it for its trigger, through the port it was configured with.
+// Returns 0, -1 before dllItechDlogConfig, or the VISA status of the write.
+int32_t CAPLEXPORT CAPLPASCAL appItechDlogStart(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechDlogStart", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->SendDatalog("INIT:ACQ");
+}
+
+// Trigger an armed acquisition. Returns 0, -1 before dllItechDlogConfig, or the VISA status.
+int32_t CAPLEXPORT CAPLPASCAL appItechDlogTrigger(uint32_t handle)
+{
+  TraceScope trace(kTraceCapl, "dllItechDlogTrigger", nullptr);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->SendDatalog("TRIG:ACQ");
+}
+
+// Wait until the acquisition of the device-th supply is done and read quantity ("FETC:ARR:VOLT?"
+// or "FETC:ARR:CURR?") into values in one transfer, at most count of them, all within timeoutMs.
+// Returns the number of values, -1 for invalid arguments or a negative VISA status.
+int32_t CAPLEXPORT CAPLPASCAL appItechDlogRead(uint32_t handle, int32_t device, char* quantity, double values[], int32_t count, int32_t timeoutMs)
+{
+  TraceScope trace(kTraceCapl, "dllItechDlogRead", quantity);
+  EpochGuard guard;
+  CaplInstanceData* inst = GetCaplInstanceData(handle);
+  if (inst==nullptr)
+  {
+    return -1;
+  }
+  return inst->ReadDatalog(device, quantity, values, count, timeoutMs);
+}
+
+// Statistics of one step (op, -1: all steps) of one instrument ("": all instruments).
+// values receives count, min, mean, p50, p90, p99, p99.9 and max in microseconds.
+int32_t CAPLEXPORT CAPLPASCAL appItechGetStats(char* resource, int32_t op, double values[], int32_t count)
+{
+  return ItechStatsGet(resource, op, values, count);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechGetStatsDevice(int32_t index, char* resource, int32_t size)
+{
+  return ItechStatsDevice(index, resource, size);
+}
+
+void CAPLEXPORT CAPLPASCAL appItechResetStats(void)
+{
+  ItechStatsReset();
+}
+
+// Minimum level of the lines written to capldlllog: 0 trace, 1 debug, 2 info, 3 warn, 4 error, 5 fatal, 6 off.
+// Returns the previous level.
+int32_t CAPLEXPORT CAPLPASCAL appItechSetLogLevel(int32_t level)
+{
+  return FileLoggerSetLevel(level);
+}
+
+// Append the last I/O events of every instrument to path ("": capldllflight).
+// Returns the number of events written or -1.
+int32_t CAPLEXPORT CAPLPASCAL appItechFlightDump(char* path)
+{
+  return FlightRecorderDump(path, "dllItechFlightDump");
+}
+
+// Add the CANoe measurement time to every line of capldlllog (0: off, 1: on).
+void CAPLEXPORT CAPLPASCAL appItechLogMeasurementTime(uint32_t enable)
+{
+  FileLoggerSetTimeSource(enable ? sMeasurementTime : nullptr);
+}
+
+// Write log lines of at least level (3: warnings and errors, 6: off) to the CANoe Write window.
+// Returns 0, or -1 if CANoe provides no debug info service.
+int32_t CAPLEXPORT CAPLPASCAL appItechLogToWriteWindow(int32_t level)
+{
+  // one caller at a time, so that a node switching off cannot release the service another just got
+  static std::mutex controlMutex;
+  std::lock_guard<std::mutex> control(controlMutex);
+
+  sCloseWriteWindow();
+  if (level>=LOG_LEVEL_OFF)
+  {
+    return 0;
+  }
+  VIADebugInfoService* debugInfo = nullptr;
+  if (gVIAService==nullptr || gVIAService->GetDebugInfoService(&debugInfo)!=kVIA_OK || debugInfo==nullptr)
+  {
+    return -1;
+  }
+  {
+    std::lock_guard<std::mutex> lock(gDebugInfoMutex);
+    gDebugInfo = debugInfo;
+  }
+  FileLoggerSetSink(sWriteWindowSink, level);
+  return 0;
+}
+
+// Log into a binary ring file of size bytes (0: 16 MB) instead of capldlllog, decoded by logdecode.
+int32_t CAPLEXPORT CAPLPASCAL appItechBinLogStart(char* path, int32_t size)
+{
+  return BinLogStart(path, size > 0 ? (uint64_t)size : 0);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechBinLogStop(void)
+{
+  return BinLogStop();
+}
+
+// Trace CAPL calls and instrument I/O into a buffer of capacity events (0: default).
+// The trace is written to path by dllItechTraceStop and dllEnd.
+int32_t CAPLEXPORT CAPLPASCAL appItechTraceStart(char* path, int32_t capacity)
+{
+  return TraceStart(path, capacity > 0 ? (uint32_t)capacity : 0);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechTraceDump(char* path)
+{
+  return TraceDump(path);
+}
+
+int32_t CAPLEXPORT CAPLPASCAL appItechTraceStop(void)
+{
+  return TraceStop();
+}
 // ============================================================================
 // CAPL_DLL_INFO_LIST : list of exported functions
 //   The first field is predefined and mustn't be changed!
 //   The list has to end with a {0,0} entry!
 // New struct supporting function names with up to 50 characters
+// CAPL_DLL_INFO5 adds the context and the flags: functions flagged
+// CAPL_FUNCTION_FLAG_THREADSAFE may be called by several CAPL nodes at the
+// same time, the others still share the globals of the original example.
 // ============================================================================
-CAPL_DLL_INFO4 table[] = {
-{CDLL_VERSION_NAME, (CAPL_FARCALL)CDLL_VERSION, "", "", CAPL_DLL_CDECL, 0xabcd, CDLL_EXPORT },
-
-  {"dllInit",           (CAPL_FARCALL)appInit,          "CAPL_DLL","This function will initialize all callback functions in the CAPLDLL",'V', 1, "D", "", {"handle"}},
-  {"dllEnd",            (CAPL_FARCALL)appEnd,           "CAPL_DLL","This function will release the CAPL function handle in the CAPLDLL",'V', 1, "D", "", {"handle"}},
-  {"dllSetValue",       (CAPL_FARCALL)appSetValue,      "CAPL_DLL","This function will call a callback functions",'L', 2, "DL", "", {"handle","x"}},
-  {"dllReadData",       (CAPL_FARCALL)appReadData,      "CAPL_DLL","This function will call a callback functions",'L', 2, "DL", "", {"handle","x"}},
-  {"dllPut",            (CAPL_FARCALL)appPut,           "CAPL_DLL","This function will save data from CAPL to DLL memory",'V', 1, "D", "", {"x"}},
-  {"dllGet",            (CAPL_FARCALL)appGet,           "CAPL_DLL","This function will read data from DLL memory to CAPL",'D', 0, "", "", {""}},
-  {"dllVoid",           (CAPL_FARCALL)voidFct,          "CAPL_DLL","This function will overwrite DLL memory from CAPL without parameter",'V', 0, "", "", {""}},
-  {"dllPutDataOnePar",  (CAPL_FARCALL)appPutDataOnePar, "CAPL_DLL","This function will put data from CAPL array to DLL",'V', 1, "B", "\001", {"datablock"}},
-  {"dllGetDataOnePar",  (CAPL_FARCALL)appGetDataOnePar, "CAPL_DLL","This function will get data from DLL into CAPL memory",'V', 1, "B", "\001", {"datablock"}},
-  {"dllPutDataTwoPars", (CAPL_FARCALL)appPutDataTwoPars,"CAPL_DLL","This function will put two datas from CAPL array to DLL",'V', 2, "DB", "\000\001", {"noOfBytes","datablock"}},// number of pars in octal format
-  {"dllGetDataTwoPars", (CAPL_FARCALL)appGetDataTwoPars,"CAPL_DLL","This function will get two datas from DLL into CAPL memory",'V', 2, "DB", "\000\001", {"noOfBytes","datablock"}},
-  {"dllAdd",            (CAPL_FARCALL)appAdd,           "CAPL_DLL","This function will add two values. The return value is the result",'L', 2, "LL", "", {"x","y"}},
-  {"dllSubtract",       (CAPL_FARCALL)appSubtract,      "CAPL_DLL","This function will substract two values. The return value is the result",'L', 2, "LL", "", {"x","y"}},
-  {"dllSupportLongFunctionNamesWithUpTo50Characters",   (CAPL_FARCALL)appLongFuncName,      "CAPL_DLL","This function shows the support of long function names",'D', 0, "", "", {""}},
-  {"dllAdd63Parameters", (CAPL_FARCALL)appAddValues63,  "CAPL_DLL", "This function will add 63 values. The return value is the result",'L', 63, "LLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLL",  "", {"val01","val02","val03","val04","val05","val06","val07","val08","val09","val10","val11","val12","val13","val14","val15","val16","val17","val18","val19","val20","val21","val22","val23","val24","val25","val26","val27","val28","val29","val30","val31","val32","val33","val34","val35","val36","val37","val38","val39","val40","val41","val42","val43","val44","val45","val46","val47","val48","val49","val50","val51","val52","val53","val54","val55","val56","val57","val58","val59","val60","val61","val62","val63"}},
-  {"dllAdd64Parameters", (CAPL_FARCALL)appAddValues64,  "CAPL_DLL", "This function will add 64 values. The return value is the result",'L', 64, {SixtyFourLongPars},                                                "", {"val01","val02","val03","val04","val05","val06","val07","val08","val09","val10","val11","val12","val13","val14","val15","val16","val17","val18","val19","val20","val21","val22","val23","val24","val25","val26","val27","val28","val29","val30","val31","val32","val33","val34","val35","val36","val37","val38","val39","val40","val41","val42","val43","val44","val45","val46","val47","val48","val49","val50","val51","val52","val53","val54","val55","val56","val57","val58","val59","val60","val61","val62","val63","val64"}},
-  // {"dllItechDcPowerOutput", (CAPL_FARCALL)appItechDcPowerOutput,  "ITECHDC", "This function will set output state of a ITECH DC power.",'V', 1, "D", "", {"state"}},
-  {"dllItechDcPowerWrite", (CAPL_FARCALL)appItechDcPowerWrite,  "ITECHDC", "This function will write a SCPI command to a ITECH DC power through USB port.",'V', 1, "C", "\001", {"command"}},
-  {"dllItechDcPowerQuery", (CAPL_FARCALL)appItechDcPowerQuery,  "ITECHDC", "This function will query a SCPI command to a ITECH DC power through USB port.",'V', 3, {'C','C','F'-128}, "\001\001\000", {"command","resultString","result"}},
-  {"dllItechDcPowerWriteSerial", (CAPL_FARCALL)appItechDcPowerWriteSerial,  "ITECHDC", "This function will write a SCPI command to a ITECH DC power through RS232 port.",'V', 1, "C", "\001", {"command"}},
-  {"dllItechDcPowerQuerySerial", (CAPL_FARCALL)appItechDcPowerQuerySerial,  "ITECHDC", "This function will query a SCPI command to a ITECH DC power through RS232 port.",'V', 3, {'C','C','F'-128}, "\001\001\000", {"command","resultString","result"}},
+CAPL_DLL_INFO5 table[] = {
+{CDLL_VERSION_NAME, (CAPL_FARCALL)CDLL_VERSION, CAPL_CONTEXT_ALL, "", "", CAPL_DLL_CDECL, 0xabcd, CDLL_EXPORT },
+
+  {"dllInit",           (CAPL_FARCALL)appInit,          CAPL_CONTEXT_ALL, "CAPL_DLL","This function will initialize all callback functions in the CAPLDLL",'V', 1, "D", "", {"handle"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllEnd",            (CAPL_FARCALL)appEnd,           CAPL_CONTEXT_ALL, "CAPL_DLL","This function will release the CAPL function handle in the CAPLDLL",'V', 1, "D", "", {"handle"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllSetValue",       (CAPL_FARCALL)appSetValue,      CAPL_CONTEXT_ALL, "CAPL_DLL","This function will call a callback functions",'L', 2, "DL", "", {"handle","x"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllReadData",       (CAPL_FARCALL)appReadData,      CAPL_CONTEXT_ALL, "CAPL_DLL","This function will call a callback functions",'L', 2, "DL", "", {"handle","x"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllPut",            (CAPL_FARCALL)appPut,           CAPL_CONTEXT_ALL, "CAPL_DLL","This function will save data from CAPL to DLL memory",'V', 1, "D", "", {"x"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllGet",            (CAPL_FARCALL)appGet,           CAPL_CONTEXT_ALL, "CAPL_DLL","This function will read data from DLL memory to CAPL",'D', 0, "", "", {""}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllVoid",           (CAPL_FARCALL)voidFct,          CAPL_CONTEXT_ALL, "CAPL_DLL","This function will overwrite DLL memory from CAPL without parameter",'V', 0, "", "", {""}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllPutDataOnePar",  (CAPL_FARCALL)appPutDataOnePar, CAPL_CONTEXT_ALL, "CAPL_DLL","This function will put data from CAPL array to DLL",'V', 1, "B", "\001", {"datablock"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllGetDataOnePar",  (CAPL_FARCALL)appGetDataOnePar, CAPL_CONTEXT_ALL, "CAPL_DLL","This function will get data from DLL into CAPL memory",'V', 1, "B", "\001", {"datablock"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllPutDataTwoPars", (CAPL_FARCALL)appPutDataTwoPars,CAPL_CONTEXT_ALL, "CAPL_DLL","This function will put two datas from CAPL array to DLL",'V', 2, "DB", "\000\001", {"noOfBytes","datablock"}, CAPL_FUNCTION_FLAG_DEFAULT},// number of pars in octal format
+  {"dllGetDataTwoPars", (CAPL_FARCALL)appGetDataTwoPars,CAPL_CONTEXT_ALL, "CAPL_DLL","This function will get two datas from DLL into CAPL memory",'V', 2, "DB", "\000\001", {"noOfBytes","datablock"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllAdd",            (CAPL_FARCALL)appAdd,           CAPL_CONTEXT_ALL, "CAPL_DLL","This function will add two values. The return value is the result",'L', 2, "LL", "", {"x","y"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllSubtract",       (CAPL_FARCALL)appSubtract,      CAPL_CONTEXT_ALL, "CAPL_DLL","This function will substract two values. The return value is the result",'L', 2, "LL", "", {"x","y"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllSupportLongFunctionNamesWithUpTo50Characters",   (CAPL_FARCALL)appLongFuncName,      CAPL_CONTEXT_ALL, "CAPL_DLL","This function shows the support of long function names",'D', 0, "", "", {""}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllAdd63Parameters", (CAPL_FARCALL)appAddValues63,  CAPL_CONTEXT_ALL, "CAPL_DLL", "This function will add 63 values. The return value is the result",'L', 63, "LLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLL",  "", {"val01","val02","val03","val04","val05","val06","val07","val08","val09","val10","val11","val12","val13","val14","val15","val16","val17","val18","val19","val20","val21","val22","val23","val24","val25","val26","val27","val28","val29","val30","val31","val32","val33","val34","val35","val36","val37","val38","val39","val40","val41","val42","val43","val44","val45","val46","val47","val48","val49","val50","val51","val52","val53","val54","val55","val56","val57","val58","val59","val60","val61","val62","val63"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllAdd64Parameters", (CAPL_FARCALL)appAddValues64,  CAPL_CONTEXT_ALL, "CAPL_DLL", "This function will add 64 values. The return value is the result",'L', 64, {SixtyFourLongPars},                                                "", {"val01","val02","val03","val04","val05","val06","val07","val08","val09","val10","val11","val12","val13","val14","val15","val16","val17","val18","val19","val20","val21","val22","val23","val24","val25","val26","val27","val28","val29","val30","val31","val32","val33","val34","val35","val36","val37","val38","val39","val40","val41","val42","val43","val44","val45","val46","val47","val48","val49","val50","val51","val52","val53","val54","val55","val56","val57","val58","val59","val60","val61","val62","val63","val64"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  // {"dllItechDcPowerOutput", (CAPL_FARCALL)appItechDcPowerOutput,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will set output state of a ITECH DC power.",'V', 1, "D", "", {"state"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDcPowerWrite", (CAPL_FARCALL)appItechDcPowerWrite,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write a SCPI command to a ITECH DC power through USB port.",'V', 1, "C", "\001", {"command"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDcPowerQuery", (CAPL_FARCALL)appItechDcPowerQuery,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will query a SCPI command to a ITECH DC power through USB port.",'V', 3, {'C','C','F'-128}, "\001\001\000", {"command","resultString","result"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDcPowerWriteSerial", (CAPL_FARCALL)appItechDcPowerWriteSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write a SCPI command to a ITECH DC power through RS232 port.",'V', 1, "C", "\001", {"command"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDcPowerQuerySerial", (CAPL_FARCALL)appItechDcPowerQuerySerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will query a SCPI command to a ITECH DC power through RS232 port.",'V', 3, {'C','C','F'-128}, "\001\001\000", {"command","resultString","result"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechNodeWrite", (CAPL_FARCALL)appItechNodeWrite,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write a SCPI command to the ITECH DC powers of this node through USB port, the sessions stay open until dllEnd.",'L', 2, "DC", "\000\001", {"handle","command"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechNodeQuery", (CAPL_FARCALL)appItechNodeQuery,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will query a SCPI command to the ITECH DC powers of this node through USB port, the sessions stay open until dllEnd. The reply is cut to size bytes.",'L', 5, {'D','C','C','L','F'-128}, "\000\001\001\000\000", {"handle","command","resultString","size","result"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechNodeWriteSerial", (CAPL_FARCALL)appItechNodeWriteSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write a SCPI command to the ITECH DC power of this node through RS232 port, the session stays open until dllEnd.",'L', 2, "DC", "\000\001", {"handle","command"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechNodeQuerySerial", (CAPL_FARCALL)appItechNodeQuerySerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will query a SCPI command to the ITECH DC power of this node through RS232 port, the session stays open until dllEnd. The reply is cut to size bytes.",'L', 5, {'D','C','C','L','F'-128}, "\000\001\001\000\000", {"handle","command","resultString","size","result"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechWaitComplete", (CAPL_FARCALL)appItechWaitComplete,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will wait with *OPC? until the ITECH DC powers of this node finished every command sent before through USB port, at most timeoutMs. The return value is 0 or the VISA status, e.g. timeout.",'L', 2, "DL", "\000\000", {"handle","timeoutMs"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechWaitCompleteSerial", (CAPL_FARCALL)appItechWaitCompleteSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will wait with *OPC? until the ITECH DC power of this node finished every command sent before through RS232 port, at most timeoutMs. The return value is 0 or the VISA status, e.g. timeout.",'L', 2, "DL", "\000\000", {"handle","timeoutMs"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechWaitSettled", (CAPL_FARCALL)appItechWaitSettled,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will measure quantity of the device-th ITECH DC power of this node through USB port until it stayed within target +- tolerance for stableMs, at most timeoutMs. The return value is the settle time in ms or a negative VISA status, e.g. timeout.",'L', 7, "DLCFFLL", "\000\000\001\000\000\000\000", {"handle","device","quantity","target","tolerance","stableMs","timeoutMs"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechWaitSettledSerial", (CAPL_FARCALL)appItechWaitSettledSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will measure quantity of the device-th ITECH DC power of this node through RS232 port until it stayed within target +- tolerance for stableMs, at most timeoutMs. The return value is the settle time in ms or a negative VISA status, e.g. timeout.",'L', 7, "DLCFFLL", "\000\000\001\000\000\000\000", {"handle","device","quantity","target","tolerance","stableMs","timeoutMs"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechSampleStart", (CAPL_FARCALL)appItechSampleStart,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will query command every periodUs (0: back to back) on the device-th ITECH DC power of this node through USB port and call CALLBACK_ItechSamples(double samples[], dword count, double firstTime) once batchSize samples are there or the first is maxLatencyMs old.",'L', 6, "DLCLLL", "\000\000\001\000\000\000", {"handle","device","command","periodUs","batchSize","maxLatencyMs"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSampleStartSerial", (CAPL_FARCALL)appItechSampleStartSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will query command every periodUs (0: back to back) on the device-th ITECH DC power of this node through RS232 port and call CALLBACK_ItechSamples once batchSize samples are there or the first is maxLatencyMs old.",'L', 6, "DLCLLL", "\000\000\001\000\000\000", {"handle","device","command","periodUs","batchSize","maxLatencyMs"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSampleStop", (CAPL_FARCALL)appItechSampleStop,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will stop sampling and deliver the samples still queued. The return value is the number of samples dropped because CAPL did not keep up.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechRuleAdd", (CAPL_FARCALL)appItechRuleAdd,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will add a rule on the value of command of the device-th ITECH DC power of this node (kind 0: above limits[0], 1: below, 2: change per second, 3: bits limits[0] change; limits[1]: hysteresis). The return value is the rule id.",'L', 6, "DLCLFL", "\000\000\001\000\001\000", {"handle","device","command","kind","limits","count"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechRuleRemove", (CAPL_FARCALL)appItechRuleRemove,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will remove a rule of this node.",'L', 2, "DL", "\000\000", {"handle","rule"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechMonitorStart", (CAPL_FARCALL)appItechMonitorStart,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will evaluate the rules of this node every periodUs through USB port and call CALLBACK_ItechRule(long rule, long device, double value, double previous, double time) when one triggers.",'L', 2, "DL", "\000\000", {"handle","periodUs"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechMonitorStartSerial", (CAPL_FARCALL)appItechMonitorStartSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will evaluate the rules of this node every periodUs through RS232 port and call CALLBACK_ItechRule when one triggers.",'L', 2, "DL", "\000\000", {"handle","periodUs"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechMonitorStop", (CAPL_FARCALL)appItechMonitorStop,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will stop evaluating the rules and deliver the events still queued. The return value is the number of events dropped.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSrqStart", (CAPL_FARCALL)appItechSrqStart,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will set *SRE, *ESE and STAT:QUES:ENAB on the ITECH DC powers of this node through USB port and call CALLBACK_ItechSrq(long device, long statusByte, long eventStatus, long questionable, double time) for every service request; a power without SRQ is polled every pollUs.",'L', 5, "DLLLL", "\000\000\000\000\000", {"handle","serviceEnable","eventEnable","questionableEnable","pollUs"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSrqStartSerial", (CAPL_FARCALL)appItechSrqStartSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will set *SRE, *ESE and STAT:QUES:ENAB on the ITECH DC power of this node through RS232 port and poll its status byte every pollUs, calling CALLBACK_ItechSrq when an enabled bit comes up.",'L', 5, "DLLLL", "\000\000\000\000\000", {"handle","serviceEnable","eventEnable","questionableEnable","pollUs"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSrqStop", (CAPL_FARCALL)appItechSrqStop,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will stop watching for service requests, clear *SRE and deliver the requests still queued. The return value is the number of requests dropped.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSeqAdd", (CAPL_FARCALL)appItechSeqAdd,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will add a step to the sequence of this node: command is written offsetUs after dllItechSeqStart. The return value is the index of the step.",'L', 3, "DLC", "\000\000\001", {"handle","offsetUs","command"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechSeqClear", (CAPL_FARCALL)appItechSeqClear,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will remove the steps of the sequence of this node and their results.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechSeqStart", (CAPL_FARCALL)appItechSeqStart,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will run the sequence of this node through USB port on a thread of its own and call CALLBACK_ItechSeqStep(long step, long status, double errorUs, double time) per step and CALLBACK_ItechSeqDone(long executed, long aborted, double maxErrorUs) at the end.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSeqStartSerial", (CAPL_FARCALL)appItechSeqStartSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will run the sequence of this node through RS232 port on a thread of its own and call CALLBACK_ItechSeqStep per step and CALLBACK_ItechSeqDone at the end.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSeqAbort", (CAPL_FARCALL)appItechSeqAbort,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will abort the sequence of this node before its next step and deliver the results still queued. The return value is the number of steps not run.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_DEFAULT},
+  {"dllItechSeqResult", (CAPL_FARCALL)appItechSeqResult,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will read the status, timing error and duration in us of one step of the sequence of this node. The return value is the number of values or -1 if the step did not run.",'L', 4, "DLFL", "\000\000\001\000", {"handle","step","values","count"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechListLoad", (CAPL_FARCALL)appItechListLoad,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will compile the profile (voltage, current, width in s per step) to LIST commands and upload it to the ITECH DC powers of this node through USB port in one write, split into slots of 100 steps. The return value is the number of slots.",'L', 3, "DFL", "\000\001\000", {"handle","values","count"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechListLoadSerial", (CAPL_FARCALL)appItechListLoadSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will compile the profile (voltage, current, width in s per step) to LIST commands and upload it to the ITECH DC power of this node through RS232 port. The return value is the number of slots.",'L', 3, "DFL", "\000\001\000", {"handle","values","count"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechListRun", (CAPL_FARCALL)appItechListRun,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will trigger the LIST slots of the loaded profile one after the other, timed by the supplies.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechListAbort", (CAPL_FARCALL)appItechListAbort,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will stop the profile of this node with ABOR.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechListWait", (CAPL_FARCALL)appItechListWait,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will wait at most timeoutMs for the profile of this node to end. The return value is 0 or a negative VISA status, e.g. timeout.",'L', 2, "DL", "\000\000", {"handle","timeoutMs"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDlogConfig", (CAPL_FARCALL)appItechDlogConfig,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will set up the acquisition of points samples intervalUs apart in the memory of the ITECH DC powers of this node through USB port, started by dllItechDlogStart (source 0) or a trigger (source 1). The return value is 1 for binary, 0 for ASCII transfer.",'L', 4, "DLLL", "\000\000\000\000", {"handle","intervalUs","points","source"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDlogConfigSerial", (CAPL_FARCALL)appItechDlogConfigSerial,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will set up the acquisition of points samples intervalUs apart in the memory of the ITECH DC power of this node through RS232 port. The return value is 1 for binary, 0 for ASCII transfer.",'L', 4, "DLLL", "\000\000\000\000", {"handle","intervalUs","points","source"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDlogStart", (CAPL_FARCALL)appItechDlogStart,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will start the acquisition of this node with INIT:ACQ, or arm it for its trigger.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDlogTrigger", (CAPL_FARCALL)appItechDlogTrigger,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will trigger the armed acquisition of this node with TRIG:ACQ.",'L', 1, "D", "\000", {"handle"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechDlogRead", (CAPL_FARCALL)appItechDlogRead,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will wait for the acquisition of the device-th ITECH DC power of this node and read quantity (e.g. FETC:ARR:VOLT?) into values in one transfer, at most timeoutMs. The return value is the number of values or a negative VISA status.",'L', 6, "DLCFLL", "\000\000\001\001\000\000", {"handle","device","quantity","values","count","timeoutMs"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechGetStats", (CAPL_FARCALL)appItechGetStats,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will read the latency statistics (count, min, mean, p50, p90, p99, p99.9, max in us) of one step (-1: all) of one device (\"\": all).",'L', 4, "CLFL", "\001\000\001\000", {"resource","op","values","count"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechGetStatsDevice", (CAPL_FARCALL)appItechGetStatsDevice,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will read the resource name of the index-th device with statistics.",'L', 3, "LCL", "\000\001\000", {"index","resource","size"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechResetStats", (CAPL_FARCALL)appItechResetStats,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will reset the latency statistics, e.g. at the start of a testcase.",'V', 0, "", "", {""}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechSetLogLevel", (CAPL_FARCALL)appItechSetLogLevel,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will set the minimum level of the lines written to capldlllog (0 trace, 1 debug, 2 info, 3 warn, 4 error, 5 fatal, 6 off). The return value is the previous level.",'L', 1, "L", "\000", {"level"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechFlightDump", (CAPL_FARCALL)appItechFlightDump,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will append the last I/O events of every instrument to path (\"\": capldllflight). The return value is the number of events.",'L', 1, "C", "\001", {"path"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechLogMeasurementTime", (CAPL_FARCALL)appItechLogMeasurementTime,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will add the measurement time in seconds to every line of capldlllog (0: off, 1: on).",'V', 1, "D", "\000", {"enable"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechLogToWriteWindow", (CAPL_FARCALL)appItechLogToWriteWindow,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write log lines of at least level (3: warnings and errors, 6: off) to the Write window, repeats merged and at most 5 lines per second. The return value is -1 without the CANoe debug info service.",'L', 1, "L", "\000", {"level"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechBinLogStart", (CAPL_FARCALL)appItechBinLogStart,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write the log into a binary ring file of size bytes (0: 16 MB) at path instead of capldlllog, turned into text by logdecode.",'L', 2, "CL", "\001\000", {"path","size"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechBinLogStop", (CAPL_FARCALL)appItechBinLogStop,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write the binary log to disk and go back to capldlllog.",'L', 0, "", "", {""}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechTraceStart", (CAPL_FARCALL)appItechTraceStart,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will start tracing CAPL calls and instrument I/O into a buffer of capacity events (0: default), written to path in Chrome trace_event format at dllEnd.",'L', 2, "CL", "\001\000", {"path","capacity"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechTraceDump", (CAPL_FARCALL)appItechTraceDump,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write the trace recorded so far to path (\"\": the path of dllItechTraceStart). The return value is the number of events.",'L', 1, "C", "\001", {"path"}, CAPL_FUNCTION_FLAG_THREADSAFE},
+  {"dllItechTraceStop", (CAPL_FARCALL)appItechTraceStop,  CAPL_CONTEXT_ALL, "ITECHDC", "This function will write the trace and stop tracing. The return value is the number of events.",'L', 0, "", "", {""}, CAPL_FUNCTION_FLAG_THREADSAFE},
 
 {0, 0}
 };
-CAPLEXPORT CAPL_DLL_INFO4* caplDllTable4 = table;
+CAPLEXPORT CAPL_DLL_INFO5* caplDllTable5 = table;
 
 
 
@@ -0,0 +1,104 @@
+/**
+ * @file datalog.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Acquisitions in the memory of the supply, read back in one block.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+#include "datalog.h"
+#include "opstats.h"
+#include "transport.h"
+
+int DatalogCommands(double intervalS, uint32_t points, int source, std::string* commands)
+{
+    commands->clear();
+    if (!(intervalS >= DATALOG_MIN_INTERVAL) || !(intervalS <= DATALOG_MAX_INTERVAL) || points == 0
+        || points > DATALOG_MAX_POINTS || (source != kDatalogImmediate && source != kDatalogBus))
+    {
+        return -1; /* negated, so NaN fails too */
+    }
+    char text[128];
+    snprintf(text, sizeof(text), "SENS:SWE:TINT %.6g;SENS:SWE:POIN %u;TRIG:ACQ:SOUR %s", intervalS, points,
+             source == kDatalogBus ? "BUS" : "IMM");
+    *commands = text;
+    return 0;
+}
+
+int DecodeDatalog(const std::string& data, DatalogFormat format, double* values, uint32_t capacity)
+{
+    ItechOpScope parseScope(kItechOpParse, nullptr);
+    uint32_t count = 0;
+    if (format == kDatalogReal32)
+    {
+        if (data.size() % 4 != 0)
+        {
+            return -1;
+        }
+        const unsigned char* bytes = (const unsigned char*)data.data();
+        for (size_t i = 0; i < data.size() && count < capacity; i += 4)
+        {
+            uint32_t word = ((uint32_t)bytes[i] << 24) | ((uint32_t)bytes[i + 1] << 16) | ((uint32_t)bytes[i + 2] << 8)
+                            | (uint32_t)bytes[i + 3];
+            float value;
+            memcpy(&value, &word, sizeof(value));
+            values[count++] = value;
+        }
+        return (int)count;
+    }
+
+    const char* text = data.c_str();
+    while (*text != '\0' && count < capacity)
+    {
+        char* end = nullptr;
+        double value = strtod(text, &end);
+        if (end == text)
+        {
+            return -1;
+        }
+        values[count++] = value;
+        while (*end == ' ')
+        {
+            end++;
+        }
+        if (*end != ',' && *end != '\0')
+        {
+            return -1;
+        }
+        text = *end == ',' ? end + 1 : end;
+    }
+    return (int)count;
+}
+
+int WaitDatalog(DatalogQuery query, void* context, uint64_t timeoutNs)
+{
+    uint64_t deadline = ItechNowNs() + timeoutNs;
+    for (;;)
+    {
+        double operation = 0.0;
+        int status = query(context, "STAT:OPER:COND?", &operation);
+        if (status < 0)
+        {
+            return status;
+        }
+        if (((int)operation & (DATALOG_OPER_WAITING | DATALOG_OPER_MEASURING)) == 0)
+        {
+            return kTransportOk;
+        }
+        uint64_t now = ItechNowNs();
+        if (now >= deadline)
+        {
+            return kTransportErrorTimeout;
+        }
+        uint64_t pause = deadline - now < DATALOG_POLL_NS ? deadline - now : DATALOG_POLL_NS;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(pause));
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file datalog.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Acquisitions in the memory of the supply, read back in one block.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * A query per sample cannot go faster than the round trip to the supply.
+ * The supply can digitize a burst on its own instead: "SENS:SWE:TINT" and
+ * "SENS:SWE:POIN" set the interval and the number of points,
+ * "TRIG:ACQ:SOUR" whether "INIT:ACQ" starts at once or waits for a bus
+ * trigger. Once the operation status shows neither waiting nor measuring,
+ * "FETC:ARR:VOLT?" or "FETC:ARR:CURR?" returns every point in one reply,
+ * with "FORM REAL,32" as an IEEE 488.2 binary block of big endian floats,
+ * four bytes a point instead of a dozen characters.
+ */
+#ifndef DATALOG_H
+#define DATALOG_H
+
+#include <stdint.h>
+#include <string>
+
+/* Points of one acquisition, and its shortest and longest interval, s. */
+#define DATALOG_MAX_POINTS      65536
+#define DATALOG_MIN_INTERVAL    0.00001
+#define DATALOG_MAX_INTERVAL    3600.0
+/* Operation status bits of an acquisition waiting for its trigger and running. */
+#define DATALOG_OPER_WAITING    0x0008
+#define DATALOG_OPER_MEASURING  0x0010
+/* The operation status is polled this often until the acquisition is done. */
+#define DATALOG_POLL_NS         5000000ULL
+
+enum DatalogSource
+{
+    kDatalogImmediate = 0, /* "INIT:ACQ" starts it                              */
+    kDatalogBus       = 1, /* "INIT:ACQ" arms it, "TRIG:ACQ" or "*TRG" start it */
+};
+
+enum DatalogFormat
+{
+    kDatalogAscii  = 0, /* comma separated numbers         */
+    kDatalogReal32 = 1, /* binary block, big endian floats */
+};
+
+/*
+ * The commands setting up an acquisition of points points intervalS apart,
+ * one program message. Returns 0, or -1 if an argument is out of range.
+ */
+int DatalogCommands(double intervalS, uint32_t points, int source, std::string* commands);
+
+/*
+ * Convert the reply of a fetch, the bytes of the block for kDatalogReal32,
+ * into at most capacity values. Returns the number of values stored, or -1
+ * if the data does not fit the format.
+ */
+int DecodeDatalog(const std::string& data, DatalogFormat format, double* values, uint32_t capacity);
+
+/**
+ * @brief Reads the operation status of the supply, returns a status < 0 if it failed.
+ */
+typedef int (*DatalogQuery)(void* context, const char* command, double* value);
+
+/*
+ * Poll the operation status with query every DATALOG_POLL_NS until the
+ * acquisition neither waits nor measures, at most timeoutNs. Returns 0, the
+ * status of a failed query, or kTransportErrorTimeout.
+ */
+int WaitDatalog(DatalogQuery query, void* context, uint64_t timeoutNs);
+
+#endif
@@ -0,0 +1,630 @@
+/**
+ * @file itechdc.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief SCPI exchange with ITECH DC power supplies on top of a transport.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+/********************************************************************/
+/* The general flow of an exchange is                               */
+/*    Find the instruments of the backend                           */
+/*    Open a session to each instrument                             */
+/*    Write the Identification Query and read the response          */
+/*    Write the command and, for a query, read the response         */
+/*    Close the session                                             */
+/*                                                                  */
+/* An ItechDcContext does the finding, opening and identification  */
+/* once and keeps the sessions of one CAPL node open between calls. */
+/*                                                                  */
+/* Nothing is shared between calls but the lock of each instrument, */
+/* so any number of threads may call ItechDcPowerExchange.          */
+/********************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "itechdc.h"
+#include "minilogger.h"
+#include "opstats.h"
+
+/* Log one line and account the time to the logging step, nothing if the level is off. */
+#define ITECH_LOG(level, resource, ...) \
+    do \
+    { \
+        if (LOG_ENABLED(level)) \
+        { \
+            ItechOpScope logScope(kItechOpLog, resource); \
+            LOG_WRITE(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+/*
+ * Name the log file on the first exchange only. FileLoggerInit takes the lock
+ * of the writer, calling it on every exchange would make all CAPL nodes take
+ * turns on it.
+ */
+static void sLogFileInit()
+{
+    static std::once_flag once;
+    std::call_once(once, [] { FileLoggerInit("capldlllog"); });
+}
+
+/*
+ * One lock per instrument, held from open to close. Calls to different
+ * instruments run in parallel, calls to the same instrument take turns so a
+ * reply is always read by the thread that asked for it. Locks are never
+ * removed, a reference stays valid for the life of the dll.
+ */
+static std::mutex& sDeviceLock(const std::string& resource)
+{
+    static std::mutex registryMutex;
+    static std::map<std::string, std::unique_ptr<std::mutex> > locks;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::unique_ptr<std::mutex>& deviceLock = locks[resource];
+    if (!deviceLock)
+    {
+        deviceLock.reset(new std::mutex());
+    }
+    return *deviceLock;
+}
+
+static TransportStatus sWriteLine(Transport* transport, const char* command)
+{
+    std::string line(command);
+    line += transport->CommandTerminator();
+    return transport->Write(line.c_str(), line.size());
+}
+
+static TransportStatus sReadLine(Transport* transport, char* buffer, size_t* count)
+{
+    /*
+     * Read back at most ITECHDC_REPLY_SIZE - 1 bytes. The read stops at
+     * the termination character, the reply is always zero terminated.
+     */
+    TransportStatus status = transport->ReadUntil(buffer, ITECHDC_REPLY_SIZE - 1, '\n', count);
+    buffer[status < kTransportOk ? 0 : *count] = '\0';
+    return status;
+}
+
+/*
+ * Ask for the identification of the instrument. Only a failed write is
+ * returned, a missing reply is logged and the exchange goes on.
+ */
+static TransportStatus sIdentify(Transport* transport, const std::string& resource, int number, std::string* identity)
+{
+    char buffer[ITECHDC_REPLY_SIZE];
+    size_t retCount;
+
+    TransportStatus status = sWriteLine(transport, "*IDN?");
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, resource.c_str(), "Error writing to the device %d.", number);
+        return status;
+    }
+
+    status = sReadLine(transport, buffer, &retCount);
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, resource.c_str(), "Error reading a response from the device %d.", number);
+    }
+    else
+    {
+        ITECH_LOG(LOG_LEVEL_INFO, resource.c_str(), "Device %d: %s", number, buffer);
+        if (identity != nullptr)
+        {
+            identity->assign(buffer, retCount);
+        }
+    }
+    return kTransportOk;
+}
+
+/* Write the command and, for a query, read and convert the reply, cut to resultSize with its terminator. */
+static TransportStatus sSend(Transport* transport, const std::string& resource, int number, const char* command,
+                             char* resultString, size_t resultSize, double* result)
+{
+    char buffer[ITECHDC_REPLY_SIZE];
+    size_t retCount;
+
+    TransportStatus status = sWriteLine(transport, command);
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, resource.c_str(), "Error writing to the device %d.", number);
+        return status;
+    }
+    if (resultString == nullptr)
+    {
+        return kTransportOk;
+    }
+
+    status = sReadLine(transport, buffer, &retCount);
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, resource.c_str(), "Error reading a response from the device %d.", number);
+        return status;
+    }
+    if (result != nullptr)
+    {
+        {
+            ItechOpScope parseScope(kItechOpParse, resource.c_str());
+            sscanf(buffer, "%lf", result);
+        }
+        ITECH_LOG(LOG_LEVEL_INFO, resource.c_str(), "Measured value: %lf", *result);
+    }
+    if (resultSize > 0)
+    {
+        size_t copied = retCount < resultSize ? retCount : resultSize - 1;
+        memcpy(resultString, buffer, copied);
+        resultString[copied] = '\0';
+    }
+    return kTransportOk;
+}
+
+/*
+ * Read a reply that may be an IEEE 488.2 definite length block,
+ * "#<digits><length><bytes>" and the terminator, or else a line of text
+ * (without its terminator).
+ */
+static TransportStatus sReadBlock(Transport* transport, const std::string& resource, int number, std::string* data)
+{
+    char header[16];
+    size_t retCount = 0;
+
+    data->clear();
+    TransportStatus status = transport->Read(header, 2, &retCount);
+    if (status >= kTransportOk && header[0] != '#')
+    {
+        data->assign(header, 2);
+        char chunk[ITECHDC_REPLY_SIZE];
+        while ((*data)[data->size() - 1] != '\n' && status >= kTransportOk)
+        {
+            status = data->size() > ITECHDC_BLOCK_MAX ? kTransportErrorIo
+                                                      : transport->ReadUntil(chunk, sizeof(chunk), '\n', &retCount);
+            data->append(chunk, status < kTransportOk ? 0 : retCount);
+        }
+        while (!data->empty() && ((*data)[data->size() - 1] == '\n' || (*data)[data->size() - 1] == '\r'))
+        {
+            data->erase(data->size() - 1);
+        }
+    }
+    else if (status >= kTransportOk)
+    {
+        /* "#0" is a block of indefinite length, the instruments do not send one */
+        size_t digits = (size_t)(header[1] - '0');
+        status = (digits < 1 || digits > 9) ? kTransportErrorIo : transport->Read(header, digits, &retCount);
+        size_t length = 0;
+        for (size_t i = 0; status >= kTransportOk && i < digits; i++)
+        {
+            if (header[i] < '0' || header[i] > '9')
+            {
+                status = kTransportErrorIo;
+            }
+            length = length * 10 + (size_t)(header[i] - '0');
+        }
+        if (status >= kTransportOk && length > ITECHDC_BLOCK_MAX)
+        {
+            status = kTransportErrorIo;
+        }
+        if (status >= kTransportOk && length > 0)
+        {
+            data->resize(length);
+            status = transport->Read(&(*data)[0], length, &retCount);
+        }
+        if (status >= kTransportOk)
+        {
+            status = transport->ReadUntil(header, sizeof(header), '\n', &retCount);
+        }
+    }
+
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, resource.c_str(), "Error reading a block from the device %d.", number);
+        data->clear();
+    }
+    else
+    {
+        ITECH_LOG(LOG_LEVEL_INFO, resource.c_str(), "Device %d: %u bytes", number, (unsigned)data->size());
+    }
+    return status;
+}
+
+/* Take the lock of an instrument, the time waited for it is counted. */
+static void sLockDevice(std::unique_lock<std::mutex>* deviceLock, const std::string& resource)
+{
+    *deviceLock = std::unique_lock<std::mutex>(sDeviceLock(resource), std::defer_lock);
+    if (!deviceLock->try_lock())
+    {
+        ItechOpScope waitScope(kItechOpWait, resource.c_str());
+        deviceLock->lock();
+    }
+}
+
+int ItechDcPowerExchange(TransportKind kind, const char* command, char* resultString, double* result)
+{
+    TransportStatus status;
+    TransportStatus lastError = kTransportOk;
+
+    sLogFileInit();
+
+    std::unique_ptr<Transport> transport(CreateTransport(kind));
+    if (!transport)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, nullptr, "Could not create a transport for backend %d!", (int)kind);
+        return kTransportErrorNotFound;
+    }
+
+    std::vector<std::string> resources;
+    status = transport->Discover(&resources);
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, nullptr, "An error occurred while finding resources.");
+        return status;
+    }
+
+    for (size_t i = 0; i < resources.size(); i++)
+    {
+        std::unique_lock<std::mutex> deviceLock;
+        sLockDevice(&deviceLock, resources[i]);
+
+        status = transport->Open(resources[i].c_str());
+        ITECH_LOG(LOG_LEVEL_INFO, resources[i].c_str(), "%s", resources[i].c_str());
+        if (status < kTransportOk)
+        {
+            ITECH_LOG(LOG_LEVEL_ERROR, resources[i].c_str(), "Cannot open a session to the device %d.", (int)i + 1);
+            lastError = status;
+            continue;
+        }
+
+        /*
+         * At this point we now have a session open to the instrument.
+         * Ask for the device's identification first.
+         */
+        status = sIdentify(transport.get(), resources[i], (int)i + 1, nullptr);
+        if (status >= kTransportOk)
+        {
+            status = sSend(transport.get(), resources[i], (int)i + 1, command, resultString, ITECHDC_REPLY_SIZE, result);
+        }
+        if (status < kTransportOk)
+        {
+            lastError = status;
+        }
+
+        transport->Close();
+    }
+
+    return lastError;
+}
+
+ItechDcContext::ItechDcContext()
+{
+    for (int kind = 0; kind < kTransportKindCount; kind++)
+    {
+        mDiscovered[kind] = false;
+    }
+}
+
+ItechDcContext::~ItechDcContext()
+{
+    Release();
+}
+
+void ItechDcContext::Release()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (int kind = 0; kind < kTransportKindCount; kind++)
+    {
+        for (size_t i = 0; i < mDevices[kind].size(); i++)
+        {
+            CloseSession(mDevices[kind][i]);
+        }
+        mDevices[kind].clear();
+        mDiscovered[kind] = false;
+    }
+}
+
+size_t ItechDcContext::OpenSessions() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t count = 0;
+    for (int kind = 0; kind < kTransportKindCount; kind++)
+    {
+        for (size_t i = 0; i < mDevices[kind].size(); i++)
+        {
+            count += mDevices[kind][i].session ? 1 : 0;
+        }
+    }
+    return count;
+}
+
+void ItechDcContext::CloseSession(Device& device)
+{
+    if (device.session)
+    {
+        std::unique_lock<std::mutex> deviceLock;
+        sLockDevice(&deviceLock, device.resource);
+        device.session->Close();
+        device.session.reset();
+    }
+    device.identity.clear();
+}
+
+/* Find the resources again, sessions to instruments still present are kept. */
+TransportStatus ItechDcContext::Discover(TransportKind kind)
+{
+    std::unique_ptr<Transport> transport(CreateTransport(kind));
+    if (!transport)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, nullptr, "Could not create a transport for backend %d!", (int)kind);
+        return kTransportErrorNotFound;
+    }
+
+    std::vector<std::string> resources;
+    TransportStatus status = transport->Discover(&resources);
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, nullptr, "An error occurred while finding resources.");
+        return status;
+    }
+
+    std::vector<Device> devices(resources.size());
+    for (size_t i = 0; i < resources.size(); i++)
+    {
+        devices[i].resource = resources[i];
+        for (size_t j = 0; j < mDevices[kind].size(); j++)
+        {
+            if (mDevices[kind][j].resource == resources[i] && mDevices[kind][j].session)
+            {
+                devices[i].session = std::move(mDevices[kind][j].session);
+                devices[i].identity = mDevices[kind][j].identity;
+            }
+        }
+    }
+    for (size_t j = 0; j < mDevices[kind].size(); j++)
+    {
+        CloseSession(mDevices[kind][j]); /* gone */
+    }
+    mDevices[kind].swap(devices);
+    mDiscovered[kind] = true;
+    return kTransportOk;
+}
+
+int ItechDcContext::Resources(TransportKind kind, std::vector<std::string>* resources)
+{
+    resources->clear();
+    if (kind < 0 || kind >= kTransportKindCount)
+    {
+        return kTransportErrorNotFound;
+    }
+    sLogFileInit();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mDiscovered[kind])
+    {
+        TransportStatus status = Discover(kind);
+        if (status < kTransportOk)
+        {
+            return status;
+        }
+    }
+    for (size_t i = 0; i < mDevices[kind].size(); i++)
+    {
+        resources->push_back(mDevices[kind][i].resource);
+    }
+    return kTransportOk;
+}
+
+/* Open and identify a session to the instrument unless it has one. */
+TransportStatus ItechDcContext::OpenSession(TransportKind kind, Device& instrument, int number)
+{
+    if (instrument.session)
+    {
+        return kTransportOk;
+    }
+    instrument.session.reset(CreateTransport(kind));
+    if (!instrument.session)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, nullptr, "Could not create a transport for backend %d!", (int)kind);
+        return kTransportErrorNotFound;
+    }
+    TransportStatus status = instrument.session->Open(instrument.resource.c_str());
+    ITECH_LOG(LOG_LEVEL_INFO, instrument.resource.c_str(), "%s", instrument.resource.c_str());
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, instrument.resource.c_str(), "Cannot open a session to the device %d.", number);
+        instrument.session.reset();
+        mDiscovered[kind] = false; /* unplugged? find the instruments again next time */
+        return status;
+    }
+    status = sIdentify(instrument.session.get(), instrument.resource, number, &instrument.identity);
+    if (status < kTransportOk)
+    {
+        instrument.session->Close();
+        instrument.session.reset();
+    }
+    return status;
+}
+
+int ItechDcContext::Exchange(TransportKind kind, const char* command, char* resultString, double* result, int device,
+                             uint32_t timeoutMs, size_t resultSize)
+{
+    TransportStatus status;
+    TransportStatus lastError = kTransportOk;
+
+    if (kind < 0 || kind >= kTransportKindCount)
+    {
+        return kTransportErrorNotFound;
+    }
+    sLogFileInit();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mDiscovered[kind])
+    {
+        status = Discover(kind);
+        if (status < kTransportOk)
+        {
+            return status;
+        }
+    }
+
+    size_t first = 0;
+    size_t last = mDevices[kind].size();
+    if (device >= 0)
+    {
+        if ((size_t)device >= last)
+        {
+            return kTransportErrorNotFound;
+        }
+        first = (size_t)device;
+        last = first + 1;
+    }
+
+    for (size_t i = first; i < last; i++)
+    {
+        Device& instrument = mDevices[kind][i];
+        std::unique_lock<std::mutex> deviceLock;
+        sLockDevice(&deviceLock, instrument.resource);
+
+        status = OpenSession(kind, instrument, (int)i + 1);
+        if (status < kTransportOk)
+        {
+            lastError = status;
+            continue;
+        }
+
+        /* a backend without timeouts of its own keeps waiting as long as it always does */
+        uint32_t previousTimeout = 0;
+        bool timed = timeoutMs > 0 && instrument.session->SetTimeout(timeoutMs, &previousTimeout) >= kTransportOk;
+        status = sSend(instrument.session.get(), instrument.resource, (int)i + 1, command, resultString, resultSize,
+                       result);
+        if (status >= kTransportOk && timed)
+        {
+            instrument.session->SetTimeout(previousTimeout, &previousTimeout);
+        }
+        if (status < kTransportOk)
+        {
+            /* A late reply would be read by the next query, start over with a new session. */
+            instrument.session->Close();
+            instrument.session.reset();
+            instrument.identity.clear();
+            lastError = status;
+        }
+    }
+
+    return lastError;
+}
+
+/*
+ * A block is read from one instrument only, the bytes would be of no use
+ * mixed with those of another.
+ */
+int ItechDcContext::QueryBlock(TransportKind kind, const char* command, std::string* data, int device,
+                               uint32_t timeoutMs)
+{
+    data->clear();
+    if (kind < 0 || kind >= kTransportKindCount || device < 0)
+    {
+        return kTransportErrorNotFound;
+    }
+    sLogFileInit();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mDiscovered[kind])
+    {
+        TransportStatus status = Discover(kind);
+        if (status < kTransportOk)
+        {
+            return status;
+        }
+    }
+    if ((size_t)device >= mDevices[kind].size())
+    {
+        return kTransportErrorNotFound;
+    }
+
+    Device& instrument = mDevices[kind][device];
+    std::unique_lock<std::mutex> deviceLock;
+    sLockDevice(&deviceLock, instrument.resource);
+    TransportStatus status = OpenSession(kind, instrument, device + 1);
+    if (status < kTransportOk)
+    {
+        return status;
+    }
+
+    uint32_t previousTimeout = 0;
+    bool timed = timeoutMs > 0 && instrument.session->SetTimeout(timeoutMs, &previousTimeout) >= kTransportOk;
+    status = sWriteLine(instrument.session.get(), command);
+    if (status < kTransportOk)
+    {
+        ITECH_LOG(LOG_LEVEL_ERROR, instrument.resource.c_str(), "Error writing to the device %d.", device + 1);
+    }
+    else
+    {
+        status = sReadBlock(instrument.session.get(), instrument.resource, device + 1, data);
+    }
+    if (status >= kTransportOk && timed)
+    {
+        instrument.session->SetTimeout(previousTimeout, &previousTimeout);
+    }
+    if (status < kTransportOk)
+    {
+        /* the rest of the block would be read by the next query */
+        instrument.session->Close();
+        instrument.session.reset();
+        instrument.identity.clear();
+    }
+    return status;
+}
+
+/*
+ * The instrument answers "*OPC?" once everything before it on the session is
+ * done, so commands sent earlier from this context are complete when it
+ * returns. Instruments run in parallel, waiting for one after the other costs
+ * no more than waiting for the slowest.
+ */
+int ItechDcContext::WaitComplete(TransportKind kind, uint32_t timeoutMs, int device)
+{
+    std::vector<std::string> resources;
+    TransportStatus status = Resources(kind, &resources);
+    if (status < kTransportOk)
+    {
+        return status;
+    }
+
+    size_t first = 0;
+    size_t last = resources.size();
+    if (device >= 0)
+    {
+        if ((size_t)device >= last)
+        {
+            return kTransportErrorNotFound;
+        }
+        first = (size_t)device;
+        last = first + 1;
+    }
+
+    uint64_t deadline = ItechNowNs() + (uint64_t)timeoutMs * 1000000;
+    for (size_t i = first; i < last; i++)
+    {
+        uint64_t now = ItechNowNs();
+        if (now >= deadline)
+        {
+            return kTransportErrorTimeout;
+        }
+        uint32_t remainingMs = (uint32_t)((deadline - now + 999999) / 1000000);
+        char reply[ITECHDC_REPLY_SIZE];
+        double done = 0.0;
+        status = Exchange(kind, "*OPC?", reply, &done, (int)i, remainingMs);
+        if (status < kTransportOk)
+        {
+            return status;
+        }
+    }
+    return kTransportOk;
+}
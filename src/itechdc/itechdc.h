@@ -0,0 +1,118 @@
+/**
+ * @file itechdc.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief SCPI exchange with ITECH DC power supplies on top of a transport.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#ifndef ITECHDC_H
+#define ITECHDC_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "transport.h"
+
+/* Size of the reply buffer, replies are truncated to one byte less. */
+#define ITECHDC_REPLY_SIZE 100
+/* Largest binary block QueryBlock accepts, bytes. */
+#define ITECHDC_BLOCK_MAX  0x1000000
+
+/**
+ * @brief Send a SCPI command to every instrument of a backend.
+ *
+ * Each instrument is identified with "*IDN?" first, then the command is sent.
+ * If resultString is not nullptr the command is a query: the reply is copied
+ * to resultString (zero terminated) and its numeric value to result.
+ * Thread safe: each instrument is locked from open to close.
+ *
+ * @param kind Backend to use.
+ * @param command SCPI command string without termination.
+ * @param resultString Buffer for the reply or nullptr for a plain write.
+ * @param result Numeric value of the reply, may be nullptr.
+ * @return int Status of the last failed step, kTransportOk otherwise.
+ */
+int ItechDcPowerExchange(TransportKind kind, const char* command, char* resultString, double* result);
+
+/**
+ * @brief The instruments of one CAPL node.
+ *
+ * ItechDcPowerExchange finds and opens every instrument on each call. A
+ * context finds the instruments of a backend once, keeps a session to each
+ * of them open and asks for "*IDN?" once per session. A step that fails
+ * closes the session of that instrument, an instrument that cannot be opened
+ * makes the next call find the instruments again.
+ *
+ * A context belongs to one CAPL node. Its own mutex is only contended if
+ * the node calls from several threads at once, the per instrument locks are
+ * shared with all other callers.
+ */
+class ItechDcContext
+{
+public:
+    ItechDcContext();
+    ~ItechDcContext();
+
+    /*
+     * Same as ItechDcPowerExchange, on the sessions of this context. device
+     * is the index of one instrument in the order they were found, -1 all.
+     * timeoutMs, if not 0, replaces the read timeout of the backend for
+     * this command. The reply is cut to resultSize bytes with the
+     * terminator.
+     */
+    int Exchange(TransportKind kind, const char* command, char* resultString, double* result, int device = -1,
+                 uint32_t timeoutMs = 0, size_t resultSize = ITECHDC_REPLY_SIZE);
+
+    /*
+     * Send a query to one instrument and read its reply whole: the bytes of
+     * an IEEE 488.2 definite length block ("#<n><length><bytes>"), anything
+     * else as a line of text without the terminator. Returns kTransportOk or
+     * the status of the step that failed.
+     */
+    int QueryBlock(TransportKind kind, const char* command, std::string* data, int device, uint32_t timeoutMs = 0);
+
+    /*
+     * Wait until the instruments finished every command sent before, with
+     * "*OPC?" on their sessions, at most timeoutMs for all of them. Returns
+     * kTransportOk or the status of the first that failed, in particular
+     * kTransportErrorTimeout.
+     */
+    int WaitComplete(TransportKind kind, uint32_t timeoutMs, int device = -1);
+
+    /* The resources of a backend in device order, they are found first if need be. */
+    int Resources(TransportKind kind, std::vector<std::string>* resources);
+
+    /* Close all sessions and forget the instruments. */
+    void Release();
+
+    size_t OpenSessions() const;
+
+private:
+    ItechDcContext(const ItechDcContext&);
+    ItechDcContext& operator=(const ItechDcContext&);
+
+    /**
+     * @brief An instrument found by discovery.
+     */
+    struct Device
+    {
+        std::string                resource;
+        std::unique_ptr<Transport> session;  /* nullptr while closed    */
+        std::string                identity; /* reply to "*IDN?" if any */
+    };
+
+    TransportStatus Discover(TransportKind kind);
+    TransportStatus OpenSession(TransportKind kind, Device& instrument, int number);
+    void CloseSession(Device& device);
+
+    mutable std::mutex  mMutex;
+    std::vector<Device> mDevices[kTransportKindCount];
+    bool                mDiscovered[kTransportKindCount];
+};
+
+#endif
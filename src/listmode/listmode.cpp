@@ -0,0 +1,279 @@
+/**
+ * @file listmode.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Voltage profiles compiled to the LIST mode of the supply.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <stdio.h>
+#include <chrono>
+
+#include "listmode.h"
+#include "opstats.h"
+#include "transport.h"
+
+/* Shortest text that keeps 6 significant digits, "12" rather than "12.000000". */
+static void sAppend(std::string* text, const char* header, uint32_t step, double value)
+{
+    char command[64];
+    snprintf(command, sizeof(command), "%s %u,%.6g;", header, step, value);
+    *text += command;
+}
+
+int CompileListProfile(const double* values, uint32_t steps, ListProfile* profile)
+{
+    profile->upload.clear();
+    profile->seconds.clear();
+    profile->steps = 0;
+    if (values == nullptr || steps == 0 || steps > LIST_SLOTS * LIST_SLOT_STEPS)
+    {
+        return -1;
+    }
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        const double* step = values + 3 * i;
+        if (!(step[0] >= 0.0) || !(step[1] >= 0.0) || !(step[2] >= LIST_MIN_WIDTH) || !(step[2] <= LIST_MAX_WIDTH))
+        {
+            return -1; /* negated, so NaN fails too */
+        }
+    }
+
+    uint32_t slots = (steps + LIST_SLOT_STEPS - 1) / LIST_SLOT_STEPS;
+    for (uint32_t slot = 0; slot < slots; slot++)
+    {
+        uint32_t first = slot * LIST_SLOT_STEPS;
+        uint32_t count = steps - first < LIST_SLOT_STEPS ? steps - first : LIST_SLOT_STEPS;
+        char command[48];
+        snprintf(command, sizeof(command), "LIST:STEP %u;", count);
+        profile->upload += command;
+
+        double seconds = 0.0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const double* step = values + 3 * (first + i);
+            sAppend(&profile->upload, "LIST:VOLT", i + 1, step[0]);
+            sAppend(&profile->upload, "LIST:CURR", i + 1, step[1]);
+            sAppend(&profile->upload, "LIST:WID", i + 1, step[2]);
+            seconds += step[2];
+        }
+        snprintf(command, sizeof(command), "LIST:COUN 1;LIST:SAV %u", slot + 1);
+        profile->upload += command;
+        if (slot + 1 < slots)
+        {
+            profile->upload += ';';
+        }
+        profile->seconds.push_back(seconds);
+    }
+    profile->steps = steps;
+    return (int)slots;
+}
+
+ListRunner::ListRunner()
+    : mLoaded(false),
+      mLoadExchange(nullptr),
+      mLoadContext(nullptr),
+      mExchange(nullptr),
+      mQuery(nullptr),
+      mContext(nullptr),
+      mRunning(false),
+      mStopping(false),
+      mStarted(false),
+      mStatus(0),
+      mSlot(0)
+{
+}
+
+ListRunner::~ListRunner()
+{
+    std::lock_guard<std::mutex> control(mControlMutex);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    Join();
+}
+
+void ListRunner::Join()
+{
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+int ListRunner::Load(const double* values, uint32_t steps, ListExchange exchange, void* context)
+{
+    std::lock_guard<std::mutex> control(mControlMutex);
+    if (exchange == nullptr || IsRunning())
+    {
+        return -1;
+    }
+    ListProfile profile;
+    int slots = CompileListProfile(values, steps, &profile);
+    if (slots < 0)
+    {
+        return -1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLoaded = false;
+    }
+    int status = exchange(context, profile.upload.c_str(), nullptr);
+    if (status < 0)
+    {
+        return status;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mProfile = profile;
+    mLoadExchange = exchange;
+    mLoadContext = context;
+    mLoaded = true;
+    return slots;
+}
+
+uint32_t ListRunner::Slots() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLoaded ? (uint32_t)mProfile.seconds.size() : 0;
+}
+
+int ListRunner::Start(ListExchange query)
+{
+    std::lock_guard<std::mutex> control(mControlMutex);
+    if (query == nullptr || IsRunning())
+    {
+        return -1;
+    }
+    Join();
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mLoaded)
+    {
+        return -1;
+    }
+    mSeconds = mProfile.seconds;
+    mExchange = mLoadExchange;
+    mQuery = query;
+    mContext = mLoadContext;
+    mStopping = false;
+    mStarted = true;
+    mStatus = 0;
+    mSlot = 0;
+    mRunning.store(true, std::memory_order_release);
+    mThread = std::thread(&ListRunner::Run, this);
+    return 0;
+}
+
+int ListRunner::Abort()
+{
+    std::lock_guard<std::mutex> control(mControlMutex);
+    bool running;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+        running = IsRunning();
+    }
+    mWake.notify_all();
+    Join();
+    /* a list that ended holds its last step, "ABOR" would give that up */
+    if (!running)
+    {
+        return 0;
+    }
+    int status = mExchange(mContext, "ABOR", nullptr);
+    return status < 0 ? status : 0;
+}
+
+/* Returns false if aborted. */
+bool ListRunner::Sleep(uint64_t until)
+{
+    uint64_t now = ItechNowNs();
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (until > now)
+    {
+        mWake.wait_for(lock, std::chrono::nanoseconds(until - now), [this] { return mStopping; });
+    }
+    return !mStopping;
+}
+
+void ListRunner::Run()
+{
+    int status = 0;
+    for (size_t slot = 0; slot < mSeconds.size() && status >= 0; slot++)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mStopping)
+            {
+                status = kTransportErrorAbort;
+                break;
+            }
+            mSlot = (uint32_t)slot + 1;
+        }
+        char command[64];
+        snprintf(command, sizeof(command), "LIST:RCL %u;LIST:STAT ON;TRIG:SOUR BUS;*TRG", (unsigned)slot + 1);
+        uint64_t start = ItechNowNs();
+        status = mExchange(mContext, command, nullptr);
+        if (status < 0)
+        {
+            break;
+        }
+
+        /* sleep through the slot, then watch the running bit drop */
+        uint64_t end = start + (uint64_t)(mSeconds[slot] * 1e9);
+        if (!Sleep(end))
+        {
+            status = kTransportErrorAbort;
+            break;
+        }
+        for (;;)
+        {
+            double operation = 0.0;
+            status = mQuery(mContext, "STAT:OPER:COND?", &operation);
+            if (status < 0 || ((int)operation & LIST_OPER_RUNNING) == 0)
+            {
+                break;
+            }
+            if (ItechNowNs() > end + LIST_END_GRACE_NS)
+            {
+                status = kTransportErrorTimeout;
+                break;
+            }
+            if (!Sleep(ItechNowNs() + LIST_POLL_NS))
+            {
+                status = kTransportErrorAbort;
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStatus = status;
+    mSlot = 0;
+    mRunning.store(false, std::memory_order_release);
+    mEnded.notify_all();
+}
+
+int ListRunner::Wait(uint64_t timeoutNs)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (!mStarted)
+    {
+        return -1;
+    }
+    if (!mEnded.wait_for(lock, std::chrono::nanoseconds(timeoutNs),
+                         [this] { return !mRunning.load(std::memory_order_acquire); }))
+    {
+        return kTransportErrorTimeout;
+    }
+    return mStatus;
+}
+
+uint32_t ListRunner::Slot() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSlot;
+}
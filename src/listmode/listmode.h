@@ -0,0 +1,137 @@
+/**
+ * @file listmode.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Voltage profiles compiled to the LIST mode of the supply.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * An ITECH supply runs a list of (voltage, current, width) steps with its
+ * own timing, no round trip per step. CompileListProfile turns a profile
+ * into the list commands of the supply, "LIST:STEP", "LIST:VOLT",
+ * "LIST:CURR" and "LIST:WID", saved with "LIST:SAV" into as many slots of
+ * LIST_SLOT_STEPS steps as it needs; the whole upload is one program
+ * message. A ListRunner recalls and triggers the slots one after the other:
+ * while a slot runs it sleeps, near its end it polls the operation status
+ * until the running bit drops, then the next slot starts. Only the slot
+ * boundaries cost a round trip.
+ */
+#ifndef LISTMODE_H
+#define LISTMODE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Steps of one list and the lists the supply keeps (IT6800: 100 steps, 10 files). */
+#define LIST_SLOT_STEPS    100
+#define LIST_SLOTS         10
+/* Shortest and longest width of one step, s. */
+#define LIST_MIN_WIDTH     0.001
+#define LIST_MAX_WIDTH     3600.0
+/* Operation status bit of a running list (SCPI: program running). */
+#define LIST_OPER_RUNNING  0x4000
+/* Near the end of a slot the operation status is polled this often. */
+#define LIST_POLL_NS       1000000ULL
+/* A slot still running this long after its width is taken for a failure. */
+#define LIST_END_GRACE_NS  1000000000ULL
+
+/**
+ * @brief A profile as the commands of the supply.
+ */
+struct ListProfile
+{
+    std::string         upload;  /* every slot, one program message */
+    std::vector<double> seconds; /* run time of each slot */
+    uint32_t            steps;
+};
+
+/*
+ * Compile steps (voltage V, current A, width s) triples of values into
+ * slots 1, 2, ... Returns the number of slots, or -1 for no steps, more
+ * than LIST_SLOTS * LIST_SLOT_STEPS or a value out of range.
+ */
+int CompileListProfile(const double* values, uint32_t steps, ListProfile* profile);
+
+/**
+ * @brief Sends a command; value, if not nullptr, receives the reply of a query.
+ *        Returns a status < 0 if it failed.
+ */
+typedef int (*ListExchange)(void* context, const char* command, double* value);
+
+/**
+ * @brief Runs the slots of an uploaded profile one after the other.
+ */
+class ListRunner
+{
+public:
+    ListRunner();
+    ~ListRunner();
+
+    /*
+     * Compile the profile and upload it with exchange, which also runs it
+     * with context. Returns the number of slots, -1 for an invalid profile
+     * or if a profile runs, or the status of the upload.
+     */
+    int Load(const double* values, uint32_t steps, ListExchange exchange, void* context);
+    /* The loaded profile, nothing if the last upload failed. */
+    uint32_t Slots() const;
+
+    /*
+     * Run the loaded slots on a thread, through the exchange and context of
+     * the Load. query reads the operation status of the supplies (their bits
+     * or'ed). Returns 0, or -1 if nothing is loaded or a profile runs already.
+     */
+    int Start(ListExchange query);
+    /* Stop the thread and, if a slot runs, write "ABOR". Returns 0, or the status of the write. */
+    int Abort();
+    bool IsRunning() const { return mRunning.load(std::memory_order_acquire); }
+
+    /*
+     * Wait at most timeoutNs for the run to end. Returns 0 when every slot
+     * ran, the status of the exchange that failed, kTransportErrorAbort
+     * after Abort, kTransportErrorTimeout if it still runs, or -1 if it was
+     * not started.
+     */
+    int Wait(uint64_t timeoutNs);
+    /* The slot running (1 ..), 0 if none. */
+    uint32_t Slot() const;
+
+private:
+    ListRunner(const ListRunner&);
+    ListRunner& operator=(const ListRunner&);
+
+    void Run();
+    bool Sleep(uint64_t until);
+    void Join();
+
+    /* Load, Start, Abort and the destructor take turns, the thread does not take it. */
+    std::mutex              mControlMutex;
+
+    ListProfile             mProfile;
+    bool                    mLoaded;
+    ListExchange            mLoadExchange;
+    void*                   mLoadContext;
+    /* Copied from the Load at Start, only the thread reads them while it runs. */
+    std::vector<double>     mSeconds;
+    ListExchange            mExchange;
+    ListExchange            mQuery;
+    void*                   mContext;
+
+    mutable std::mutex      mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mEnded;
+    std::thread             mThread;
+    std::atomic<bool>       mRunning;
+    bool                    mStopping;
+    bool                    mStarted;
+    int                     mStatus;
+    uint32_t                mSlot;
+};
+
+#endif
@@ -0,0 +1,336 @@
+/**
+ * @file binlog.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Binary log with deferred formatting.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "binlog.h"
+#include "minilogger.h"
+
+/**
+ * @brief A mapped log file.
+ */
+struct BinLogFile
+{
+    std::string       path;
+    uint8_t*          memory;
+    size_t            size;
+    BinLogFileHeader* header;
+    uint8_t*          ring;
+#ifdef _WIN32
+    HANDLE            file;
+    HANDLE            mapping;
+#else
+    int               file;
+#endif
+};
+
+/**
+ * @brief A format string known to the dll.
+ */
+struct BinLogFormat
+{
+    int         level;
+    const char* message;
+};
+
+std::atomic<bool> gBinLogEnabled(false);
+
+static std::atomic<BinLogFile*>  gBinLogFile(nullptr);
+/* Stopped files, a late writer may still use them, unmapped at unload. */
+static std::vector<BinLogFile*>  gRetiredFiles;
+static std::vector<BinLogFormat> gFormats;
+static std::mutex                gBinLogMutex;
+
+static void sUnmap(BinLogFile* file);
+
+static struct BinLogCleanup
+{
+    ~BinLogCleanup()
+    {
+        gBinLogEnabled.store(false);
+        sUnmap(gBinLogFile.exchange(nullptr));
+        for (size_t i = 0; i < gRetiredFiles.size(); i++)
+        {
+            sUnmap(gRetiredFiles[i]);
+        }
+    }
+} sBinLogCleanup;
+
+uint64_t BinLogNow()
+{
+    return LogClockNs();
+}
+
+static BinLogFile* sMap(const char* path, size_t size)
+{
+    BinLogFile* file = new (std::nothrow) BinLogFile();
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+    file->path = path;
+    file->size = size;
+#ifdef _WIN32
+    file->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file->file == INVALID_HANDLE_VALUE)
+    {
+        delete file;
+        return nullptr;
+    }
+    file->mapping = CreateFileMappingA(file->file, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32),
+                                       (DWORD)size, nullptr);
+    file->memory = (file->mapping != nullptr)
+                       ? (uint8_t*)MapViewOfFile(file->mapping, FILE_MAP_ALL_ACCESS, 0, 0, size)
+                       : nullptr;
+    if (file->memory == nullptr)
+    {
+        if (file->mapping != nullptr)
+        {
+            CloseHandle(file->mapping);
+        }
+        CloseHandle(file->file);
+        delete file;
+        return nullptr;
+    }
+#else
+    file->file = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file->file < 0)
+    {
+        delete file;
+        return nullptr;
+    }
+    void* memory = MAP_FAILED;
+    if (ftruncate(file->file, (off_t)size) == 0)
+    {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file->file, 0);
+    }
+    if (memory == MAP_FAILED)
+    {
+        close(file->file);
+        delete file;
+        return nullptr;
+    }
+    file->memory = (uint8_t*)memory;
+#endif
+    /* A new file reads as zeros, so no record is valid yet. */
+    file->header = reinterpret_cast<BinLogFileHeader*>(file->memory);
+    file->ring = file->memory + BINLOG_HEADER_SIZE + BINLOG_FORMAT_AREA_SIZE;
+    return file;
+}
+
+static void sSync(BinLogFile* file)
+{
+#ifdef _WIN32
+    FlushViewOfFile(file->memory, file->size);
+    FlushFileBuffers(file->file);
+#else
+    msync(file->memory, file->size, MS_SYNC);
+#endif
+}
+
+static void sUnmap(BinLogFile* file)
+{
+    if (file == nullptr)
+    {
+        return;
+    }
+    sSync(file);
+#ifdef _WIN32
+    UnmapViewOfFile(file->memory);
+    CloseHandle(file->mapping);
+    CloseHandle(file->file);
+#else
+    munmap(file->memory, file->size);
+    close(file->file);
+#endif
+    delete file;
+}
+
+/* Append one format to the table of the file, caller holds gBinLogMutex. */
+static void sStoreFormat(BinLogFile* file, uint32_t id)
+{
+    const BinLogFormat& format = gFormats[id];
+    size_t length = strlen(format.message);
+    size_t size = (sizeof(BinLogFormatEntry) + length + 1 + 7) & ~(size_t)7;
+    uint32_t used = file->header->formatUsed.load(std::memory_order_relaxed);
+    if (size > 0xFFFF || used + size > BINLOG_FORMAT_AREA_SIZE)
+    {
+        return; /* the decoder shows the id instead */
+    }
+    uint8_t* memory = file->memory + BINLOG_HEADER_SIZE + used;
+    BinLogFormatEntry* entry = reinterpret_cast<BinLogFormatEntry*>(memory);
+    entry->size = (uint16_t)size;
+    entry->level = (uint8_t)format.level;
+    entry->id = id;
+    memcpy(memory + sizeof(BinLogFormatEntry), format.message, length + 1);
+    file->header->formatUsed.store(used + (uint32_t)size, std::memory_order_release);
+}
+
+uint32_t BinLogRegister(int level, const char* message)
+{
+    std::lock_guard<std::mutex> lock(gBinLogMutex);
+    if (gFormats.size() >= BINLOG_PADDING)
+    {
+        return BINLOG_PADDING; /* never written */
+    }
+    uint32_t id = (uint32_t)gFormats.size();
+    BinLogFormat format = {level, message};
+    gFormats.push_back(format);
+    BinLogFile* file = gBinLogFile.load(std::memory_order_relaxed);
+    if (file != nullptr)
+    {
+        sStoreFormat(file, id);
+    }
+    return id;
+}
+
+uint8_t* BinLogClaim(uint32_t size, uint64_t* position)
+{
+    BinLogFile* file = gBinLogFile.load(std::memory_order_acquire);
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+    BinLogFileHeader* header = file->header;
+    uint64_t ringSize = header->ringSize;
+    if (size > ringSize / 4)
+    {
+        return nullptr;
+    }
+
+    /* A record never wraps: the rest of the ring is skipped instead. */
+    uint64_t current = header->writePosition.load(std::memory_order_relaxed);
+    uint64_t skip;
+    do
+    {
+        uint64_t offset = current % ringSize;
+        skip = (offset + size > ringSize) ? ringSize - offset : 0;
+    } while (!header->writePosition.compare_exchange_weak(current, current + skip + size,
+                                                          std::memory_order_relaxed));
+
+    if (skip >= sizeof(BinLogRecord))
+    {
+        /* A shorter gap is skipped by the decoder without a record. */
+        BinLogRecord* padding = reinterpret_cast<BinLogRecord*>(file->ring + current % ringSize);
+        padding->size = (uint32_t)skip;
+        padding->format = BINLOG_PADDING;
+        padding->argCount = 0;
+        padding->sequence.store(current + 1, std::memory_order_release);
+    }
+    *position = current + skip;
+    return file->ring + *position % ringSize;
+}
+
+int BinLogStart(const char* path, uint64_t ringBytes)
+{
+    if (path == nullptr || path[0] == '\0')
+    {
+        return -1;
+    }
+    if (ringBytes == 0)
+    {
+        ringBytes = BINLOG_DEFAULT_RING;
+    }
+    ringBytes = (ringBytes + 7) & ~(uint64_t)7;
+    if (ringBytes < 4096)
+    {
+        ringBytes = 4096;
+    }
+
+    std::lock_guard<std::mutex> lock(gBinLogMutex);
+    size_t size = (size_t)(BINLOG_HEADER_SIZE + BINLOG_FORMAT_AREA_SIZE + ringBytes);
+
+    /*
+     * A file still mapped (Windows cannot open it again) is reused when
+     * the size fits, the lines of the last run are cleared.
+     */
+    BinLogFile* file = nullptr;
+    BinLogFile* current = gBinLogFile.load(std::memory_order_relaxed);
+    if (current != nullptr && current->path == path && current->size == size)
+    {
+        file = current;
+    }
+    for (size_t i = 0; file == nullptr && i < gRetiredFiles.size(); i++)
+    {
+        if (gRetiredFiles[i]->path == path && gRetiredFiles[i]->size == size)
+        {
+            file = gRetiredFiles[i];
+            gRetiredFiles.erase(gRetiredFiles.begin() + i);
+        }
+    }
+    if (file != nullptr)
+    {
+        gBinLogEnabled.store(false, std::memory_order_relaxed);
+        memset(file->memory, 0, file->size);
+    }
+    else
+    {
+        file = sMap(path, size);
+    }
+    if (file == nullptr)
+    {
+        return -1;
+    }
+
+    BinLogFileHeader* header = file->header;
+    memcpy(header->magic, BINLOG_MAGIC, sizeof(header->magic));
+    header->version = BINLOG_VERSION;
+    header->formatOffset = BINLOG_HEADER_SIZE;
+    header->formatAreaSize = BINLOG_FORMAT_AREA_SIZE;
+    header->formatUsed.store(0, std::memory_order_relaxed);
+    header->ringOffset = BINLOG_HEADER_SIZE + BINLOG_FORMAT_AREA_SIZE;
+    header->ringSize = ringBytes;
+    header->writePosition.store(0, std::memory_order_relaxed);
+    header->originSteadyNs = BinLogNow();
+    header->originWallNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::system_clock::now().time_since_epoch()).count();
+    for (uint32_t id = 0; id < gFormats.size(); id++)
+    {
+        sStoreFormat(file, id);
+    }
+
+    BinLogFile* previous = gBinLogFile.exchange(file, std::memory_order_acq_rel);
+    if (previous != nullptr && previous != file)
+    {
+        sSync(previous);
+        gRetiredFiles.push_back(previous);
+    }
+    gBinLogEnabled.store(true, std::memory_order_release);
+    return 0;
+}
+
+int BinLogStop()
+{
+    std::lock_guard<std::mutex> lock(gBinLogMutex);
+    gBinLogEnabled.store(false, std::memory_order_relaxed);
+    BinLogFile* file = gBinLogFile.exchange(nullptr, std::memory_order_acq_rel);
+    if (file == nullptr)
+    {
+        return 0;
+    }
+    sSync(file);
+    gRetiredFiles.push_back(file);
+    return 0;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file binlog.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Binary log with deferred formatting.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * While the binary log is on, a log line is stored as the id of its format
+ * string, a timestamp and the raw arguments in a ring inside a memory-mapped
+ * file. Nothing is formatted and no system call is made on the logging
+ * thread; when the ring is full the oldest lines are overwritten. The format
+ * strings are stored in the same file, tools/logdecode turns it into text.
+ *
+ * File layout: BinLogFileHeader, the format table (BinLogFormatEntry after
+ * BinLogFormatEntry) and the ring of BinLogRecord, each followed by its
+ * arguments. An argument is one type byte and its value: 'i' int64, 'u'
+ * uint64, 'd' double, 'p' pointer as uint64, 's' uint16 length and the bytes.
+ */
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+#define BINLOG_MAGIC            "CAPLBLOG"
+#define BINLOG_VERSION          1
+#define BINLOG_HEADER_SIZE      4096
+#define BINLOG_FORMAT_AREA_SIZE (64 * 1024)
+/* Ring size used when BinLogStart is given 0. */
+#define BINLOG_DEFAULT_RING     (16 * 1024 * 1024)
+/* Characters of a string argument that are kept. */
+#define BINLOG_MAX_STRING       128
+/* Format id of the record filling the end of the ring before it wraps. */
+#define BINLOG_PADDING          0xFFFF
+
+/**
+ * @brief Start of the file.
+ */
+struct BinLogFileHeader
+{
+    char                  magic[8];        /* BINLOG_MAGIC, no terminator  */
+    uint32_t              version;
+    uint32_t              formatOffset;    /* of the format table          */
+    uint32_t              formatAreaSize;
+    std::atomic<uint32_t> formatUsed;      /* bytes of the format table    */
+    uint64_t              ringOffset;
+    uint64_t              ringSize;        /* a multiple of 8              */
+    std::atomic<uint64_t> writePosition;   /* bytes claimed since start    */
+    uint64_t              originSteadyNs;  /* record clock at BinLogStart  */
+    uint64_t              originWallNs;    /* Unix time at originSteadyNs  */
+};
+
+/**
+ * @brief One format string of the format table, the text follows zero terminated.
+ */
+struct BinLogFormatEntry
+{
+    uint16_t size;  /* of the entry with the text, a multiple of 8 */
+    uint8_t  level;
+    uint8_t  reserved;
+    uint32_t id;
+};
+
+/**
+ * @brief Head of one log line in the ring, the arguments follow.
+ */
+struct BinLogRecord
+{
+    std::atomic<uint64_t> sequence;  /* ring position + 1, written last    */
+    uint32_t              size;      /* with the arguments, a multiple of 8 */
+    uint16_t              format;    /* id, or BINLOG_PADDING              */
+    uint8_t               level;
+    uint8_t               argCount;
+    uint64_t              timestamp; /* steady clock in ns                 */
+};
+
+extern std::atomic<bool> gBinLogEnabled;
+
+static inline bool BinLogIsEnabled()
+{
+    return gBinLogEnabled.load(std::memory_order_relaxed);
+}
+
+/*
+ * Log into a new ring file of ringBytes (0: BINLOG_DEFAULT_RING) at path,
+ * replacing the file. Text logging stops until BinLogStop. Returns 0 or -1
+ * if the file could not be created.
+ */
+int BinLogStart(const char* path, uint64_t ringBytes);
+
+/* Write the mapped file to disk and go back to text logging. */
+int BinLogStop();
+
+/*
+ * Id of a format string, assigned on first use. message must stay valid
+ * for the life of the dll (a string literal).
+ */
+uint32_t BinLogRegister(int level, const char* message);
+
+/* Reserve size bytes of the ring, nullptr while the binary log is off. */
+uint8_t* BinLogClaim(uint32_t size, uint64_t* position);
+
+/* Steady clock of the records, ns. */
+uint64_t BinLogNow();
+
+/* Characters kept of a string argument of type T, a char array may be shorter. */
+template <typename T>
+static inline uint16_t BinLogStringLength(const T& value)
+{
+    size_t bound = BINLOG_MAX_STRING;
+    if constexpr (std::is_array<T>::value)
+    {
+        bound = std::extent<T>::value < bound ? std::extent<T>::value : bound;
+    }
+    const char* text = value;
+    return text == nullptr ? 0 : (uint16_t)strnlen(text, bound);
+}
+
+template <typename T>
+static inline size_t BinLogArgSize(const T& value)
+{
+    if constexpr (std::is_convertible<T, const char*>::value)
+    {
+        return 1 + sizeof(uint16_t) + BinLogStringLength(value);
+    }
+    else
+    {
+        return 1 + sizeof(uint64_t);
+    }
+}
+
+template <typename T>
+static inline uint8_t* BinLogPut(uint8_t* out, const T& value)
+{
+    if constexpr (std::is_convertible<T, const char*>::value)
+    {
+        const char* text = value;
+        uint16_t length = BinLogStringLength(value);
+        *out++ = 's';
+        memcpy(out, &length, sizeof(length));
+        memcpy(out + sizeof(length), text, length);
+        return out + sizeof(length) + length;
+    }
+    else if constexpr (std::is_floating_point<T>::value)
+    {
+        double number = (double)value;
+        *out++ = 'd';
+        memcpy(out, &number, sizeof(number));
+        return out + sizeof(number);
+    }
+    else if constexpr (std::is_pointer<T>::value)
+    {
+        uint64_t address = (uint64_t)(uintptr_t)value;
+        *out++ = 'p';
+        memcpy(out, &address, sizeof(address));
+        return out + sizeof(address);
+    }
+    else if constexpr (std::is_unsigned<T>::value)
+    {
+        uint64_t number = (uint64_t)value;
+        *out++ = 'u';
+        memcpy(out, &number, sizeof(number));
+        return out + sizeof(number);
+    }
+    else
+    {
+        int64_t number = (int64_t)value;
+        *out++ = 'i';
+        memcpy(out, &number, sizeof(number));
+        return out + sizeof(number);
+    }
+}
+
+/* Store one line, message itself is not stored but known by its id format. */
+template <typename... Args>
+void BinLogWrite(uint32_t format, int level, const char* message, const Args&... args)
+{
+    (void)message;
+    size_t size = sizeof(BinLogRecord) + (BinLogArgSize(args) + ... + 0);
+    size = (size + 7) & ~(size_t)7;
+
+    uint64_t position;
+    uint8_t* memory = BinLogClaim((uint32_t)size, &position);
+    if (memory == nullptr)
+    {
+        return;
+    }
+    BinLogRecord* record = reinterpret_cast<BinLogRecord*>(memory);
+    record->size = (uint32_t)size;
+    record->format = (uint16_t)format;
+    record->level = (uint8_t)level;
+    record->argCount = (uint8_t)sizeof...(Args);
+    record->timestamp = BinLogNow();
+    uint8_t* out = memory + sizeof(BinLogRecord);
+    ((out = BinLogPut(out, args)), ...);
+    (void)out;
+    record->sequence.store(position + 1, std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file logqueue.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Bounded lock-free queue from many producers to one consumer.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * Producers claim a slot, fill it in place and publish it; the consumer
+ * takes published slots in order. Every slot carries a sequence number
+ * telling whether it is free, claimed or published (D. Vyukov's bounded
+ * queue), so neither side takes a lock.
+ */
+#ifndef LOGQUEUE_H
+#define LOGQUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define LOGQUEUE_CACHE_LINE 64
+
+template <typename T, size_t kCapacity>
+class LogQueue
+{
+    static_assert(kCapacity >= 2 && (kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    /**
+     * @brief One entry of the queue, filled in place by the producer.
+     */
+    struct Slot
+    {
+        T                   value;
+        std::atomic<size_t> sequence;
+        size_t              position;
+    };
+
+    LogQueue()
+        : mHead(0),
+          mTail(0)
+    {
+        for (size_t i = 0; i < kCapacity; i++)
+        {
+            mSlots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /* Claim a slot to fill, nullptr if the queue is full. Any thread. */
+    Slot* Claim()
+    {
+        size_t position = mTail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = mSlots[position & (kCapacity - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+            if (difference == 0)
+            {
+                if (mTail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.position = position;
+                    return &slot;
+                }
+            }
+            else if (difference < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                position = mTail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /* Hand a filled slot to the consumer. */
+    void Publish(Slot* slot)
+    {
+        slot->sequence.store(slot->position + 1, std::memory_order_release);
+    }
+
+    /* Consumer only: the oldest published entry, nullptr if there is none. */
+    T* Front()
+    {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        Slot& slot = mSlots[head & (kCapacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+        {
+            return nullptr;
+        }
+        return &slot.value;
+    }
+
+    /* Consumer only: release the entry returned by Front. */
+    void Pop()
+    {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        mSlots[head & (kCapacity - 1)].sequence.store(head + kCapacity, std::memory_order_release);
+        mHead.store(head + 1, std::memory_order_release);
+    }
+
+    /* Entries claimed and not popped yet, a snapshot. */
+    size_t Size() const
+    {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        size_t head = mHead.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+
+private:
+    LogQueue(const LogQueue&);
+    LogQueue& operator=(const LogQueue&);
+
+    alignas(LOGQUEUE_CACHE_LINE) std::atomic<size_t> mHead; /* consumer */
+    alignas(LOGQUEUE_CACHE_LINE) std::atomic<size_t> mTail; /* producers */
+    alignas(LOGQUEUE_CACHE_LINE) Slot mSlots[kCapacity];
+};
+
+#endif
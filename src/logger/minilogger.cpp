@@ -0,0 +1,525 @@
+/**
+ * @file minilogger.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Console logger and asynchronous file logger.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * FileLogger formats the line straight into a slot of a lock-free queue and
+ * returns. A writer thread keeps the log file open, writes whatever is
+ * queued, flushes once per batch and rotates the file by size. Lines are
+ * only lost if the queue is full; errors then wait for room instead.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "minilogger.h"
+#include "logqueue.h"
+
+#define LOG_LINE_SIZE            256
+#define LOG_QUEUE_SIZE           4096
+#define LOG_FLUSH_INTERVAL_MS    50
+#define LOG_DEFAULT_MAX_BYTES    (10L * 1024 * 1024)
+#define LOG_DEFAULT_KEEP_FILES   3
+
+/**
+ * @brief One formatted line.
+ */
+struct LogLine
+{
+    size_t length;
+    char   text[LOG_LINE_SIZE];
+};
+
+/**
+ * @brief The writer thread and everything it shares with the logging threads.
+ */
+class AsyncFileWriter
+{
+public:
+    AsyncFileWriter();
+
+    void SetFileName(const char* name);
+    void SetRotation(long maxBytes, int keepFiles);
+    void Write(const char* tag, const char* message, va_list args);
+    void Flush();
+    void Shutdown();
+    /* Process exit: write what is queued, but never wait for the thread to end. */
+    void Exit();
+
+private:
+    void Start();
+    void Run();
+    bool Drain();
+    void OpenFile();
+    void CloseFile();
+    void Rotate();
+
+    LogQueue<LogLine, LOG_QUEUE_SIZE> mQueue;
+
+    std::mutex              mMutex;
+    std::condition_variable mWake;    /* writer: lines or a request are waiting */
+    std::condition_variable mFlushed; /* loggers: the writer made progress */
+    std::thread             mThread;
+    std::atomic<bool>       mRunning;
+    bool                    mStop;
+    bool                    mStopped;
+    bool                    mFlushRequested;
+
+    std::string             mFileName;   /* requested by FileLoggerInit */
+    std::string             mOpenName;   /* of the open file            */
+    long                    mMaxBytes;
+    int                     mKeepFiles;
+
+    /* Writer thread only */
+    FILE*                   mFile;
+    long                    mFileSize;
+    uint64_t                mReportedDrops;
+
+    std::atomic<uint64_t>   mQueued;
+    std::atomic<uint64_t>   mWritten;
+    std::atomic<uint64_t>   mDropped;
+};
+
+std::atomic<int> gFileLogLevel(LOG_DEFAULT_LEVEL);
+
+/* Tags of the levels in the log file. */
+static const char* const sLevelTags[LOG_LEVEL_OFF] = {"T", "D", "I", "W", "E", "F"};
+
+static std::atomic<LogTimeSource> gLogTimeSource(nullptr);
+static std::atomic<LogSink>       gLogSink(nullptr);
+std::atomic<int>                  gLogSinkLevel(LOG_LEVEL_OFF);
+
+uint64_t LogClockNs(void)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Write the head of a line, "2026-10-18 07:48:19.123456789 [I]: ", and the
+ * measurement time if there is a time source. The clock is the monotonic one,
+ * anchored to the wall clock at load; the date text is only rebuilt when the
+ * second changes. Returns the length like snprintf.
+ */
+static int sFormatHead(char* text, size_t size, const char* tag)
+{
+    struct Origin
+    {
+        uint64_t steady;
+        uint64_t wall;
+    };
+    struct DateCache
+    {
+        time_t second;
+        char   date[24];
+    };
+    static const Origin origin = {LogClockNs(),
+                                  (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::system_clock::now().time_since_epoch()).count()};
+    static thread_local DateCache cache = {(time_t)-1, ""};
+
+    uint64_t wall = origin.wall + (LogClockNs() - origin.steady);
+    time_t second = (time_t)(wall / 1000000000ULL);
+    if (second != cache.second)
+    {
+        struct tm local;
+#ifdef _WIN32
+        localtime_s(&local, &second);
+#else
+        localtime_r(&second, &local);
+#endif
+        strftime(cache.date, sizeof(cache.date), "%Y-%m-%d %H:%M:%S", &local);
+        cache.second = second;
+    }
+    unsigned nanoseconds = (unsigned)(wall % 1000000000ULL);
+
+    LogTimeSource source = gLogTimeSource.load(std::memory_order_acquire);
+    int64_t measurement = (source != nullptr) ? source() : -1;
+    if (measurement >= 0)
+    {
+        return snprintf(text, size, "%s.%09u [%s] [%lld.%09lld]: ", cache.date, nanoseconds, tag,
+                        (long long)(measurement / 1000000000LL), (long long)(measurement % 1000000000LL));
+    }
+    return snprintf(text, size, "%s.%09u [%s]: ", cache.date, nanoseconds, tag);
+}
+
+/* Never deleted: a writer thread left running at process exit may still use it. */
+static AsyncFileWriter* sWriter = new AsyncFileWriter();
+
+static struct LoggerExit
+{
+    ~LoggerExit()
+    {
+        sWriter->Exit();
+    }
+} sLoggerExit;
+
+AsyncFileWriter::AsyncFileWriter()
+    : mRunning(false),
+      mStop(false),
+      mStopped(false),
+      mFlushRequested(false),
+      mMaxBytes(LOG_DEFAULT_MAX_BYTES),
+      mKeepFiles(LOG_DEFAULT_KEEP_FILES),
+      mFile(nullptr),
+      mFileSize(0),
+      mReportedDrops(0),
+      mQueued(0),
+      mWritten(0),
+      mDropped(0)
+{
+}
+
+void AsyncFileWriter::SetFileName(const char* name)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (name != nullptr && mFileName != name)
+    {
+        mFileName = name;
+    }
+}
+
+void AsyncFileWriter::SetRotation(long maxBytes, int keepFiles)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMaxBytes = maxBytes;
+    mKeepFiles = keepFiles < 0 ? 0 : keepFiles;
+}
+
+void AsyncFileWriter::Start()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mRunning.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    mStop = false;
+    mStopped = false;
+    mThread = std::thread(&AsyncFileWriter::Run, this);
+    mRunning.store(true, std::memory_order_release);
+}
+
+void AsyncFileWriter::Write(const char* tag, const char* message, va_list args)
+{
+    if (!mRunning.load(std::memory_order_acquire))
+    {
+        Start();
+    }
+
+    /* Errors must not get lost, everything else is dropped if the writer cannot keep up. */
+    bool mustKeep = (tag[0] == 'E' || tag[0] == 'F');
+    LogQueue<LogLine, LOG_QUEUE_SIZE>::Slot* slot;
+    while ((slot = mQueue.Claim()) == nullptr)
+    {
+        if (!mustKeep)
+        {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        mWake.notify_one();
+        std::this_thread::yield();
+    }
+
+    LogLine& line = slot->value;
+    int length = sFormatHead(line.text, LOG_LINE_SIZE, tag);
+    if (length >= 0 && length < LOG_LINE_SIZE - 1)
+    {
+        int messageLength = vsnprintf(line.text + length, LOG_LINE_SIZE - 1 - length, message, args);
+        length += (messageLength < 0) ? 0 : messageLength;
+    }
+    if (length < 0 || length > LOG_LINE_SIZE - 2)
+    {
+        length = LOG_LINE_SIZE - 2; /* truncated */
+    }
+    line.text[length++] = '\n';
+    line.length = (size_t)length;
+
+    mQueue.Publish(slot);
+    mQueued.fetch_add(1, std::memory_order_release);
+
+    /* The writer wakes up by itself every flush interval, only hurry it when filling up. */
+    if (mustKeep || mQueue.Size() >= LOG_QUEUE_SIZE / 2)
+    {
+        mWake.notify_one();
+    }
+}
+
+void AsyncFileWriter::Flush()
+{
+    if (!mRunning.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    uint64_t target = mQueued.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mMutex);
+    mFlushRequested = true;
+    mWake.notify_one();
+    mFlushed.wait(lock, [&] { return mWritten.load(std::memory_order_acquire) >= target || mStopped; });
+}
+
+void AsyncFileWriter::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mRunning.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        mStop = true;
+    }
+    mWake.notify_one();
+    mThread.join();
+    mRunning.store(false, std::memory_order_release);
+}
+
+void AsyncFileWriter::Exit()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (!mRunning.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    mStop = true;
+    mWake.notify_one();
+    /*
+     * The writer sets mStopped once the file is closed. It may not be able to
+     * end while the dll is being unloaded, so it is waited for but not joined.
+     */
+    mFlushed.wait_for(lock, std::chrono::seconds(1), [&] { return mStopped; });
+    lock.unlock();
+    mThread.detach();
+}
+
+void AsyncFileWriter::Run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;)
+    {
+        mWake.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS),
+                       [&] { return mStop || mFlushRequested || mQueue.Size() >= LOG_QUEUE_SIZE / 2; });
+        bool stop = mStop;
+        mFlushRequested = false;
+        if (mOpenName != mFileName)
+        {
+            CloseFile();
+        }
+        lock.unlock();
+
+        if (Drain() && mFile != nullptr)
+        {
+            fflush(mFile);
+        }
+
+        lock.lock();
+        mFlushed.notify_all();
+        if (stop)
+        {
+            break;
+        }
+    }
+    CloseFile();
+    mStopped = true;
+    mFlushed.notify_all();
+}
+
+/* Write all queued lines. Returns true if anything was written. */
+bool AsyncFileWriter::Drain()
+{
+    bool wrote = false;
+    LogLine* line;
+
+    uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+    if (dropped != mReportedDrops)
+    {
+        OpenFile();
+        if (mFile != nullptr)
+        {
+            mFileSize += fprintf(mFile, "[W]: %llu log lines dropped, the writer could not keep up\n",
+                                 (unsigned long long)(dropped - mReportedDrops));
+            wrote = true;
+        }
+        mReportedDrops = dropped;
+    }
+
+    while ((line = mQueue.Front()) != nullptr)
+    {
+        OpenFile();
+        if (mFile != nullptr)
+        {
+            fwrite(line->text, 1, line->length, mFile);
+            mFileSize += (long)line->length;
+            wrote = true;
+        }
+        mQueue.Pop();
+        mWritten.fetch_add(1, std::memory_order_release);
+
+        if (mFile != nullptr && mMaxBytes > 0 && mFileSize >= mMaxBytes)
+        {
+            Rotate();
+        }
+    }
+    return wrote;
+}
+
+void AsyncFileWriter::OpenFile()
+{
+    if (mFile != nullptr)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mOpenName = mFileName;
+    }
+    if (mOpenName.empty())
+    {
+        return; /* FileLoggerInit was not called, lines are discarded */
+    }
+    mFile = fopen(mOpenName.c_str(), "a");
+    if (mFile != nullptr)
+    {
+        /* Batches are flushed explicitly, a large buffer keeps write calls few. */
+        setvbuf(mFile, nullptr, _IOFBF, 64 * 1024);
+        fseek(mFile, 0, SEEK_END);
+        mFileSize = ftell(mFile);
+    }
+}
+
+void AsyncFileWriter::CloseFile()
+{
+    if (mFile != nullptr)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+    mOpenName.clear();
+}
+
+void AsyncFileWriter::Rotate()
+{
+    std::string name = mOpenName;
+    int keepFiles;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        keepFiles = mKeepFiles;
+    }
+    CloseFile();
+
+    /* capldlllog -> capldlllog.1 -> capldlllog.2 ... the oldest is removed. */
+    if (keepFiles == 0)
+    {
+        remove(name.c_str());
+    }
+    else
+    {
+        remove((name + "." + std::to_string(keepFiles)).c_str());
+        for (int i = keepFiles - 1; i >= 1; i--)
+        {
+            rename((name + "." + std::to_string(i)).c_str(), (name + "." + std::to_string(i + 1)).c_str());
+        }
+        rename(name.c_str(), (name + ".1").c_str());
+    }
+    OpenFile();
+}
+
+void FileLoggerInit(const char *fileName)
+{
+    sWriter->SetFileName(fileName);
+}
+
+void Logger(const char* tag, const char* message,...) {
+   char head[LOG_LINE_SIZE];
+   sFormatHead(head, sizeof(head), tag);
+   va_list args;
+   va_start(args,message);
+   printf("%s", head);
+   vprintf(message,args);
+   printf("\n");
+   va_end(args);
+}
+
+void FileLogger(const char* tag, const char* message,...) {
+   va_list args;
+   va_start(args,message);
+   sWriter->Write(tag, message, args);
+   va_end(args);
+}
+
+void FileLoggerWrite(int level, const char* message,...) {
+   if (level < LOG_LEVEL_TRACE || level >= LOG_LEVEL_OFF) {
+      return;
+   }
+   va_list args;
+   va_start(args,message);
+   sWriter->Write(sLevelTags[level], message, args);
+   va_end(args);
+}
+
+int FileLoggerSetLevel(int level)
+{
+    if (level < LOG_LEVEL_TRACE)
+    {
+        level = LOG_LEVEL_TRACE;
+    }
+    if (level > LOG_LEVEL_OFF)
+    {
+        level = LOG_LEVEL_OFF;
+    }
+    return gFileLogLevel.exchange(level, std::memory_order_relaxed);
+}
+
+void FileLoggerSetSink(LogSink sink, int level)
+{
+    if (sink == nullptr)
+    {
+        level = LOG_LEVEL_OFF;
+    }
+    gLogSinkLevel.store(LOG_LEVEL_OFF, std::memory_order_relaxed);
+    gLogSink.store(sink, std::memory_order_release);
+    gLogSinkLevel.store(level, std::memory_order_release);
+}
+
+void FileLoggerSinkWrite(int level, const char* message,...)
+{
+    LogSink sink = gLogSink.load(std::memory_order_acquire);
+    if (sink == nullptr)
+    {
+        return;
+    }
+    char text[LOG_LINE_SIZE];
+    va_list args;
+    va_start(args, message);
+    vsnprintf(text, sizeof(text), message, args);
+    va_end(args);
+    sink(level, text);
+}
+
+void FileLoggerSetTimeSource(LogTimeSource source)
+{
+    gLogTimeSource.store(source, std::memory_order_release);
+}
+
+void FileLoggerFlush(void)
+{
+    sWriter->Flush();
+}
+
+void FileLoggerShutdown(void)
+{
+    sWriter->Shutdown();
+}
+
+void FileLoggerSetRotation(long maxBytes, int keepFiles)
+{
+    sWriter->SetRotation(maxBytes, keepFiles);
+}
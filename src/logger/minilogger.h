@@ -2,14 +2,80 @@
 #define MYLOG_H
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <time.h>
 
-#define LOG_INFO(...) FileLogger("I",__VA_ARGS__)
-#define LOG_DEBUG(...) FileLogger("D",__VA_ARGS__)
-#define LOG_ERROR(...) FileLogger("E",__VA_ARGS__)
-#define LOG_TRACE(...) FileLogger("T",__VA_ARGS__)
-#define LOG_WARN(...) FileLogger("W",__VA_ARGS__)
-#define LOG_FATAL(...) FileLogger("F",__VA_ARGS__)
+#ifdef __cplusplus
+#include <atomic>
+
+#include "binlog.h"
+#endif
+
+/* Severity of a log line, a line is written if its level is at least the minimum. */
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_FATAL 5
+#define LOG_LEVEL_OFF   6
+
+/*
+ * Lines below LOG_COMPILE_LEVEL are removed by the compiler, e.g.
+ * -DLOG_COMPILE_LEVEL=LOG_LEVEL_WARN for a build without info lines.
+ */
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_TRACE
+#endif
+
+/* Level used until FileLoggerSetLevel is called. */
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_INFO
+
+/*
+ * True if lines of level are written. The arguments of a disabled line are
+ * not evaluated and nothing is formatted.
+ */
+#define LOG_ENABLED(level) \
+    ((level) >= LOG_COMPILE_LEVEL && ((level) >= FileLoggerLevel() || (level) >= FileLoggerSinkLevel()))
+
+/*
+ * Write one line of level to the binary log if it is on, else to the text
+ * file, and to the sink if level is high enough. message must be a string
+ * literal, the binary log keeps its address.
+ */
+#define LOG_WRITE(level, message, ...) \
+    do \
+    { \
+        if ((level) >= FileLoggerLevel() && BinLogIsEnabled()) \
+        { \
+            static const uint32_t binLogFormat = BinLogRegister(level, message); \
+            BinLogWrite(binLogFormat, level, message, ##__VA_ARGS__); \
+        } \
+        else if ((level) >= FileLoggerLevel()) \
+        { \
+            FileLoggerWrite(level, message, ##__VA_ARGS__); \
+        } \
+        if ((level) >= FileLoggerSinkLevel()) \
+        { \
+            FileLoggerSinkWrite(level, message, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_AT(level, ...) \
+    do \
+    { \
+        if (LOG_ENABLED(level)) \
+        { \
+            LOG_WRITE(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO,__VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG,__VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR,__VA_ARGS__)
+#define LOG_TRACE(...) LOG_AT(LOG_LEVEL_TRACE,__VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN,__VA_ARGS__)
+#define LOG_FATAL(...) LOG_AT(LOG_LEVEL_FATAL,__VA_ARGS__)
 
 #define log_info(...) Logger("I",__VA_ARGS__)
 #define log_debug(...) Logger("D",__VA_ARGS__)
@@ -24,7 +90,42 @@ extern "C" {
 void FileLoggerInit(const char *fileName);
 void Logger(const char* tag, const char* messages,...);
 void FileLogger(const char* tag, const char* message,...);
+/* FileLogger with the tag of level, used by the LOG_ macros. */
+void FileLoggerWrite(int level, const char* message,...);
+/* Set the minimum level of the lines written to the file, returns the previous one. */
+int FileLoggerSetLevel(int level);
+/* Measurement time in ns for the log lines, negative if there is none. */
+typedef int64_t (*LogTimeSource)(void);
+/* Add the time of source to every line, nullptr removes it. */
+void FileLoggerSetTimeSource(LogTimeSource source);
+/* Receives the message of the lines of at least the sink level, without time and tag. */
+typedef void (*LogSink)(int level, const char* text);
+/* Pass lines of at least level to sink, nullptr or LOG_LEVEL_OFF removes it. */
+void FileLoggerSetSink(LogSink sink, int level);
+/* Format a line for the sink, used by the LOG_ macros. */
+void FileLoggerSinkWrite(int level, const char* message,...);
+/* Monotonic clock of the log lines in ns. */
+uint64_t LogClockNs(void);
+/* Block until every line logged so far is written to the file. */
+void FileLoggerFlush(void);
+/* Flush, stop the writer thread and close the file. Logging restarts it. */
+void FileLoggerShutdown(void);
+/* Start a new file when the current one exceeds maxBytes, keeping keepFiles old ones. */
+void FileLoggerSetRotation(long maxBytes, int keepFiles);
 #ifdef __cplusplus
 }
+
+extern std::atomic<int> gFileLogLevel;
+extern std::atomic<int> gLogSinkLevel;
+
+static inline int FileLoggerLevel()
+{
+    return gFileLogLevel.load(std::memory_order_relaxed);
+}
+
+static inline int FileLoggerSinkLevel()
+{
+    return gLogSinkLevel.load(std::memory_order_relaxed);
+}
 #endif
 #endif
\ No newline at end of file
@@ -0,0 +1,180 @@
+/**
+ * @file ratelimit.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Rate limit and merge repeated log lines for a slow sink.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "ratelimit.h"
+
+static uint32_t sHash(const char* text)
+{
+    uint32_t hash = 2166136261u;
+    for (; *text != '\0'; text++)
+    {
+        hash = (hash ^ (uint8_t)*text) * 16777619u;
+    }
+    return hash;
+}
+
+LogRateLimiter::LogRateLimiter(double ratePerSecond, double burst, uint64_t mergeWindowNs, LogLimitOutput output,
+                               void* context)
+    : mOutput(output),
+      mContext(context),
+      mRate(ratePerSecond / 1e9),
+      mBurst(burst),
+      mTokens(burst),
+      mLastRefill(0),
+      mWindow(mergeWindowNs),
+      mPendingSuppressed(0),
+      mSuppressed(0)
+{
+    for (int i = 0; i < RATELIMIT_ENTRIES; i++)
+    {
+        mEntries[i].hash = 0;
+        mEntries[i].start = 0;
+        mEntries[i].repeats = 0;
+    }
+}
+
+void LogRateLimiter::Refill(uint64_t now)
+{
+    if (mLastRefill != 0 && now > mLastRefill)
+    {
+        mTokens += (double)(now - mLastRefill) * mRate;
+        if (mTokens > mBurst)
+        {
+            mTokens = mBurst;
+        }
+    }
+    mLastRefill = now;
+}
+
+bool LogRateLimiter::TakeToken()
+{
+    if (mTokens < 1.0)
+    {
+        return false;
+    }
+    mTokens -= 1.0;
+    return true;
+}
+
+/* Summaries are not rate limited, there is at most one per line and window. */
+void LogRateLimiter::WriteRepeats(const Entry& entry, uint64_t now)
+{
+    char summary[320];
+    snprintf(summary, sizeof(summary), "%s (repeated %llu time%s in %.1f s)", entry.text.c_str(),
+             (unsigned long long)entry.repeats, entry.repeats == 1 ? "" : "s", (double)(now - entry.start) / 1e9);
+    mOutput(mContext, summary);
+}
+
+void LogRateLimiter::WriteSuppressed()
+{
+    char summary[96];
+    snprintf(summary, sizeof(summary), "%llu log lines suppressed, too many in a short time",
+             (unsigned long long)mPendingSuppressed);
+    mOutput(mContext, summary);
+    mPendingSuppressed = 0;
+}
+
+/* Write the summary of every entry whose window ended (all: of every entry). */
+void LogRateLimiter::Expire(uint64_t now, bool all)
+{
+    for (int i = 0; i < RATELIMIT_ENTRIES; i++)
+    {
+        Entry& entry = mEntries[i];
+        if (entry.start == 0 || (!all && now - entry.start < mWindow))
+        {
+            continue;
+        }
+        if (entry.repeats > 0)
+        {
+            WriteRepeats(entry, now);
+        }
+        entry.start = 0;
+        entry.repeats = 0;
+    }
+}
+
+void LogRateLimiter::Submit(const char* text, uint64_t now)
+{
+    if (now == 0)
+    {
+        now = 1; /* 0 marks a free entry */
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    Refill(now);
+    Expire(now, false);
+
+    uint32_t hash = sHash(text);
+    Entry* unused = nullptr;
+    Entry* oldest = nullptr;
+    for (int i = 0; i < RATELIMIT_ENTRIES; i++)
+    {
+        Entry& entry = mEntries[i];
+        if (entry.start == 0)
+        {
+            unused = (unused == nullptr) ? &entry : unused;
+            continue;
+        }
+        if (entry.hash == hash && entry.text == text)
+        {
+            entry.repeats++;
+            return;
+        }
+        if (oldest == nullptr || entry.start < oldest->start)
+        {
+            oldest = &entry;
+        }
+    }
+
+    if (mPendingSuppressed > 0 && TakeToken())
+    {
+        WriteSuppressed();
+    }
+    if (!TakeToken())
+    {
+        mPendingSuppressed++;
+        mSuppressed++;
+        return;
+    }
+    mOutput(mContext, text);
+
+    /* Remember the line, all entries busy: end the window of the oldest early. */
+    Entry* entry = unused;
+    if (entry == nullptr)
+    {
+        entry = oldest;
+        if (entry->repeats > 0)
+        {
+            WriteRepeats(*entry, now);
+        }
+    }
+    entry->text = text;
+    entry->hash = hash;
+    entry->start = now;
+    entry->repeats = 0;
+}
+
+void LogRateLimiter::Flush(uint64_t now)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Expire(now, true);
+    if (mPendingSuppressed > 0)
+    {
+        WriteSuppressed();
+    }
+}
+
+uint64_t LogRateLimiter::Suppressed() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSuppressed;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file ratelimit.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Rate limit and merge repeated log lines for a slow sink.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * A line equal to one written within the merge window is only counted; when
+ * the window ends, one summary line tells how often it was repeated. All
+ * other lines take a token from a bucket refilled at a fixed rate, lines
+ * finding it empty are counted and reported once tokens are back. A device
+ * that fails on every call thus costs a few lines per window instead of one
+ * line per call.
+ */
+#ifndef RATELIMIT_H
+#define RATELIMIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <string>
+
+/* Distinct lines whose repeats are merged at the same time. */
+#define RATELIMIT_ENTRIES 16
+
+/* Receives the lines that pass. */
+typedef void (*LogLimitOutput)(void* context, const char* text);
+
+/**
+ * @brief Token bucket with merging of repeated lines.
+ */
+class LogRateLimiter
+{
+public:
+    /*
+     * ratePerSecond lines on average, up to burst at once, repeats merged for
+     * mergeWindowNs. Lines are passed to output, with the mutex of the
+     * limiter held.
+     */
+    LogRateLimiter(double ratePerSecond, double burst, uint64_t mergeWindowNs, LogLimitOutput output,
+                   void* context);
+
+    /* Write text now, count it as a repeat or count it as suppressed. */
+    void Submit(const char* text, uint64_t now);
+
+    /* Write the summaries of all lines still counting, e.g. at measurement stop. */
+    void Flush(uint64_t now);
+
+    /* Lines suppressed by the rate, repeats not counted. */
+    uint64_t Suppressed() const;
+
+private:
+    LogRateLimiter(const LogRateLimiter&);
+    LogRateLimiter& operator=(const LogRateLimiter&);
+
+    /**
+     * @brief A line written recently.
+     */
+    struct Entry
+    {
+        std::string text;
+        uint32_t    hash;
+        uint64_t    start;   /* when it was written, 0: free */
+        uint64_t    repeats; /* since then                   */
+    };
+
+    void Refill(uint64_t now);
+    bool TakeToken();
+    void Expire(uint64_t now, bool all);
+    void WriteRepeats(const Entry& entry, uint64_t now);
+    void WriteSuppressed();
+
+    mutable std::mutex mMutex;
+    LogLimitOutput     mOutput;
+    void*              mContext;
+    double             mRate;   /* tokens per ns */
+    double             mBurst;
+    double             mTokens;
+    uint64_t           mLastRefill;
+    uint64_t           mWindow;
+    uint64_t           mPendingSuppressed; /* not reported yet */
+    uint64_t           mSuppressed;
+    Entry              mEntries[RATELIMIT_ENTRIES];
+};
+
+#endif
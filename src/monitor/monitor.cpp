@@ -0,0 +1,258 @@
+/**
+ * @file monitor.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Threshold and event rules evaluated on a measurement thread.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <math.h>
+#include <chrono>
+#include <utility>
+
+#include "monitor.h"
+#include "opstats.h"
+
+RuleMonitor::RuleMonitor()
+    : mSource(nullptr),
+      mContext(nullptr),
+      mPeriod(0),
+      mRunning(false),
+      mStopping(false),
+      mNextId(1),
+      mDropped(0)
+{
+}
+
+RuleMonitor::~RuleMonitor()
+{
+    Stop();
+}
+
+int RuleMonitor::Add(int device, const char* command, RuleKind kind, double level, double hysteresis)
+{
+    if (command == nullptr || command[0] == '\0' || device < 0 || kind < 0 || kind >= kRuleKindCount
+        || hysteresis < 0.0 || (kind == kRuleRate && level <= 0.0))
+    {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mRules.size() >= MONITOR_MAX_RULES)
+    {
+        return -1;
+    }
+    Rule rule;
+    rule.id = mNextId++;
+    rule.device = device;
+    rule.command = command;
+    rule.kind = kind;
+    rule.level = level;
+    rule.hysteresis = hysteresis;
+    rule.armed = true;
+    rule.primed = false;
+    rule.previous = 0.0;
+    rule.previousTime = 0;
+    mRules.push_back(rule);
+    return rule.id;
+}
+
+int RuleMonitor::Remove(int rule)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < mRules.size(); i++)
+    {
+        if (mRules[i].id == rule)
+        {
+            mRules.erase(mRules.begin() + i);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void RuleMonitor::Clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRules.clear();
+    mEvents.clear();
+}
+
+int RuleMonitor::Start(MonitorSource source, void* context, uint64_t periodNs)
+{
+    if (source == nullptr || IsRunning())
+    {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSource = source;
+    mContext = context;
+    mPeriod = periodNs;
+    mStopping = false;
+    mRunning.store(true, std::memory_order_release);
+    mThread = std::thread(&RuleMonitor::Run, this);
+    return 0;
+}
+
+void RuleMonitor::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    mRunning.store(false, std::memory_order_release);
+}
+
+/* Returns true and fills event if rule triggers on value. */
+bool RuleMonitor::Check(Rule& rule, double value, uint64_t time, RuleEvent* event)
+{
+    bool primed = rule.primed;
+    double previous = rule.previous;
+    uint64_t previousTime = rule.previousTime;
+    rule.primed = true;
+    rule.previous = value;
+    rule.previousTime = time;
+
+    double observed = value;
+    bool beyond = false;
+    bool back = false;
+    switch (rule.kind)
+    {
+    case kRuleAbove:
+        beyond = value > rule.level;
+        back = value <= rule.level - rule.hysteresis;
+        break;
+    case kRuleBelow:
+        beyond = value < rule.level;
+        back = value >= rule.level + rule.hysteresis;
+        break;
+    case kRuleRate:
+        if (!primed || time <= previousTime)
+        {
+            return false;
+        }
+        observed = (value - previous) * 1e9 / (double)(time - previousTime);
+        beyond = fabs(observed) >= rule.level;
+        back = fabs(observed) <= rule.level - rule.hysteresis;
+        break;
+    case kRuleChange:
+    {
+        /* no hysteresis, every change of state is an event */
+        uint64_t mask = rule.level != 0.0 ? (uint64_t)llround(rule.level) : ~(uint64_t)0;
+        observed = (double)((uint64_t)llround(value) & mask);
+        previous = (double)((uint64_t)llround(previous) & mask);
+        beyond = primed && observed != previous;
+        back = true;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    if (!rule.armed)
+    {
+        rule.armed = back;
+        return false;
+    }
+    if (!beyond)
+    {
+        return false;
+    }
+    rule.armed = (rule.kind == kRuleChange);
+    event->rule = rule.id;
+    event->device = rule.device;
+    event->value = observed;
+    event->previous = previous;
+    event->time = time;
+    return true;
+}
+
+void RuleMonitor::Evaluate(int device, const std::string& command, double value, uint64_t time)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < mRules.size(); i++)
+    {
+        Rule& rule = mRules[i];
+        RuleEvent event;
+        if (rule.device != device || rule.command != command || !Check(rule, value, time, &event))
+        {
+            continue;
+        }
+        if (mEvents.size() >= MONITOR_MAX_EVENTS)
+        {
+            mDropped++; /* the first events tell what happened, keep those */
+            continue;
+        }
+        mEvents.push_back(event);
+    }
+}
+
+void RuleMonitor::Run()
+{
+    uint64_t next = ItechNowNs();
+    std::vector<std::pair<int, std::string> > quantities;
+    for (;;)
+    {
+        /* every quantity is measured once, however many rules refer to it */
+        quantities.clear();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (size_t i = 0; i < mRules.size(); i++)
+            {
+                std::pair<int, std::string> quantity(mRules[i].device, mRules[i].command);
+                bool known = false;
+                for (size_t j = 0; j < quantities.size() && !known; j++)
+                {
+                    known = (quantities[j] == quantity);
+                }
+                if (!known)
+                {
+                    quantities.push_back(quantity);
+                }
+            }
+        }
+        for (size_t i = 0; i < quantities.size(); i++)
+        {
+            double value;
+            uint64_t start = ItechNowNs();
+            if (mSource(mContext, quantities[i].first, quantities[i].second.c_str(), &value) >= 0)
+            {
+                Evaluate(quantities[i].first, quantities[i].second, value, start);
+            }
+        }
+
+        next += mPeriod;
+        uint64_t now = ItechNowNs();
+        if (next < now)
+        {
+            next = now;
+        }
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWake.wait_for(lock, std::chrono::nanoseconds(next - now), [this] { return mStopping; });
+        if (mStopping)
+        {
+            return;
+        }
+    }
+}
+
+size_t RuleMonitor::TakeEvents(std::vector<RuleEvent>* events)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t count = mEvents.size();
+    events->insert(events->end(), mEvents.begin(), mEvents.end());
+    mEvents.clear();
+    return count;
+}
+
+uint64_t RuleMonitor::Dropped() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDropped;
+}
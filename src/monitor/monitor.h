@@ -0,0 +1,134 @@
+/**
+ * @file monitor.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Threshold and event rules evaluated on a measurement thread.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * A RuleMonitor measures every quantity its rules refer to once per period
+ * on a thread of its own and evaluates the rules on the values. Only a rule
+ * that triggers produces an event, so the consumer has nothing to do while
+ * the instruments are in their steady state. A triggered rule is disarmed
+ * until the value is back by the hysteresis, it does not fire again on
+ * every sample of a lasting overcurrent.
+ */
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Rules of one monitor. */
+#define MONITOR_MAX_RULES  64
+/* Events queued until the consumer takes them, later ones are dropped. */
+#define MONITOR_MAX_EVENTS 256
+
+/**
+ * @brief What a rule looks for, the numbers are part of the CAPL interface.
+ */
+enum RuleKind
+{
+    kRuleAbove = 0, /* value rises above level, armed again below level - hysteresis    */
+    kRuleBelow,     /* value falls below level, armed again above level + hysteresis    */
+    kRuleRate,      /* |change per second| reaches level, armed again below level - hys */
+    kRuleChange,    /* the bits of level (0: all) of the integer value change, e.g. CV/CC */
+    kRuleKindCount
+};
+
+/**
+ * @brief A rule that triggered.
+ */
+struct RuleEvent
+{
+    int32_t  rule;
+    int32_t  device;
+    double   value;    /* the value that triggered, kRuleRate: the change per second */
+    double   previous; /* the value measured before, kRuleChange: the state before  */
+    uint64_t time;     /* ItechNowNs of the measurement */
+};
+
+/**
+ * @brief Measures command on one instrument, returns a status < 0 if there is no value.
+ */
+typedef int (*MonitorSource)(void* context, int device, const char* command, double* value);
+
+/**
+ * @brief Rules on measured quantities, evaluated periodically.
+ */
+class RuleMonitor
+{
+public:
+    RuleMonitor();
+    ~RuleMonitor();
+
+    /*
+     * Add a rule on the value of command (e.g. "MEAS:CURR?") of instrument
+     * device. Rules may be added and removed while the monitor runs.
+     * Returns the id of the rule (> 0) or -1 for invalid arguments or too
+     * many rules.
+     */
+    int Add(int device, const char* command, RuleKind kind, double level, double hysteresis);
+    /* Returns 0, or -1 if there is no such rule. */
+    int Remove(int rule);
+    void Clear();
+
+    /* Measure and evaluate every periodNs until Stop. Returns -1 if running already. */
+    int Start(MonitorSource source, void* context, uint64_t periodNs);
+    void Stop();
+    bool IsRunning() const { return mRunning.load(std::memory_order_acquire); }
+    uint64_t PeriodNs() const { return mPeriod; }
+
+    /* Evaluate the rules on command of device on one value, done by the thread. */
+    void Evaluate(int device, const std::string& command, double value, uint64_t time);
+
+    /* Append the events queued so far to events, oldest first. Returns their number. */
+    size_t TakeEvents(std::vector<RuleEvent>* events);
+    /* Events lost because the queue was full. */
+    uint64_t Dropped() const;
+
+private:
+    RuleMonitor(const RuleMonitor&);
+    RuleMonitor& operator=(const RuleMonitor&);
+
+    struct Rule
+    {
+        int32_t     id;
+        int32_t     device;
+        std::string command;
+        RuleKind    kind;
+        double      level;
+        double      hysteresis;
+        bool        armed;
+        bool        primed;       /* a value was seen before */
+        double      previous;
+        uint64_t    previousTime;
+    };
+
+    void Run();
+    bool Check(Rule& rule, double value, uint64_t time, RuleEvent* event);
+
+    MonitorSource           mSource;
+    void*                   mContext;
+    uint64_t                mPeriod;
+
+    mutable std::mutex      mMutex;
+    std::condition_variable mWake;
+    std::thread             mThread;
+    std::atomic<bool>       mRunning;
+    bool                    mStopping;
+
+    std::vector<Rule>       mRules;
+    int32_t                 mNextId;
+    std::deque<RuleEvent>   mEvents;
+    uint64_t                mDropped;
+};
+
+#endif
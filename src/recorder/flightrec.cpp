@@ -0,0 +1,283 @@
+/**
+ * @file flightrec.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Flight recorder: the last I/O events of every instrument, kept in memory.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <mutex>
+
+#include "flightrec.h"
+#include "opstats.h"
+#include "transport.h"
+
+#define FLIGHT_NAME_SIZE 128
+
+/**
+ * @brief One transport step.
+ */
+struct FlightEvent
+{
+    std::atomic<uint64_t> sequence; /* event number + 1 once written, 0 while writing */
+    uint64_t              start;
+    uint32_t              duration;
+    int32_t               status;
+    uint16_t              length;   /* of the data, may exceed what is kept */
+    uint8_t               kind;
+    char                  data[FLIGHT_DATA_SIZE];
+};
+
+/**
+ * @brief The events of one instrument.
+ */
+struct FlightRing
+{
+    char                  resource[FLIGHT_NAME_SIZE];
+    std::atomic<uint64_t> next;
+    std::atomic<uint64_t> lastDump;
+    FlightEvent           events[FLIGHT_EVENTS_PER_DEVICE];
+};
+
+static_assert((FLIGHT_EVENTS_PER_DEVICE & (FLIGHT_EVENTS_PER_DEVICE - 1)) == 0,
+              "FLIGHT_EVENTS_PER_DEVICE must be a power of two");
+
+static const char* const sKindNames[kFlightEventKindCount] = {
+    "DISCOVER", "OPEN", "WRITE", "READ", "FLUSH", "CLOSE", "SRQ", "STB",
+};
+
+/* Ring 0 is discovery and the instruments beyond FLIGHT_MAX_DEVICES. */
+static FlightRing        gRings[FLIGHT_MAX_DEVICES];
+static int               gRingCount = 1;
+static std::mutex        gRingMutex;
+static std::mutex        gDumpMutex;
+
+FlightRing* FlightRecorderRing(const char* resource)
+{
+    if (resource == nullptr || resource[0] == '\0')
+    {
+        return &gRings[0];
+    }
+    std::lock_guard<std::mutex> lock(gRingMutex);
+    for (int i = 1; i < gRingCount; i++)
+    {
+        if (strncmp(gRings[i].resource, resource, FLIGHT_NAME_SIZE - 1) == 0)
+        {
+            return &gRings[i];
+        }
+    }
+    if (gRingCount == FLIGHT_MAX_DEVICES)
+    {
+        return &gRings[0];
+    }
+    FlightRing* ring = &gRings[gRingCount++];
+    strncpy(ring->resource, resource, FLIGHT_NAME_SIZE - 1);
+    ring->resource[FLIGHT_NAME_SIZE - 1] = '\0';
+    return ring;
+}
+
+/**
+ * @brief An event copied out of its ring, the fields without the sequence.
+ */
+struct FlightSnapshot
+{
+    uint64_t start;
+    uint32_t duration;
+    int32_t  status;
+    uint16_t length;
+    uint8_t  kind;
+    char     data[FLIGHT_DATA_SIZE];
+};
+
+/* Print data with everything unprintable escaped. */
+static void sWriteData(FILE* file, const FlightSnapshot& event)
+{
+    size_t kept = event.length < FLIGHT_DATA_SIZE ? event.length : FLIGHT_DATA_SIZE;
+    fputc('"', file);
+    for (size_t i = 0; i < kept; i++)
+    {
+        unsigned char c = (unsigned char)event.data[i];
+        if (c == '\n')
+        {
+            fputs("\\n", file);
+        }
+        else if (c == '\r')
+        {
+            fputs("\\r", file);
+        }
+        else if (c == '"' || c == '\\')
+        {
+            fprintf(file, "\\%c", c);
+        }
+        else if (c < 0x20 || c >= 0x7F)
+        {
+            fprintf(file, "\\x%02x", c);
+        }
+        else
+        {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+    if (event.length > kept)
+    {
+        fprintf(file, " (+%u bytes)", (unsigned)(event.length - kept));
+    }
+}
+
+/*
+ * Copy an event, seqlock style: the sequence is read before and after the
+ * fields, an event written over in between is discarded. Returns false if
+ * the event is not number i (any more).
+ */
+static bool sReadEvent(const FlightEvent& event, uint64_t i, FlightSnapshot* copy)
+{
+    if (event.sequence.load(std::memory_order_acquire) != i + 1)
+    {
+        return false;
+    }
+    copy->start = event.start;
+    copy->duration = event.duration;
+    copy->status = event.status;
+    copy->length = event.length;
+    copy->kind = event.kind;
+    memcpy(copy->data, event.data, sizeof(copy->data));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return event.sequence.load(std::memory_order_relaxed) == i + 1 && copy->kind < kFlightEventKindCount;
+}
+
+/* Write the events of one ring oldest first, caller holds gDumpMutex. */
+static int sDumpRing(FILE* file, FlightRing& ring, uint64_t now)
+{
+    uint64_t next = ring.next.load(std::memory_order_acquire);
+    if (next == 0)
+    {
+        return 0;
+    }
+    uint64_t first = next > FLIGHT_EVENTS_PER_DEVICE ? next - FLIGHT_EVENTS_PER_DEVICE : 0;
+    fprintf(file, "-- %s: events %llu to %llu\n", ring.resource[0] != '\0' ? ring.resource : "(discovery)",
+            (unsigned long long)first, (unsigned long long)(next - 1));
+
+    int written = 0;
+    for (uint64_t i = first; i < next; i++)
+    {
+        FlightSnapshot event;
+        if (!sReadEvent(ring.events[i & (FLIGHT_EVENTS_PER_DEVICE - 1)], i, &event))
+        {
+            continue; /* being overwritten */
+        }
+        double age = (now >= event.start) ? (double)(now - event.start) / 1e6 : 0.0;
+        fprintf(file, "%12.3f ms ago  %-8s %10.1f us  status 0x%08X", age, sKindNames[event.kind],
+                (double)event.duration / 1000.0, (unsigned)event.status);
+        if (event.kind == kFlightWrite || event.kind == kFlightRead)
+        {
+            fputs("  ", file);
+            sWriteData(file, event);
+        }
+        else if (event.kind == kFlightStatusByte && event.length > 0)
+        {
+            fprintf(file, "  0x%02X", (unsigned char)event.data[0]);
+        }
+        fputc('\n', file);
+        written++;
+    }
+    return written;
+}
+
+static int sDump(const char* path, const char* reason, FlightRing* only)
+{
+    std::lock_guard<std::mutex> lock(gDumpMutex);
+    FILE* file = fopen((path != nullptr && path[0] != '\0') ? path : FLIGHT_DEFAULT_FILE, "a");
+    if (file == nullptr)
+    {
+        return -1;
+    }
+
+    time_t wall;
+    time(&wall);
+    uint64_t now = ItechNowNs();
+    fprintf(file, "==== %.24s flight recorder dump: %s\n", ctime(&wall), reason);
+
+    int written = 0;
+    if (only != nullptr)
+    {
+        written = sDumpRing(file, *only, now);
+    }
+    else
+    {
+        int count;
+        {
+            std::lock_guard<std::mutex> ringLock(gRingMutex);
+            count = gRingCount;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            written += sDumpRing(file, gRings[i], now);
+        }
+    }
+    fputc('\n', file);
+    if (fclose(file) != 0)
+    {
+        return -1;
+    }
+    return written;
+}
+
+void FlightRecord(FlightRing* ring, FlightEventKind kind, int32_t status, uint64_t start, uint64_t duration,
+                  const char* data, size_t length)
+{
+    if (ring == nullptr)
+    {
+        return;
+    }
+    uint64_t index = ring->next.fetch_add(1, std::memory_order_relaxed);
+    FlightEvent& event = ring->events[index & (FLIGHT_EVENTS_PER_DEVICE - 1)];
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.start = start;
+    event.duration = duration > UINT32_MAX ? UINT32_MAX : (uint32_t)duration;
+    event.status = status;
+    event.kind = (uint8_t)kind;
+    event.length = length > UINT16_MAX ? UINT16_MAX : (uint16_t)length;
+    if (data != nullptr && length > 0)
+    {
+        memcpy(event.data, data, length < FLIGHT_DATA_SIZE ? length : FLIGHT_DATA_SIZE);
+    }
+    event.sequence.store(index + 1, std::memory_order_release);
+
+    if (status >= 0)
+    {
+        return;
+    }
+    /* A failure: dump this instrument, unless it was dumped a moment ago. */
+    uint64_t now = start + duration;
+    uint64_t last = ring->lastDump.load(std::memory_order_relaxed);
+    if (last != 0 && now - last < FLIGHT_DUMP_INTERVAL_NS)
+    {
+        return;
+    }
+    if (ring->lastDump.compare_exchange_strong(last, now, std::memory_order_relaxed))
+    {
+        char reason[64];
+        if (status == kTransportErrorTimeout)
+        {
+            snprintf(reason, sizeof(reason), "%s timed out", sKindNames[kind]);
+        }
+        else
+        {
+            snprintf(reason, sizeof(reason), "%s failed with status 0x%08X", sKindNames[kind], (unsigned)status);
+        }
+        sDump(nullptr, reason, ring);
+    }
+}
+
+int FlightRecorderDump(const char* path, const char* reason)
+{
+    return sDump(path, reason != nullptr ? reason : "requested", nullptr);
+}
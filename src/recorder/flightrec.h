@@ -0,0 +1,67 @@
+/**
+ * @file flightrec.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Flight recorder: the last I/O events of every instrument, kept in memory.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * Every transport step is stored with its time, duration, status and the
+ * first bytes sent or received in a fixed ring per instrument. Nothing is
+ * written to disk until a step fails (errors and timeouts) or CAPL asks for
+ * it with dllItechFlightDump, then the rings are appended to a text file.
+ */
+#ifndef FLIGHTREC_H
+#define FLIGHTREC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Events kept per instrument, a power of two. */
+#define FLIGHT_EVENTS_PER_DEVICE 256
+/* Bytes of the data of an event that are kept. */
+#define FLIGHT_DATA_SIZE         48
+/* Instruments with a ring of their own, later ones share the first ring. */
+#define FLIGHT_MAX_DEVICES       16
+/* An instrument failing repeatedly is dumped at most once in this time. */
+#define FLIGHT_DUMP_INTERVAL_NS  5000000000ULL
+/* File the dumps are appended to when no path is given. */
+#define FLIGHT_DEFAULT_FILE      "capldllflight"
+
+/**
+ * @brief The transport step of an event.
+ */
+enum FlightEventKind
+{
+    kFlightDiscover = 0,
+    kFlightOpen,
+    kFlightWrite,
+    kFlightRead,
+    kFlightFlush,
+    kFlightClose,
+    kFlightServiceRequest, /* an SRQ arrived                */
+    kFlightStatusByte,     /* serial poll, data: the byte   */
+    kFlightEventKindCount
+};
+
+struct FlightRing;
+
+/* The ring of an instrument, created on first use. nullptr or "" is the ring of discovery. */
+FlightRing* FlightRecorderRing(const char* resource);
+
+/*
+ * Store one event. A failed step (status < 0) dumps the ring of the
+ * instrument to FLIGHT_DEFAULT_FILE, at most once per FLIGHT_DUMP_INTERVAL_NS.
+ */
+void FlightRecord(FlightRing* ring, FlightEventKind kind, int32_t status, uint64_t start, uint64_t duration,
+                  const char* data, size_t length);
+
+/*
+ * Append the rings of all instruments to path (nullptr or "":
+ * FLIGHT_DEFAULT_FILE). Returns the number of events written or -1 if the
+ * file could not be written.
+ */
+int FlightRecorderDump(const char* path, const char* reason);
+
+#endif
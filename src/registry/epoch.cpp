@@ -0,0 +1,127 @@
+/**
+ * @file epoch.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Epoch based reclamation: delete shared objects once no reader can see them.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "epoch.h"
+
+/**
+ * @brief The read state of one thread.
+ *
+ * Records are never freed: a thread keeps its record for its lifetime and
+ * the number of records is the number of threads that ever read, which is
+ * small and fixed in CANoe.
+ */
+struct EpochReader
+{
+    std::atomic<uint64_t> epoch; /* global epoch when the section was entered, 0: outside */
+    EpochReader*          next;
+};
+
+/**
+ * @brief An object waiting for its readers.
+ */
+struct EpochRetired
+{
+    void*        object;
+    EpochDeleter deleter;
+    uint64_t     epoch; /* readers entered at this epoch or before may see it */
+};
+
+static std::atomic<uint64_t>     gEpoch(1);
+static std::atomic<EpochReader*> gReaders(nullptr);
+static std::mutex                gRetireMutex;
+static std::vector<EpochRetired> gRetired;
+
+static thread_local EpochReader* tReader = nullptr;
+static thread_local uint32_t     tDepth = 0;
+
+static EpochReader* sReader()
+{
+    if (tReader == nullptr)
+    {
+        EpochReader* reader = new EpochReader();
+        reader->epoch.store(0, std::memory_order_relaxed);
+        reader->next = gReaders.load(std::memory_order_relaxed);
+        while (!gReaders.compare_exchange_weak(reader->next, reader, std::memory_order_release,
+                                               std::memory_order_relaxed))
+        {
+        }
+        tReader = reader;
+    }
+    return tReader;
+}
+
+void EpochEnter()
+{
+    if (tDepth++ == 0)
+    {
+        EpochReader* reader = sReader();
+        reader->epoch.store(gEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        /* The epoch must be visible before any pointer is read, pairs with the fence in sReclaim. */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+void EpochLeave()
+{
+    if (--tDepth == 0)
+    {
+        tReader->epoch.store(0, std::memory_order_release);
+    }
+}
+
+/* Caller holds gRetireMutex. */
+static size_t sReclaim()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t oldest = UINT64_MAX;
+    for (EpochReader* reader = gReaders.load(std::memory_order_acquire); reader != nullptr; reader = reader->next)
+    {
+        uint64_t epoch = reader->epoch.load(std::memory_order_acquire);
+        if (epoch != 0 && epoch < oldest)
+        {
+            oldest = epoch;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < gRetired.size(); i++)
+    {
+        if (gRetired[i].epoch < oldest)
+        {
+            gRetired[i].deleter(gRetired[i].object);
+        }
+        else
+        {
+            gRetired[kept++] = gRetired[i];
+        }
+    }
+    gRetired.resize(kept);
+    return kept;
+}
+
+void EpochRetire(void* object, EpochDeleter deleter)
+{
+    std::lock_guard<std::mutex> lock(gRetireMutex);
+    /* Readers entering from now on get a later epoch and cannot find the object any more. */
+    EpochRetired retired = {object, deleter, gEpoch.fetch_add(1, std::memory_order_seq_cst)};
+    gRetired.push_back(retired);
+    sReclaim();
+}
+
+size_t EpochReclaim()
+{
+    std::lock_guard<std::mutex> lock(gRetireMutex);
+    return sReclaim();
+}
@@ -0,0 +1,46 @@
+/**
+ * @file epoch.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Epoch based reclamation: delete shared objects once no reader can see them.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * Readers wrap their lookups in an EpochGuard, which costs two stores to a
+ * record of the thread and takes no lock. A writer first makes an object
+ * unreachable, then retires it: the object is deleted as soon as every
+ * reader that was inside a guard at that time has left it.
+ */
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stddef.h>
+
+typedef void (*EpochDeleter)(void* object);
+
+/* Enter and leave a read section, sections may be nested. */
+void EpochEnter();
+void EpochLeave();
+
+/* Delete object with deleter once all current readers have left. */
+void EpochRetire(void* object, EpochDeleter deleter);
+
+/* Delete what can be deleted now. Returns the number of objects still waiting. */
+size_t EpochReclaim();
+
+/**
+ * @brief Read section for the lifetime of the object.
+ */
+class EpochGuard
+{
+public:
+    EpochGuard() { EpochEnter(); }
+    ~EpochGuard() { EpochLeave(); }
+
+private:
+    EpochGuard(const EpochGuard&);
+    EpochGuard& operator=(const EpochGuard&);
+};
+
+#endif
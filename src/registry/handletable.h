@@ -0,0 +1,194 @@
+/**
+ * @file handletable.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Table from CAPL handles to objects, with wait-free lookups.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * A fixed array of slots with open addressing. Find reads at most Capacity
+ * slots and takes no lock, so every exported function can look up its CAPL
+ * block while other blocks register or leave. Insert and Remove take a
+ * mutex. A removed object can still be in use by a reader that found it
+ * just before: retire it with EpochRetire instead of deleting it, and look
+ * up inside an EpochGuard.
+ */
+#ifndef HANDLETABLE_H
+#define HANDLETABLE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/* Slots of a table, more CAPL blocks than this cannot be registered. */
+#define HANDLE_TABLE_CAPACITY 256
+
+template <typename T, uint32_t Capacity = HANDLE_TABLE_CAPACITY>
+class HandleTable
+{
+public:
+    HandleTable()
+    {
+        for (uint32_t i = 0; i < Capacity; i++)
+        {
+            mSlots[i].key.store(kEmpty, std::memory_order_relaxed);
+            mSlots[i].value.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    /* The object of handle or nullptr. Wait-free. */
+    T* Find(uint32_t handle) const
+    {
+        uint64_t key = Key(handle);
+        for (uint32_t n = 0, i = Home(handle); n < Capacity; n++, i = (i + 1) & (Capacity - 1))
+        {
+            const Slot& slot = mSlots[i];
+            uint64_t found = slot.key.load(std::memory_order_acquire);
+            if (found == kEmpty)
+            {
+                return nullptr;
+            }
+            if (found != key)
+            {
+                continue;
+            }
+            T* value = slot.value.load(std::memory_order_acquire);
+            /* Removed and the slot given to another handle meanwhile: handle is gone. */
+            if (slot.key.load(std::memory_order_acquire) != key)
+            {
+                continue;
+            }
+            return value;
+        }
+        return nullptr;
+    }
+
+    /*
+     * Set the object of handle, previous receives the object it replaces (or
+     * nullptr). Returns false if the table is full.
+     */
+    bool Insert(uint32_t handle, T* value, T** previous = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        uint64_t key = Key(handle);
+        Slot* free = nullptr;
+        for (uint32_t n = 0, i = Home(handle); n < Capacity; n++, i = (i + 1) & (Capacity - 1))
+        {
+            Slot& slot = mSlots[i];
+            uint64_t found = slot.key.load(std::memory_order_relaxed);
+            if (found == key)
+            {
+                T* old = slot.value.exchange(value, std::memory_order_acq_rel);
+                if (previous != nullptr)
+                {
+                    *previous = old;
+                }
+                return true;
+            }
+            if (found == kTombstone && free == nullptr)
+            {
+                free = &slot;
+            }
+            if (found == kEmpty)
+            {
+                free = (free == nullptr) ? &slot : free;
+                break;
+            }
+        }
+        if (free == nullptr)
+        {
+            return false;
+        }
+        /* The value first: a reader matching the key must see it. */
+        free->value.store(value, std::memory_order_release);
+        free->key.store(key, std::memory_order_release);
+        if (previous != nullptr)
+        {
+            *previous = nullptr;
+        }
+        return true;
+    }
+
+    /* Take handle out of the table, returns its object or nullptr. */
+    T* Remove(uint32_t handle)
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        uint64_t key = Key(handle);
+        for (uint32_t n = 0, i = Home(handle); n < Capacity; n++, i = (i + 1) & (Capacity - 1))
+        {
+            Slot& slot = mSlots[i];
+            uint64_t found = slot.key.load(std::memory_order_relaxed);
+            if (found == kEmpty)
+            {
+                return nullptr;
+            }
+            if (found == key)
+            {
+                /* The slot keeps the probe chain going for the handles behind it. */
+                slot.key.store(kTombstone, std::memory_order_release);
+                return slot.value.exchange(nullptr, std::memory_order_acq_rel);
+            }
+        }
+        return nullptr;
+    }
+
+    /* The handles in the table at the moment. */
+    std::vector<uint32_t> Handles() const
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        std::vector<uint32_t> handles;
+        for (uint32_t i = 0; i < Capacity; i++)
+        {
+            uint64_t key = mSlots[i].key.load(std::memory_order_relaxed);
+            if (key != kEmpty && key != kTombstone)
+            {
+                handles.push_back((uint32_t)key);
+            }
+        }
+        return handles;
+    }
+
+    /* Remove every handle, the objects are not touched. */
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        for (uint32_t i = 0; i < Capacity; i++)
+        {
+            uint64_t key = mSlots[i].key.load(std::memory_order_relaxed);
+            if (key != kEmpty && key != kTombstone)
+            {
+                mSlots[i].key.store(kTombstone, std::memory_order_release);
+                mSlots[i].value.store(nullptr, std::memory_order_release);
+            }
+        }
+    }
+
+private:
+    HandleTable(const HandleTable&);
+    HandleTable& operator=(const HandleTable&);
+
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    /* Keys of used slots have bit 32 set, so they never equal the two markers. */
+    static const uint64_t kEmpty     = 0;
+    static const uint64_t kTombstone = 1;
+
+    static uint64_t Key(uint32_t handle) { return (1ULL << 32) | handle; }
+    static uint32_t Home(uint32_t handle) { return (handle * 2654435761u) & (Capacity - 1); }
+
+    /**
+     * @brief One handle and its object.
+     */
+    struct Slot
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<T*>       value;
+    };
+
+    Slot               mSlots[Capacity];
+    mutable std::mutex mWriteMutex;
+};
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file sampler.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Periodic measurements on a thread of their own, handed out in batches.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <chrono>
+
+#include "sampler.h"
+#include "opstats.h"
+
+SampleStream::SampleStream()
+    : mSource(nullptr),
+      mContext(nullptr),
+      mPeriod(0),
+      mBatchSize(0),
+      mMaxLatency(0),
+      mRunning(false),
+      mStopping(false),
+      mHead(0),
+      mCount(0),
+      mDropped(0),
+      mFailed(0)
+{
+}
+
+SampleStream::~SampleStream()
+{
+    Stop();
+}
+
+int SampleStream::Start(SampleSource source, void* context, uint64_t periodNs, uint32_t batchSize,
+                        uint64_t maxLatencyNs)
+{
+    if (source == nullptr || batchSize == 0 || batchSize > SAMPLE_MAX_BATCH || IsRunning())
+    {
+        return -1;
+    }
+    /* the thread of a stream stopped before is joined already */
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSource = source;
+    mContext = context;
+    mPeriod = periodNs;
+    mBatchSize = batchSize;
+    mMaxLatency = maxLatencyNs;
+    mValues.assign((size_t)batchSize * SAMPLE_QUEUE_BATCHES, 0.0);
+    mTimes.assign(mValues.size(), 0);
+    mHead = 0;
+    mCount = 0;
+    mDropped = 0;
+    mFailed = 0;
+    mStopping = false;
+    mRunning.store(true, std::memory_order_release);
+    mThread = std::thread(&SampleStream::Run, this);
+    return 0;
+}
+
+void SampleStream::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    mRunning.store(false, std::memory_order_release);
+}
+
+/* The oldest sample goes if the queue is full, the latest values matter most. */
+void SampleStream::Push(double value, uint64_t time)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t capacity = mValues.size();
+    if (mCount == capacity)
+    {
+        mHead = (mHead + 1) % capacity;
+        mCount--;
+        mDropped++;
+    }
+    size_t tail = (mHead + mCount) % capacity;
+    mValues[tail] = value;
+    mTimes[tail] = time;
+    mCount++;
+}
+
+void SampleStream::Run()
+{
+    uint64_t next = ItechNowNs();
+    for (;;)
+    {
+        double value;
+        uint64_t start = ItechNowNs();
+        if (mSource(mContext, &value) < 0)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFailed++;
+        }
+        else
+        {
+            Push(value, start);
+        }
+
+        /* fixed rate; a measurement that took longer than the period delays the next, no catching up */
+        next += mPeriod;
+        uint64_t now = ItechNowNs();
+        if (next < now)
+        {
+            next = now;
+        }
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWake.wait_for(lock, std::chrono::nanoseconds(next - now), [this] { return mStopping; });
+        if (mStopping)
+        {
+            return;
+        }
+    }
+}
+
+uint32_t SampleStream::TakeBatch(uint64_t now, bool all, double* values, uint64_t* firstTime)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mCount == 0)
+    {
+        return 0;
+    }
+    bool due = all || mCount >= mBatchSize || now - mTimes[mHead] >= mMaxLatency;
+    if (!due)
+    {
+        return 0;
+    }
+    uint32_t taken = mCount < mBatchSize ? (uint32_t)mCount : mBatchSize;
+    size_t capacity = mValues.size();
+    *firstTime = mTimes[mHead];
+    for (uint32_t i = 0; i < taken; i++)
+    {
+        values[i] = mValues[(mHead + i) % capacity];
+    }
+    mHead = (mHead + taken) % capacity;
+    mCount -= taken;
+    return taken;
+}
+
+uint64_t SampleStream::Dropped() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDropped;
+}
+
+uint64_t SampleStream::Failed() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFailed;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file sampler.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Periodic measurements on a thread of their own, handed out in batches.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * A SampleStream measures with a fixed period on its own thread and keeps
+ * the values with their time in a queue. The consumer, the CAPL block on
+ * the measurement thread, takes them a batch at a time: a batch is due when
+ * it is full or when its first sample is max latency old. So CAPL sees one
+ * callback per batch instead of one per sample, and never waits for longer
+ * than the latency it asked for.
+ */
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Largest batch, a CAPL array of this many doubles. */
+#define SAMPLE_MAX_BATCH   4096
+/* Batches queued before the oldest samples are dropped. */
+#define SAMPLE_QUEUE_BATCHES 8
+
+/**
+ * @brief Measures one value, returns a status < 0 if there is none.
+ */
+typedef int (*SampleSource)(void* context, double* value);
+
+/**
+ * @brief Measurements taken periodically and collected in batches.
+ */
+class SampleStream
+{
+public:
+    SampleStream();
+    ~SampleStream();
+
+    /*
+     * Measure with source every periodNs (0: back to back) until Stop.
+     * batchSize is 1 .. SAMPLE_MAX_BATCH. Returns 0, or -1 for invalid
+     * arguments or if the stream is running already.
+     */
+    int Start(SampleSource source, void* context, uint64_t periodNs, uint32_t batchSize, uint64_t maxLatencyNs);
+
+    /* Stop measuring and wait for the thread. Queued samples are kept for TakeBatch. */
+    void Stop();
+
+    bool IsRunning() const { return mRunning.load(std::memory_order_acquire); }
+
+    /*
+     * Take the next batch due at now (ItechNowNs): a full one, or a partial
+     * one whose first sample is max latency old, or with all any samples at
+     * all. values needs room for BatchSize() values. Returns the number of
+     * values, 0 if no batch is due, and the time of the first one.
+     */
+    uint32_t TakeBatch(uint64_t now, bool all, double* values, uint64_t* firstTime);
+
+    uint32_t BatchSize() const { return mBatchSize; }
+    uint64_t MaxLatencyNs() const { return mMaxLatency; }
+    /* Samples lost because the consumer did not keep up. */
+    uint64_t Dropped() const;
+    /* Measurements that failed, they are not queued. */
+    uint64_t Failed() const;
+
+private:
+    SampleStream(const SampleStream&);
+    SampleStream& operator=(const SampleStream&);
+
+    void Run();
+    void Push(double value, uint64_t time);
+
+    SampleSource            mSource;
+    void*                   mContext;
+    uint64_t                mPeriod;
+    uint32_t                mBatchSize;
+    uint64_t                mMaxLatency;
+
+    mutable std::mutex      mMutex;
+    std::condition_variable mWake;
+    std::thread             mThread;
+    std::atomic<bool>       mRunning;
+    bool                    mStopping;
+
+    /* ring of SAMPLE_QUEUE_BATCHES batches */
+    std::vector<double>     mValues;
+    std::vector<uint64_t>   mTimes;
+    size_t                  mHead;
+    size_t                  mCount;
+    uint64_t                mDropped;
+    uint64_t                mFailed;
+};
+
+#endif
@@ -0,0 +1,232 @@
+/**
+ * @file sequence.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Timed command sequences run on a thread of their own.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "sequence.h"
+#include "opstats.h"
+
+SequenceRunner::SequenceRunner()
+    : mSink(nullptr),
+      mContext(nullptr),
+      mRunning(false),
+      mStopping(false),
+      mAborted(false)
+{
+}
+
+SequenceRunner::~SequenceRunner()
+{
+    Abort();
+}
+
+int SequenceRunner::Add(uint64_t offsetNs, const char* command)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (command == nullptr || *command == '\0' || mSteps.size() >= SEQUENCE_MAX_STEPS || IsRunning())
+    {
+        return -1;
+    }
+    Step step;
+    step.offset = offsetNs;
+    step.command = command;
+    mSteps.push_back(step);
+    return (int)mSteps.size() - 1;
+}
+
+int SequenceRunner::Clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (IsRunning())
+    {
+        return -1;
+    }
+    mSteps.clear();
+    mOrder.clear();
+    mResults.clear();
+    mAborted = false;
+    return 0;
+}
+
+size_t SequenceRunner::Size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSteps.size();
+}
+
+/* A thread that ended by itself is joined by the next Start or Abort. */
+void SequenceRunner::Join()
+{
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+int SequenceRunner::Start(SequenceSink sink, void* context)
+{
+    if (sink == nullptr || IsRunning())
+    {
+        return -1;
+    }
+    Join();
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mSteps.empty())
+    {
+        return -1;
+    }
+    mOrder.resize(mSteps.size());
+    for (size_t i = 0; i < mOrder.size(); i++)
+    {
+        mOrder[i] = (int32_t)i;
+    }
+    std::stable_sort(mOrder.begin(), mOrder.end(),
+                     [this](int32_t a, int32_t b) { return mSteps[a].offset < mSteps[b].offset; });
+    mSink = sink;
+    mContext = context;
+    mResults.clear();
+    mResults.reserve(mSteps.size());
+    mAborted = false;
+    mStopping.store(false, std::memory_order_relaxed);
+    mRunning.store(true, std::memory_order_release);
+    mThread = std::thread(&SequenceRunner::Run, this);
+    return 0;
+}
+
+int SequenceRunner::Abort()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping.store(true, std::memory_order_relaxed);
+    }
+    mWake.notify_all();
+    Join();
+    mRunning.store(false, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    return (int)(mOrder.size() - mResults.size());
+}
+
+/* Sleep until SEQUENCE_SPIN_NS before due, then spin. Returns false if aborted. */
+bool SequenceRunner::WaitUntil(uint64_t due)
+{
+    uint64_t now = ItechNowNs();
+    if (due > now + SEQUENCE_SPIN_NS)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWake.wait_for(lock, std::chrono::nanoseconds(due - SEQUENCE_SPIN_NS - now),
+                       [this] { return mStopping.load(std::memory_order_relaxed); });
+    }
+    while (!mStopping.load(std::memory_order_relaxed) && ItechNowNs() < due)
+    {
+        std::this_thread::yield();
+    }
+    return !mStopping.load(std::memory_order_relaxed);
+}
+
+void SequenceRunner::Run()
+{
+    /* Best effort: without the right to, the thread runs at normal priority. */
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+    timeBeginPeriod(1);
+#else
+    sched_param param;
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+
+    /* the steps do not change while running, Add and Clear refuse */
+    uint64_t start = ItechNowNs();
+    bool aborted = false;
+    for (size_t i = 0; i < mOrder.size(); i++)
+    {
+        const Step& step = mSteps[mOrder[i]];
+        uint64_t due = start + step.offset;
+        if (!WaitUntil(due))
+        {
+            aborted = true;
+            break;
+        }
+        SequenceStepResult result;
+        result.step = mOrder[i];
+        result.time = ItechNowNs();
+        result.status = mSink(mContext, step.command.c_str());
+        result.durationNs = ItechNowNs() - result.time;
+        result.errorNs = (int64_t)(result.time - due);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mResults.push_back(result);
+    }
+
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+    std::lock_guard<std::mutex> lock(mMutex);
+    mAborted = aborted;
+    mRunning.store(false, std::memory_order_release);
+}
+
+size_t SequenceRunner::Results(size_t from, std::vector<SequenceStepResult>* results) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (from >= mResults.size())
+    {
+        return 0;
+    }
+    results->insert(results->end(), mResults.begin() + from, mResults.end());
+    return mResults.size() - from;
+}
+
+int SequenceRunner::Result(int step, SequenceStepResult* result) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < mResults.size(); i++)
+    {
+        if (mResults[i].step == step)
+        {
+            *result = mResults[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+size_t SequenceRunner::Executed() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mResults.size();
+}
+
+int64_t SequenceRunner::MaxErrorNs() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    int64_t worst = 0;
+    for (size_t i = 0; i < mResults.size(); i++)
+    {
+        worst = std::max(worst, mResults[i].errorNs);
+    }
+    return worst;
+}
+
+bool SequenceRunner::Aborted() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAborted;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file sequence.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Timed command sequences run on a thread of their own.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * A profile written in CAPL as writes and waits follows the measurement
+ * thread, every step is as late as the events before it. A SequenceRunner
+ * gets the steps, a time offset and a command each, up front and sends them
+ * from a thread of raised priority against the steady clock: it sleeps until
+ * shortly before a step and spins the rest of the way, so a step starts
+ * within microseconds of its offset unless the one before is still being
+ * written. Every step keeps how late it started, and the sequence can be
+ * aborted between any two steps.
+ */
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Steps of one sequence. */
+#define SEQUENCE_MAX_STEPS 4096
+/* The last part of the wait for a step is spun, a sleep can overshoot by a timer tick. */
+#define SEQUENCE_SPIN_NS   2000000ULL
+
+/**
+ * @brief A step that was run.
+ */
+struct SequenceStepResult
+{
+    int32_t  step;       /* index in the order the steps were added */
+    int32_t  status;     /* of sending the command */
+    int64_t  errorNs;    /* start - start of the sequence - offset, > 0 late */
+    uint64_t durationNs; /* of sending the command */
+    uint64_t time;       /* ItechNowNs of the start */
+};
+
+/**
+ * @brief Sends the command of one step, returns a status < 0 if it failed.
+ */
+typedef int (*SequenceSink)(void* context, const char* command);
+
+/**
+ * @brief Commands sent at fixed offsets from the start.
+ */
+class SequenceRunner
+{
+public:
+    SequenceRunner();
+    ~SequenceRunner();
+
+    /*
+     * Add a step sent offsetNs after the start. Steps may be added in any
+     * order, those with the same offset run in the order added. Returns the
+     * index of the step, or -1 for invalid arguments, too many steps or if
+     * the sequence runs.
+     */
+    int Add(uint64_t offsetNs, const char* command);
+    /* Remove every step and result. Returns 0, or -1 if the sequence runs. */
+    int Clear();
+    size_t Size() const;
+
+    /*
+     * Run the steps with sink. The results of a run before are dropped.
+     * Returns 0, or -1 if there are no steps or the sequence runs already.
+     */
+    int Start(SequenceSink sink, void* context);
+    /*
+     * Stop before the next step and wait for the thread; a command being
+     * sent is finished. Returns the number of steps not run.
+     */
+    int Abort();
+    /* From Start until the last step is done or Abort. */
+    bool IsRunning() const { return mRunning.load(std::memory_order_acquire); }
+
+    /* Append the results from the from-th on, in the order run. Returns their number. */
+    size_t Results(size_t from, std::vector<SequenceStepResult>* results) const;
+    /* Result of one step by index. Returns 0, or -1 if the step did not run. */
+    int Result(int step, SequenceStepResult* result) const;
+    /* Steps run so far, and the latest start among them. */
+    size_t Executed() const;
+    int64_t MaxErrorNs() const;
+    /* Whether the last run was aborted before its last step. */
+    bool Aborted() const;
+
+private:
+    SequenceRunner(const SequenceRunner&);
+    SequenceRunner& operator=(const SequenceRunner&);
+
+    struct Step
+    {
+        uint64_t    offset;
+        std::string command;
+    };
+
+    void Run();
+    bool WaitUntil(uint64_t due);
+    void Join();
+
+    std::vector<Step>               mSteps;
+    std::vector<int32_t>            mOrder;   /* step indexes by offset, fixed while running */
+    SequenceSink                    mSink;
+    void*                           mContext;
+
+    mutable std::mutex              mMutex;
+    std::condition_variable         mWake;
+    std::thread                     mThread;
+    std::atomic<bool>               mRunning;
+    std::atomic<bool>               mStopping; /* set under mMutex, read by the spin without it */
+
+    std::vector<SequenceStepResult> mResults;
+    bool                            mAborted;
+};
+
+#endif
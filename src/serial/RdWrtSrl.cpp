@@ -0,0 +1,44 @@
+/**
+ * @file RdWrtSrl.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief 
+ * @version 0.2
+ * @date 2023-07-14
+ * 
+ * @copyright Copyright (c) 2023 MIT
+ * 
+ */
+/********************************************************************/
+/*                Read and Write to a Serial Instrument             */
+/*                                                                  */
+/* The commands are sent through the serial port (COM1). The port   */
+/* configuration lives in the serial transport, see                 */
+/* visatransport.cpp.                                               */
+/********************************************************************/
+
+#include "RdWrtSrl.h"
+#include "itechdc.h"
+
+/**
+ * @brief Write a standard SIPC command to an ITECH DC power supply.
+ * 
+ * @param command SIPC command string.
+ * @return int 
+ */
+int ItechDcPowerWriteSerial(char *command)
+{
+   return ItechDcPowerExchange(kTransportSerial, command, nullptr, nullptr);
+}
+
+/**
+ * @brief Write a query command to an ITECH DC power supply and read back its reply.
+ * 
+ * @param command SIPC query command string.
+ * @param resultString Buffer to save a reply string.
+ * @param result Numberic reply will also be saved in this buffer.
+ * @return int 
+ */
+int ItechDcPowerQuerySerial(char *command, char *resultString, double *result)
+{
+   return ItechDcPowerExchange(kTransportSerial, command, resultString, result);
+}
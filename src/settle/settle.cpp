@@ -0,0 +1,96 @@
+/**
+ * @file settle.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Wait until a measured quantity settled at its target, polling adaptively.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <math.h>
+#include <chrono>
+#include <thread>
+
+#include "settle.h"
+#include "opstats.h"
+#include "transport.h"
+
+int WaitSettled(SettleSource source, void* context, double target, double tolerance, uint64_t stableNs,
+                uint64_t timeoutNs, SettleResult* result)
+{
+    result->settleNs = 0;
+    result->measurements = 0;
+    result->last = 0.0;
+
+    uint64_t start = ItechNowNs();
+    uint64_t deadline = start + timeoutNs;
+    uint64_t pause = SETTLE_FAST_POLL_NS;
+    bool inside = false;
+    uint64_t entered = 0; /* first value of the current stretch within tolerance */
+    bool primed = false;
+    double previous = 0.0;
+
+    for (;;)
+    {
+        double value;
+        uint64_t now = ItechNowNs();
+        int status = source(context, &value);
+        if (status < 0)
+        {
+            return status;
+        }
+        result->measurements++;
+        result->last = value;
+
+        bool within = fabs(value - target) <= tolerance;
+        /* a quarter of the tolerance per measurement is still on the way */
+        bool moving = primed && fabs(value - previous) > tolerance / 4;
+        primed = true;
+        previous = value;
+
+        if (!within)
+        {
+            inside = false;
+            pause = SETTLE_FAST_POLL_NS;
+        }
+        else
+        {
+            if (!inside)
+            {
+                inside = true;
+                entered = now;
+            }
+            if (now - entered >= stableNs)
+            {
+                result->settleNs = entered - start;
+                return kTransportOk;
+            }
+            pause = moving ? SETTLE_FAST_POLL_NS : pause * 2;
+            if (pause > SETTLE_SLOW_POLL_NS)
+            {
+                pause = SETTLE_SLOW_POLL_NS;
+            }
+        }
+
+        /* measure again no later than the stretch would be long enough, or the time is up */
+        uint64_t next = ItechNowNs() + pause;
+        if (inside && next > entered + stableNs)
+        {
+            next = entered + stableNs;
+        }
+        if (next >= deadline)
+        {
+            if (ItechNowNs() >= deadline)
+            {
+                return kTransportErrorTimeout;
+            }
+            next = deadline;
+        }
+        uint64_t after = ItechNowNs();
+        if (next > after)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(next - after));
+        }
+    }
+}
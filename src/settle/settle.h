@@ -0,0 +1,51 @@
+/**
+ * @file settle.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Wait until a measured quantity settled at its target, polling adaptively.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * A setting is accepted long before the output follows it. WaitSettled
+ * measures until the value stayed within tolerance of the target for the
+ * stable time. Outside the tolerance, or while the value still moves by a
+ * good part of the tolerance from one measurement to the next, it measures
+ * as fast as it can; once the value rests inside, the pause doubles up to
+ * SETTLE_SLOW_POLL_NS, so a long stable time does not keep the bus busy.
+ */
+#ifndef SETTLE_H
+#define SETTLE_H
+
+#include <stdint.h>
+
+/* Pause between measurements while the value is off or moving. */
+#define SETTLE_FAST_POLL_NS 1000000ULL
+/* Longest pause once the value rests within tolerance. */
+#define SETTLE_SLOW_POLL_NS 50000000ULL
+
+/**
+ * @brief Measures the quantity once, returns a status < 0 if there is no value.
+ */
+typedef int (*SettleSource)(void* context, double* value);
+
+/**
+ * @brief Settling of one wait.
+ */
+struct SettleResult
+{
+    uint64_t settleNs;     /* from the start to the first value of the stable stretch */
+    uint32_t measurements;
+    double   last;         /* the last value measured */
+};
+
+/*
+ * Measure with source until the value stayed within target +- tolerance for
+ * stableNs, at most timeoutNs. Returns 0 and fills result, the status of a
+ * failed measurement, or kTransportErrorTimeout (result filled as far as it
+ * got).
+ */
+int WaitSettled(SettleSource source, void* context, double target, double tolerance, uint64_t stableNs,
+                uint64_t timeoutNs, SettleResult* result);
+
+#endif
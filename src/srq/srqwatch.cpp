@@ -0,0 +1,184 @@
+/**
+ * @file srqwatch.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Service requests (SRQ) of the instruments turned into events.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <chrono>
+#include <memory>
+
+#include "srqwatch.h"
+#include "opstats.h"
+
+ServiceRequestWatcher::ServiceRequestWatcher()
+    : mKind(kTransportUsb),
+      mServiceEnable(0),
+      mQuery(nullptr),
+      mContext(nullptr),
+      mPoll(0),
+      mRunning(false),
+      mWaiting(0),
+      mStopping(false),
+      mDropped(0)
+{
+}
+
+ServiceRequestWatcher::~ServiceRequestWatcher()
+{
+    Stop();
+}
+
+int ServiceRequestWatcher::Start(TransportKind kind, const std::vector<std::string>& resources, uint8_t serviceEnable,
+                                 StatusQuery query, void* context, uint64_t pollNs)
+{
+    if (query == nullptr || resources.empty() || resources.size() > SRQ_MAX_DEVICES || IsRunning())
+    {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mKind = kind;
+    mResources = resources;
+    mServiceEnable = serviceEnable;
+    mQuery = query;
+    mContext = context;
+    mPoll = pollNs;
+    mWaiting.store(0, std::memory_order_relaxed);
+    mStopping = false;
+    mRunning.store(true, std::memory_order_release);
+    for (size_t i = 0; i < mResources.size(); i++)
+    {
+        mThreads.push_back(std::thread(&ServiceRequestWatcher::Run, this, (int)i));
+    }
+    return 0;
+}
+
+void ServiceRequestWatcher::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    /* a thread waiting for SRQ notices within SRQ_WAIT_SLICE_MS, all of them at once */
+    for (size_t i = 0; i < mThreads.size(); i++)
+    {
+        mThreads[i].join();
+    }
+    mThreads.clear();
+    mRunning.store(false, std::memory_order_release);
+}
+
+bool ServiceRequestWatcher::Stopping()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStopping;
+}
+
+/* Read the registers the status byte points at, they are cleared by reading. */
+void ServiceRequestWatcher::Report(int device, uint8_t statusByte)
+{
+    ServiceRequestEvent event;
+    event.device = device;
+    event.statusByte = statusByte;
+    event.eventStatus = 0;
+    event.questionable = 0;
+    event.time = ItechNowNs();
+
+    double value;
+    if ((statusByte & SRQ_STB_ESB) != 0 && mQuery(mContext, device, "*ESR?", &value) >= 0)
+    {
+        event.eventStatus = (int32_t)value;
+    }
+    if ((statusByte & SRQ_STB_QUES) != 0 && mQuery(mContext, device, "STAT:QUES?", &value) >= 0)
+    {
+        event.questionable = (int32_t)value;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mEvents.size() >= SRQ_MAX_EVENTS)
+    {
+        mDropped++; /* the first events tell what happened, keep those */
+        return;
+    }
+    mEvents.push_back(event);
+}
+
+void ServiceRequestWatcher::Run(int device)
+{
+    std::unique_ptr<Transport> session;
+    if (mKind == kTransportUsb)
+    {
+        session.reset(CreateTransport(mKind));
+        if (session && (session->Open(mResources[device].c_str()) < kTransportOk
+                        || session->EnableServiceRequest() < kTransportOk))
+        {
+            session.reset();
+        }
+    }
+    if (session)
+    {
+        mWaiting.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint8_t previous = 0;
+    while (!Stopping())
+    {
+        if (session)
+        {
+            uint8_t statusByte;
+            TransportStatus status = session->WaitServiceRequest(SRQ_WAIT_SLICE_MS);
+            if (status == kTransportErrorTimeout)
+            {
+                continue;
+            }
+            if (status < kTransportOk || session->ReadStatusByte(&statusByte) < kTransportOk)
+            {
+                /* the session broke, poll from now on */
+                session.reset();
+                mWaiting.fetch_sub(1, std::memory_order_relaxed);
+                continue;
+            }
+            Report(device, statusByte);
+            continue;
+        }
+
+        /* No SRQ: a request is an enabled bit of "*STB?" that was not set the last time. */
+        double value;
+        if (mQuery(mContext, device, "*STB?", &value) >= 0)
+        {
+            uint8_t statusByte = (uint8_t)value;
+            uint8_t requested = statusByte & mServiceEnable & ~SRQ_STB_RQS;
+            if ((requested & ~previous) != 0)
+            {
+                Report(device, statusByte);
+            }
+            previous = requested;
+        }
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWake.wait_for(lock, std::chrono::nanoseconds(mPoll), [this] { return mStopping; });
+    }
+
+    if (session)
+    {
+        mWaiting.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+size_t ServiceRequestWatcher::TakeEvents(std::vector<ServiceRequestEvent>* events)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t count = mEvents.size();
+    events->insert(events->end(), mEvents.begin(), mEvents.end());
+    mEvents.clear();
+    return count;
+}
+
+uint64_t ServiceRequestWatcher::Dropped() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDropped;
+}
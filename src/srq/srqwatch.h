@@ -0,0 +1,120 @@
+/**
+ * @file srqwatch.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Service requests (SRQ) of the instruments turned into events.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * An instrument whose *SRE, *ESE and STAT:QUES:ENAB masks are set requests
+ * service when protection trips or an operation completes, there is no need
+ * to poll its status registers. A ServiceRequestWatcher has one thread per
+ * instrument waiting for the requests on a session of its own; that session
+ * only waits and reads the status byte, so it does not take the instrument
+ * lock the SCPI exchanges hold. Backends without SRQ, RS232 in particular,
+ * are polled with "*STB?" instead.
+ *
+ * Every request becomes one event with the status byte and, if their
+ * summary bits are set, the standard event and questionable registers read
+ * (and so cleared) right after.
+ */
+#ifndef SRQWATCH_H
+#define SRQWATCH_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "transport.h"
+
+/* Instruments of one watcher, each has a thread. */
+#define SRQ_MAX_DEVICES   16
+/* Events queued until the consumer takes them, later ones are dropped. */
+#define SRQ_MAX_EVENTS    256
+/* A thread waiting for a request looks for Stop this often. */
+#define SRQ_WAIT_SLICE_MS 50
+
+/* Status byte bits (IEEE 488.2) */
+#define SRQ_STB_QUES      0x08 /* questionable summary, STAT:QUES? tells more */
+#define SRQ_STB_ESB       0x20 /* standard event summary, *ESR? tells more    */
+#define SRQ_STB_RQS       0x40 /* request service / master summary            */
+
+/**
+ * @brief A service request of one instrument.
+ */
+struct ServiceRequestEvent
+{
+    int32_t  device;
+    int32_t  statusByte;   /* serial poll, or "*STB?" when polled     */
+    int32_t  eventStatus;  /* "*ESR?" if ESB was set, 0 otherwise      */
+    int32_t  questionable; /* "STAT:QUES?" if QUES was set, 0 otherwise */
+    uint64_t time;         /* ItechNowNs of the request */
+};
+
+/**
+ * @brief Sends a query to one instrument, returns a status < 0 if there is no value.
+ */
+typedef int (*StatusQuery)(void* context, int device, const char* command, double* value);
+
+/**
+ * @brief Waits for the service requests of the instruments of one backend.
+ */
+class ServiceRequestWatcher
+{
+public:
+    ServiceRequestWatcher();
+    ~ServiceRequestWatcher();
+
+    /*
+     * Watch resources, one per device in device order, until Stop. The masks
+     * must be set on the instruments already; serviceEnable is their *SRE,
+     * polling only reports those bits. query reads the registers, pollNs is
+     * the period of "*STB?" where there is no SRQ. Returns 0, or -1 for
+     * invalid arguments or if watching already.
+     */
+    int Start(TransportKind kind, const std::vector<std::string>& resources, uint8_t serviceEnable,
+              StatusQuery query, void* context, uint64_t pollNs);
+    void Stop();
+    bool IsRunning() const { return mRunning.load(std::memory_order_acquire); }
+
+    /* Instruments waiting for SRQ, the others are polled. */
+    size_t Waiting() const { return mWaiting.load(std::memory_order_relaxed); }
+
+    /* Append the events queued so far to events, oldest first. Returns their number. */
+    size_t TakeEvents(std::vector<ServiceRequestEvent>* events);
+    /* Events lost because the queue was full. */
+    uint64_t Dropped() const;
+
+private:
+    ServiceRequestWatcher(const ServiceRequestWatcher&);
+    ServiceRequestWatcher& operator=(const ServiceRequestWatcher&);
+
+    void Run(int device);
+    bool Stopping();
+    void Report(int device, uint8_t statusByte);
+
+    TransportKind                   mKind;
+    std::vector<std::string>        mResources;
+    uint8_t                         mServiceEnable;
+    StatusQuery                     mQuery;
+    void*                           mContext;
+    uint64_t                        mPoll;
+
+    mutable std::mutex              mMutex;
+    std::condition_variable         mWake;
+    std::vector<std::thread>        mThreads;
+    std::atomic<bool>               mRunning;
+    std::atomic<size_t>             mWaiting;
+    bool                            mStopping;
+
+    std::deque<ServiceRequestEvent> mEvents;
+    uint64_t                        mDropped;
+};
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file histogram.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Lock-free latency histogram with logarithmic buckets.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <string.h>
+
+#include "histogram.h"
+
+LatencySnapshot::LatencySnapshot()
+    : count(0),
+      sum(0),
+      min(UINT64_MAX),
+      max(0)
+{
+    memset(buckets, 0, sizeof(buckets));
+}
+
+int LatencySnapshot::BucketIndex(uint64_t nanoseconds)
+{
+    if (nanoseconds < (uint64_t)kSubBuckets)
+    {
+        return (int)nanoseconds;
+    }
+    int exponent = 63 - __builtin_clzll(nanoseconds);
+    if (exponent > kMaxExponent)
+    {
+        return kBucketCount - 1;
+    }
+    int sub = (int)((nanoseconds >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencySnapshot::BucketLow(int index)
+{
+    if (index < kSubBuckets)
+    {
+        return (uint64_t)index;
+    }
+    int exponent = index / kSubBuckets + kSubBucketBits - 1;
+    int sub = index % kSubBuckets;
+    return (uint64_t)(kSubBuckets + sub) << (exponent - kSubBucketBits);
+}
+
+uint64_t LatencySnapshot::BucketWidth(int index)
+{
+    if (index < kSubBuckets)
+    {
+        return 1;
+    }
+    return (uint64_t)1 << (index / kSubBuckets - 1);
+}
+
+uint64_t LatencySnapshot::Percentile(double percentile) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    /* Rank of the wanted sample, 1 based. */
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)count + 0.5);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            /* Middle of the bucket, but never outside the recorded range. */
+            uint64_t value = BucketLow(i) + BucketWidth(i) / 2;
+            if (value < min)
+            {
+                value = min;
+            }
+            if (value > max)
+            {
+                value = max;
+            }
+            return value;
+        }
+    }
+    return max;
+}
+
+double LatencySnapshot::Mean() const
+{
+    return count == 0 ? 0.0 : (double)sum / (double)count;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+void LatencyHistogram::Record(uint64_t nanoseconds)
+{
+    mBuckets[LatencySnapshot::BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    mSum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+
+    /* Extremes rarely change, so the compare and swap is rarely reached. */
+    uint64_t current = mMax.load(std::memory_order_relaxed);
+    while (nanoseconds > current && !mMax.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+    current = mMin.load(std::memory_order_relaxed);
+    while (nanoseconds < current && !mMin.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+void LatencyHistogram::Reset()
+{
+    /* Samples recorded while resetting may survive partly, that is accepted. */
+    mCount.store(0, std::memory_order_relaxed);
+    mSum.store(0, std::memory_order_relaxed);
+    mMin.store(UINT64_MAX, std::memory_order_relaxed);
+    mMax.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < LatencySnapshot::kBucketCount; i++)
+    {
+        mBuckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::AddTo(LatencySnapshot* snapshot) const
+{
+    uint64_t count = 0;
+    for (int i = 0; i < LatencySnapshot::kBucketCount; i++)
+    {
+        uint64_t value = mBuckets[i].load(std::memory_order_relaxed);
+        snapshot->buckets[i] += value;
+        count += value;
+    }
+    /* Counted from the buckets, so the percentiles are consistent with the count. */
+    snapshot->count += count;
+    snapshot->sum += mSum.load(std::memory_order_relaxed);
+
+    uint64_t min = mMin.load(std::memory_order_relaxed);
+    uint64_t max = mMax.load(std::memory_order_relaxed);
+    if (count > 0 && min < snapshot->min)
+    {
+        snapshot->min = min;
+    }
+    if (count > 0 && max > snapshot->max)
+    {
+        snapshot->max = max;
+    }
+}
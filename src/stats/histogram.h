@@ -0,0 +1,78 @@
+/**
+ * @file histogram.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Lock-free latency histogram with logarithmic buckets.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * Values are bucketed like in HdrHistogram: below 16 ns every nanosecond has
+ * its own bucket, above that every power of two is split into 16 buckets.
+ * Percentiles are therefore accurate to about 6 %, whatever the magnitude.
+ */
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <atomic>
+
+#define HISTOGRAM_CACHE_LINE 64
+
+/**
+ * @brief A point-in-time copy of one or more histograms, used for reporting.
+ */
+class LatencySnapshot
+{
+public:
+    static const int kSubBucketBits = 4;
+    static const int kSubBuckets    = 1 << kSubBucketBits;
+    static const int kMaxExponent   = 40; /* about 18 minutes, longer values share the last bucket */
+    static const int kBucketCount   = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    LatencySnapshot();
+
+    static int BucketIndex(uint64_t nanoseconds);
+    /* Smallest value of a bucket and the width of the bucket. */
+    static uint64_t BucketLow(int index);
+    static uint64_t BucketWidth(int index);
+
+    /* Value below which the given percentage (0 .. 100) of the samples are. */
+    uint64_t Percentile(double percentile) const;
+    double   Mean() const;
+
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[kBucketCount];
+};
+
+/**
+ * @brief Histogram that can be recorded into from any thread without locks.
+ *
+ * Every histogram starts on its own cache line, so histograms recorded by
+ * different threads do not share lines.
+ */
+class alignas(HISTOGRAM_CACHE_LINE) LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void Record(uint64_t nanoseconds);
+    void Reset();
+    /* Add the samples to a snapshot, so several histograms can be merged. */
+    void AddTo(LatencySnapshot* snapshot) const;
+
+private:
+    LatencyHistogram(const LatencyHistogram&);
+    LatencyHistogram& operator=(const LatencyHistogram&);
+
+    std::atomic<uint64_t> mCount;
+    std::atomic<uint64_t> mSum;
+    std::atomic<uint64_t> mMin;
+    std::atomic<uint64_t> mMax;
+    std::atomic<uint64_t> mBuckets[LatencySnapshot::kBucketCount];
+};
+
+#endif
@@ -0,0 +1,231 @@
+/**
+ * @file opstats.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Timing of the individual steps of an instrument exchange.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "histogram.h"
+#include "opstats.h"
+#include "tracer.h"
+
+#define ITECH_STATS_NAME_SIZE 128
+
+enum DeviceSlotState
+{
+    kDeviceSlotFree = 0,
+    kDeviceSlotClaimed, /* a thread is filling in the resource name */
+    kDeviceSlotReady
+};
+
+/**
+ * @brief Histograms of one instrument, one per step.
+ *
+ * Slot 0 collects the steps without an instrument (discovery, some log
+ * lines) and the instruments that did not get a slot of their own.
+ */
+struct alignas(HISTOGRAM_CACHE_LINE) DeviceStats
+{
+    std::atomic<int> state;
+    uint64_t         hash;
+    char             resource[ITECH_STATS_NAME_SIZE];
+    LatencyHistogram ops[kItechOpCount];
+};
+
+ItechOpObserver gItechOpObserver = nullptr;
+
+static DeviceStats gDevices[ITECH_STATS_MAX_DEVICES];
+
+static const char* const sOpNames[kItechOpCount] = {
+    "discover",
+    "open",
+    "write",
+    "read",
+    "parse",
+    "log",
+    "close",
+    "wait",
+};
+
+const char* ItechOpName(ItechOp op)
+{
+    return (op >= 0 && op < kItechOpCount) ? sOpNames[op] : "unknown";
+}
+
+uint64_t ItechNowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SetItechOpObserver(ItechOpObserver observer)
+{
+    gItechOpObserver = observer;
+}
+
+static uint64_t sHash(const char* text)
+{
+    /* FNV-1a */
+    uint64_t hash = 14695981039346656037ULL;
+    for (; *text != '\0'; text++)
+    {
+        hash ^= (uint8_t)*text;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+ * Slot of an instrument. Slots are claimed once and never given back, so
+ * lookups only need to read. Returns -1 if the instrument has no slot and
+ * create is false.
+ */
+static int sFindDevice(const char* resource, bool create)
+{
+    if (resource == nullptr || resource[0] == '\0')
+    {
+        return 0;
+    }
+
+    uint64_t hash = sHash(resource);
+    for (int i = 1; i < ITECH_STATS_MAX_DEVICES; i++)
+    {
+        DeviceStats& device = gDevices[i];
+        int state = device.state.load(std::memory_order_acquire);
+
+        if (state == kDeviceSlotFree)
+        {
+            if (!create)
+            {
+                return -1;
+            }
+            if (device.state.compare_exchange_strong(state, kDeviceSlotClaimed, std::memory_order_acq_rel))
+            {
+                device.hash = hash;
+                strncpy(device.resource, resource, ITECH_STATS_NAME_SIZE - 1);
+                device.resource[ITECH_STATS_NAME_SIZE - 1] = '\0';
+                device.state.store(kDeviceSlotReady, std::memory_order_release);
+                return i;
+            }
+        }
+        /* Another thread claimed the slot just now, wait for its name. */
+        while (device.state.load(std::memory_order_acquire) == kDeviceSlotClaimed)
+        {
+            std::this_thread::yield();
+        }
+        if (device.hash == hash && strncmp(device.resource, resource, ITECH_STATS_NAME_SIZE - 1) == 0)
+        {
+            return i;
+        }
+    }
+    return create ? 0 : -1;
+}
+
+void ItechStatsRecord(ItechOp op, const char* resource, uint64_t nanoseconds)
+{
+    if (op < 0 || op >= kItechOpCount)
+    {
+        return;
+    }
+    gDevices[sFindDevice(resource, true)].ops[op].Record(nanoseconds);
+}
+
+void ItechOpFinished(ItechOp op, const char* resource, uint64_t start, uint64_t nanoseconds)
+{
+    ItechStatsRecord(op, resource, nanoseconds);
+    if (TraceIsEnabled())
+    {
+        TraceCategory category = (op == kItechOpParse) ? kTraceParse
+                                 : (op == kItechOpLog) ? kTraceLog
+                                 : (op == kItechOpWait) ? kTraceQueue
+                                                        : kTraceIo;
+        TraceRecord(category, ItechOpName(op), resource, start, nanoseconds);
+    }
+}
+
+int ItechStatsGet(const char* resource, int op, double* values, int count)
+{
+    if (op >= kItechOpCount)
+    {
+        return ITECH_STATS_ERROR_OP;
+    }
+
+    int first = 0;
+    int last = ITECH_STATS_MAX_DEVICES - 1;
+    if (resource != nullptr && resource[0] != '\0')
+    {
+        first = last = sFindDevice(resource, false);
+        if (first < 0)
+        {
+            return ITECH_STATS_ERROR_DEVICE;
+        }
+    }
+
+    LatencySnapshot snapshot;
+    for (int i = first; i <= last; i++)
+    {
+        for (int j = 0; j < kItechOpCount; j++)
+        {
+            if (op < 0 || op == j)
+            {
+                gDevices[i].ops[j].AddTo(&snapshot);
+            }
+        }
+    }
+
+    double result[ITECH_STATS_VALUES];
+    result[0] = (double)snapshot.count;
+    result[1] = (snapshot.count == 0) ? 0.0 : (double)snapshot.min / 1000.0;
+    result[2] = snapshot.Mean() / 1000.0;
+    result[3] = (double)snapshot.Percentile(50.0) / 1000.0;
+    result[4] = (double)snapshot.Percentile(90.0) / 1000.0;
+    result[5] = (double)snapshot.Percentile(99.0) / 1000.0;
+    result[6] = (double)snapshot.Percentile(99.9) / 1000.0;
+    result[7] = (double)snapshot.max / 1000.0;
+
+    if (count > ITECH_STATS_VALUES)
+    {
+        count = ITECH_STATS_VALUES;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = result[i];
+    }
+    return count < 0 ? 0 : count;
+}
+
+int ItechStatsDevice(int index, char* resource, int size)
+{
+    /* Slot 0 has no name, named instruments start at slot 1. */
+    if (index < 0 || index >= ITECH_STATS_MAX_DEVICES - 1 || size <= 0)
+    {
+        return 0;
+    }
+    DeviceStats& device = gDevices[index + 1];
+    if (device.state.load(std::memory_order_acquire) != kDeviceSlotReady)
+    {
+        return 0;
+    }
+    strncpy(resource, device.resource, size - 1);
+    resource[size - 1] = '\0';
+    return 1;
+}
+
+void ItechStatsReset()
+{
+    for (int i = 0; i < ITECH_STATS_MAX_DEVICES; i++)
+    {
+        for (int j = 0; j < kItechOpCount; j++)
+        {
+            gDevices[i].ops[j].Reset();
+        }
+    }
+}
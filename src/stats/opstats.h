@@ -0,0 +1,113 @@
+/**
+ * @file opstats.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Timing of the individual steps of an instrument exchange.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * Every step is always timed and recorded into a latency histogram per
+ * instrument and step, which CAPL reads through dllItechGetStats.
+ */
+#ifndef OPSTATS_H
+#define OPSTATS_H
+
+#include <stdint.h>
+
+/**
+ * @brief The steps an ItechDcPower* call is made of.
+ */
+enum ItechOp
+{
+    kItechOpDiscover = 0, /* viFindRsrc and friends      */
+    kItechOpOpen,         /* viOpenDefaultRM, viOpen     */
+    kItechOpWrite,        /* viWrite                     */
+    kItechOpRead,         /* viRead                      */
+    kItechOpParse,        /* reply to number conversion  */
+    kItechOpLog,          /* minilogger                  */
+    kItechOpClose,        /* viClose                     */
+    kItechOpWait,         /* waiting for the device lock */
+    kItechOpCount
+};
+
+/* Instruments with statistics of their own, later ones share the first slot. */
+#define ITECH_STATS_MAX_DEVICES 16
+/* Values returned by ItechStatsGet: count, min, mean, p50, p90, p99, p99.9, max (us). */
+#define ITECH_STATS_VALUES 8
+/* ItechStatsGet error codes */
+#define ITECH_STATS_ERROR_DEVICE (-1)
+#define ITECH_STATS_ERROR_OP     (-2)
+
+const char* ItechOpName(ItechOp op);
+
+/* Monotonic time in nanoseconds. */
+uint64_t ItechNowNs();
+
+/**
+ * @brief Receives the duration of every step.
+ *
+ * resource is the instrument the step worked on, nullptr for discovery.
+ */
+typedef void (*ItechOpObserver)(ItechOp op, const char* resource, uint64_t nanoseconds);
+
+/* Install an observer, nullptr removes it. */
+void SetItechOpObserver(ItechOpObserver observer);
+
+extern ItechOpObserver gItechOpObserver;
+
+/* Add one duration to the histogram of the instrument and step. */
+void ItechStatsRecord(ItechOp op, const char* resource, uint64_t nanoseconds);
+
+/* A step ended: record it into the statistics and, if tracing, the trace. */
+void ItechOpFinished(ItechOp op, const char* resource, uint64_t start, uint64_t nanoseconds);
+
+/*
+ * Statistics of one step (op < 0: all steps) of one instrument ("": all
+ * instruments) in microseconds, see ITECH_STATS_VALUES. Up to count values
+ * are written, the number written is returned or a negative error code.
+ */
+int ItechStatsGet(const char* resource, int op, double* values, int count);
+
+/*
+ * Resource name of the index-th instrument with statistics. Returns 1 if
+ * there is one, else 0.
+ */
+int ItechStatsDevice(int index, char* resource, int size);
+
+/* Forget all samples, e.g. at the start of a testcase. */
+void ItechStatsReset();
+
+/**
+ * @brief Times the enclosing scope into the statistics, the trace and the observer.
+ */
+class ItechOpScope
+{
+public:
+    ItechOpScope(ItechOp op, const char* resource)
+        : mOp(op),
+          mResource(resource),
+          mStart(ItechNowNs())
+    {
+    }
+
+    ~ItechOpScope()
+    {
+        uint64_t elapsed = ItechNowNs() - mStart;
+        ItechOpFinished(mOp, mResource, mStart, elapsed);
+        if (gItechOpObserver != nullptr)
+        {
+            gItechOpObserver(mOp, mResource, elapsed);
+        }
+    }
+
+private:
+    ItechOpScope(const ItechOpScope&);
+    ItechOpScope& operator=(const ItechOpScope&);
+
+    ItechOp     mOp;
+    const char* mResource;
+    uint64_t    mStart;
+};
+
+#endif
@@ -0,0 +1,302 @@
+/**
+ * @file tracer.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Timeline of CAPL calls and instrument I/O in Chrome trace_event format.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tracer.h"
+
+/**
+ * @brief One complete ("X") event.
+ */
+struct TraceEvent
+{
+    std::atomic<bool> committed; /* all fields are written */
+    uint8_t           category;
+    uint32_t          thread;
+    const char*       name;
+    uint64_t          start;
+    uint64_t          duration;
+    char              detail[TRACE_DETAIL_SIZE];
+};
+
+/**
+ * @brief The preallocated event buffer, filled by any number of threads.
+ */
+struct TraceBuffer
+{
+    explicit TraceBuffer(uint32_t size)
+        : events(new (std::nothrow) TraceEvent[size]),
+          capacity(events != nullptr ? size : 0),
+          next(0),
+          dropped(0),
+          writers(0)
+    {
+        Clear();
+    }
+
+    ~TraceBuffer()
+    {
+        delete[] events;
+    }
+
+    void Clear()
+    {
+        for (uint32_t i = 0; i < capacity; i++)
+        {
+            events[i].committed.store(false, std::memory_order_relaxed);
+        }
+        next.store(0, std::memory_order_relaxed);
+        dropped.store(0, std::memory_order_relaxed);
+    }
+
+    TraceEvent*           events;
+    uint32_t              capacity;
+    std::atomic<uint32_t> next;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint32_t> writers; /* TraceRecord calls between their check and their commit */
+};
+
+static const char* const sCategoryNames[kTraceCategoryCount] = {
+    "capl",
+    "queue",
+    "io",
+    "parse",
+    "log",
+    "callback",
+};
+
+std::atomic<bool> gTraceEnabled(false);
+
+static std::atomic<TraceBuffer*> gTraceBuffer(nullptr);
+/* Replaced buffers, a late writer may still use them, freed at unload. */
+static std::vector<TraceBuffer*> gRetiredBuffers;
+static std::mutex                gControlMutex;
+static std::string               gTracePath;
+static uint64_t                  gTraceOrigin;
+static std::atomic<uint32_t>     gNextThread(1);
+
+/* Frees the buffers when the dll is unloaded. */
+static struct TraceCleanup
+{
+    ~TraceCleanup()
+    {
+        delete gTraceBuffer.load();
+        for (size_t i = 0; i < gRetiredBuffers.size(); i++)
+        {
+            delete gRetiredBuffers[i];
+        }
+    }
+} sTraceCleanup;
+
+static uint32_t sThreadId()
+{
+    static thread_local uint32_t threadId = 0;
+    if (threadId == 0)
+    {
+        threadId = gNextThread.fetch_add(1, std::memory_order_relaxed);
+    }
+    return threadId;
+}
+
+void TraceRecord(TraceCategory category, const char* name, const char* detail, uint64_t start, uint64_t duration)
+{
+    if (!TraceIsEnabled())
+    {
+        return;
+    }
+    TraceBuffer* buffer = gTraceBuffer.load(std::memory_order_acquire);
+    if (buffer == nullptr)
+    {
+        return;
+    }
+
+    /*
+     * Count as a writer, then look again: TraceStart disables first and
+     * waits for the writers before clearing the buffer, so a writer either
+     * sees the trace off or finishes its event before the clear.
+     */
+    buffer->writers.fetch_add(1, std::memory_order_seq_cst);
+    if (!gTraceEnabled.load(std::memory_order_seq_cst))
+    {
+        buffer->writers.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    uint32_t index = buffer->next.fetch_add(1, std::memory_order_relaxed);
+    if (index >= buffer->capacity)
+    {
+        buffer->next.store(buffer->capacity, std::memory_order_relaxed); /* keep the index from wrapping */
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        buffer->writers.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    TraceEvent& event = buffer->events[index];
+    event.category = (uint8_t)category;
+    event.thread = sThreadId();
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    if (detail != nullptr)
+    {
+        strncpy(event.detail, detail, TRACE_DETAIL_SIZE - 1);
+        event.detail[TRACE_DETAIL_SIZE - 1] = '\0';
+    }
+    else
+    {
+        event.detail[0] = '\0';
+    }
+    event.committed.store(true, std::memory_order_release);
+    buffer->writers.fetch_sub(1, std::memory_order_release);
+}
+
+int TraceStart(const char* path, uint32_t capacity)
+{
+    std::lock_guard<std::mutex> lock(gControlMutex);
+
+    if (capacity == 0)
+    {
+        capacity = TRACE_DEFAULT_CAPACITY;
+    }
+
+    gTraceEnabled.store(false, std::memory_order_seq_cst);
+    TraceBuffer* buffer = gTraceBuffer.load(std::memory_order_acquire);
+    if (buffer != nullptr && buffer->capacity == capacity)
+    {
+        /* A writer that saw the trace enabled may still be filling its slot. */
+        while (buffer->writers.load(std::memory_order_acquire) != 0)
+        {
+            std::this_thread::yield();
+        }
+        buffer->Clear();
+    }
+    else
+    {
+        TraceBuffer* created = new (std::nothrow) TraceBuffer(capacity);
+        if (created == nullptr || created->capacity == 0)
+        {
+            delete created;
+            return -1;
+        }
+        if (buffer != nullptr)
+        {
+            gRetiredBuffers.push_back(buffer);
+        }
+        gTraceBuffer.store(created, std::memory_order_release);
+    }
+
+    gTracePath = (path != nullptr) ? path : "";
+    gTraceOrigin = ItechNowNs();
+    gTraceEnabled.store(true, std::memory_order_release);
+    return 0;
+}
+
+int TraceStop()
+{
+    int written = 0;
+    if (TraceIsEnabled())
+    {
+        written = TraceDump(nullptr);
+    }
+    gTraceEnabled.store(false, std::memory_order_relaxed);
+    return written;
+}
+
+uint64_t TraceDropped()
+{
+    TraceBuffer* buffer = gTraceBuffer.load(std::memory_order_acquire);
+    return buffer == nullptr ? 0 : buffer->dropped.load(std::memory_order_relaxed);
+}
+
+static void sWriteEscaped(FILE* file, const char* text)
+{
+    for (; *text != '\0'; text++)
+    {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\')
+        {
+            fprintf(file, "\\%c", c);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(file, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, file);
+        }
+    }
+}
+
+int TraceDump(const char* path)
+{
+    std::lock_guard<std::mutex> lock(gControlMutex);
+
+    std::string target = (path != nullptr && path[0] != '\0') ? std::string(path) : gTracePath;
+    if (target.empty())
+    {
+        return 0;
+    }
+    TraceBuffer* buffer = gTraceBuffer.load(std::memory_order_acquire);
+    if (buffer == nullptr)
+    {
+        return 0;
+    }
+
+    FILE* file = fopen(target.c_str(), "w");
+    if (file == nullptr)
+    {
+        return -1;
+    }
+
+    uint32_t count = buffer->next.load(std::memory_order_acquire);
+    if (count > buffer->capacity)
+    {
+        count = buffer->capacity;
+    }
+
+    /* Timestamps are microseconds since TraceStart, with nanosecond digits. */
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"capl.dll\"}}");
+    int written = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const TraceEvent& event = buffer->events[i];
+        if (!event.committed.load(std::memory_order_acquire))
+        {
+            continue; /* still being written */
+        }
+        double start = (event.start >= gTraceOrigin) ? (double)(event.start - gTraceOrigin) / 1000.0 : 0.0;
+        fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                event.name, sCategoryNames[event.category], event.thread, start, (double)event.duration / 1000.0);
+        if (event.detail[0] != '\0')
+        {
+            fprintf(file, ",\"args\":{\"detail\":\"");
+            sWriteEscaped(file, event.detail);
+            fprintf(file, "\"}");
+        }
+        fprintf(file, "}");
+        written++;
+    }
+    fprintf(file, "\n],\"otherData\":{\"dropped\":%llu}}\n",
+            (unsigned long long)buffer->dropped.load(std::memory_order_relaxed));
+
+    if (fclose(file) != 0)
+    {
+        return -1;
+    }
+    return written;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file tracer.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Timeline of CAPL calls and instrument I/O in Chrome trace_event format.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * While tracing, every timed scope is stored as a complete event in a buffer
+ * allocated by TraceStart. Nothing is allocated or written to disk while
+ * recording; a full buffer drops further events. TraceDump writes the events
+ * as JSON that chrome://tracing and Perfetto open. While tracing is off a
+ * scope costs one branch.
+ */
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "opstats.h"
+
+/* Events kept by TraceStart when no capacity is given. */
+#define TRACE_DEFAULT_CAPACITY 65536
+/* Characters of the detail text (resource, command) kept per event. */
+#define TRACE_DETAIL_SIZE 48
+
+/**
+ * @brief What a traced scope was doing, shown as the event category.
+ */
+enum TraceCategory
+{
+    kTraceCapl = 0, /* a CAPL function of the dll, entry to return */
+    kTraceQueue,    /* waiting for the lock of an instrument       */
+    kTraceIo,       /* discover, open, write, read, close          */
+    kTraceParse,    /* reply to number conversion                  */
+    kTraceLog,      /* minilogger                                  */
+    kTraceCallback, /* call of a CAPL callback                     */
+    kTraceCategoryCount
+};
+
+extern std::atomic<bool> gTraceEnabled;
+
+static inline bool TraceIsEnabled()
+{
+    return gTraceEnabled.load(std::memory_order_relaxed);
+}
+
+/*
+ * Start tracing into a buffer of capacity events (0: TRACE_DEFAULT_CAPACITY),
+ * dropping the events recorded so far. path is where TraceStop and appEnd
+ * write the events, nullptr or "" for nowhere. Returns 0 or -1 if the buffer
+ * could not be allocated.
+ */
+int TraceStart(const char* path, uint32_t capacity);
+
+/* Write the events to the path given to TraceStart and stop tracing. */
+int TraceStop();
+
+/*
+ * Write the events recorded so far as trace_event JSON. nullptr or "" writes
+ * to the path given to TraceStart. Returns the number of events written or
+ * -1 if the file could not be written.
+ */
+int TraceDump(const char* path);
+
+/* Number of events dropped because the buffer was full. */
+uint64_t TraceDropped();
+
+/*
+ * Store one event. name must stay valid until the dump (a string literal),
+ * detail is copied. Does nothing while tracing is off.
+ */
+void TraceRecord(TraceCategory category, const char* name, const char* detail, uint64_t start, uint64_t duration);
+
+/**
+ * @brief Traces the enclosing scope as one event.
+ */
+class TraceScope
+{
+public:
+    TraceScope(TraceCategory category, const char* name, const char* detail)
+        : mCategory(category),
+          mName(name),
+          mDetail(detail),
+          mStart(TraceIsEnabled() ? ItechNowNs() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (mStart != 0)
+        {
+            TraceRecord(mCategory, mName, mDetail, mStart, ItechNowNs() - mStart);
+        }
+    }
+
+private:
+    TraceScope(const TraceScope&);
+    TraceScope& operator=(const TraceScope&);
+
+    TraceCategory mCategory;
+    const char*   mName;
+    const char*   mDetail;
+    uint64_t      mStart;
+};
+
+#endif
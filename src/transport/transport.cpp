@@ -0,0 +1,266 @@
+/**
+ * @file transport.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Backend independent part of the transport: statistics and factory.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <string.h>
+#include <new>
+
+#include "transport.h"
+#include "opstats.h"
+#include "flightrec.h"
+#include "visatransport.h"
+
+static TransportFactory gTransportFactory = nullptr;
+
+Transport::Transport()
+    : mOpen(false),
+      mRecorder(nullptr)
+{
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+Transport::~Transport()
+{
+}
+
+TransportStatus Transport::Count(TransportStatus status)
+{
+    if (status < kTransportOk)
+    {
+        mStats.errors++;
+    }
+    return status;
+}
+
+TransportStatus Transport::Discover(std::vector<std::string>* resources)
+{
+    ItechOpScope scope(kItechOpDiscover, nullptr);
+    uint64_t start = ItechNowNs();
+    mStats.discoveries++;
+    resources->clear();
+    TransportStatus status = Count(DoDiscover(resources));
+    FlightRecord(FlightRecorderRing(nullptr), kFlightDiscover, status, start, ItechNowNs() - start, nullptr, 0);
+    return status;
+}
+
+TransportStatus Transport::Open(const char* resource)
+{
+    if (mOpen)
+    {
+        Close();
+    }
+
+    ItechOpScope scope(kItechOpOpen, resource);
+    uint64_t start = ItechNowNs();
+    mStats.opens++;
+    TransportStatus status = Count(DoOpen(resource));
+    if (status >= kTransportOk)
+    {
+        mResource = resource;
+        mOpen = true;
+    }
+    mRecorder = FlightRecorderRing(resource);
+    FlightRecord(mRecorder, kFlightOpen, status, start, ItechNowNs() - start, nullptr, 0);
+    return status;
+}
+
+TransportStatus Transport::Write(const char* data, size_t length)
+{
+    if (!mOpen)
+    {
+        return Count(kTransportErrorClosed);
+    }
+
+    ItechOpScope scope(kItechOpWrite, mResource.c_str());
+    uint64_t start = ItechNowNs();
+    size_t written = 0;
+    mStats.writes++;
+    TransportStatus status = Count(DoWrite(data, length, &written));
+    mStats.bytesWritten += written;
+    FlightRecord(mRecorder, kFlightWrite, status, start, ItechNowNs() - start, data, length);
+    return status;
+}
+
+TransportStatus Transport::ReadUntil(char* buffer, size_t capacity, char termChar, size_t* count)
+{
+    *count = 0;
+    if (!mOpen)
+    {
+        return Count(kTransportErrorClosed);
+    }
+
+    ItechOpScope scope(kItechOpRead, mResource.c_str());
+    uint64_t start = ItechNowNs();
+    mStats.reads++;
+    TransportStatus status = Count(DoReadUntil(buffer, capacity, termChar, count));
+    mStats.bytesRead += *count;
+    FlightRecord(mRecorder, kFlightRead, status, start, ItechNowNs() - start, buffer, *count);
+    return status;
+}
+
+TransportStatus Transport::Read(char* buffer, size_t length, size_t* count)
+{
+    *count = 0;
+    if (!mOpen)
+    {
+        return Count(kTransportErrorClosed);
+    }
+
+    ItechOpScope scope(kItechOpRead, mResource.c_str());
+    uint64_t start = ItechNowNs();
+    mStats.reads++;
+    TransportStatus status = Count(DoRead(buffer, length, count));
+    mStats.bytesRead += *count;
+    FlightRecord(mRecorder, kFlightRead, status, start, ItechNowNs() - start, buffer, *count);
+    return status;
+}
+
+TransportStatus Transport::Flush()
+{
+    if (!mOpen)
+    {
+        return Count(kTransportErrorClosed);
+    }
+
+    uint64_t start = ItechNowNs();
+    mStats.flushes++;
+    TransportStatus status = Count(DoFlush());
+    FlightRecord(mRecorder, kFlightFlush, status, start, ItechNowNs() - start, nullptr, 0);
+    return status;
+}
+
+TransportStatus Transport::Close()
+{
+    if (!mOpen)
+    {
+        return kTransportOk;
+    }
+
+    ItechOpScope scope(kItechOpClose, mResource.c_str());
+    uint64_t start = ItechNowNs();
+    mOpen = false;
+    mStats.closes++;
+    TransportStatus status = Count(DoClose());
+    FlightRecord(mRecorder, kFlightClose, status, start, ItechNowNs() - start, nullptr, 0);
+    return status;
+}
+
+TransportStatus Transport::SetTimeout(uint32_t timeoutMs, uint32_t* previous)
+{
+    if (!mOpen)
+    {
+        return Count(kTransportErrorClosed);
+    }
+    TransportStatus status = DoSetTimeout(timeoutMs, previous);
+    return status == kTransportErrorNotSupported ? status : Count(status);
+}
+
+TransportStatus Transport::EnableServiceRequest()
+{
+    if (!mOpen)
+    {
+        return Count(kTransportErrorClosed);
+    }
+    /* not supported is an answer here, not an error */
+    TransportStatus status = DoEnableServiceRequest();
+    return status == kTransportErrorNotSupported ? status : Count(status);
+}
+
+TransportStatus Transport::WaitServiceRequest(uint32_t timeoutMs)
+{
+    if (!mOpen)
+    {
+        return Count(kTransportErrorClosed);
+    }
+
+    /* Waiting is no I/O step: only a request or a failure is recorded, a timeout is the normal case. */
+    uint64_t start = ItechNowNs();
+    TransportStatus status = DoWaitServiceRequest(timeoutMs);
+    if (status == kTransportErrorTimeout)
+    {
+        return status;
+    }
+    if (status >= kTransportOk)
+    {
+        mStats.serviceRequests++;
+    }
+    FlightRecord(mRecorder, kFlightServiceRequest, Count(status), start, ItechNowNs() - start, nullptr, 0);
+    return status;
+}
+
+TransportStatus Transport::ReadStatusByte(uint8_t* status)
+{
+    *status = 0;
+    if (!mOpen)
+    {
+        return Count(kTransportErrorClosed);
+    }
+
+    uint64_t start = ItechNowNs();
+    TransportStatus result = Count(DoReadStatusByte(status));
+    FlightRecord(mRecorder, kFlightStatusByte, result, start, ItechNowNs() - start, (const char*)status,
+                 result >= kTransportOk ? 1 : 0);
+    return result;
+}
+
+/* A backend without timeouts of its own, e.g. one that never blocks. */
+TransportStatus Transport::DoRead(char* buffer, size_t length, size_t* count)
+{
+    (void)buffer;
+    (void)length;
+    (void)count;
+    return kTransportErrorNotSupported;
+}
+
+TransportStatus Transport::DoSetTimeout(uint32_t timeoutMs, uint32_t* previous)
+{
+    (void)timeoutMs;
+    (void)previous;
+    return kTransportErrorNotSupported;
+}
+
+TransportStatus Transport::DoEnableServiceRequest()
+{
+    return kTransportErrorNotSupported;
+}
+
+TransportStatus Transport::DoWaitServiceRequest(uint32_t timeoutMs)
+{
+    (void)timeoutMs;
+    return kTransportErrorNotSupported;
+}
+
+TransportStatus Transport::DoReadStatusByte(uint8_t* status)
+{
+    (void)status;
+    return kTransportErrorNotSupported;
+}
+
+void SetTransportFactory(TransportFactory factory)
+{
+    gTransportFactory = factory;
+}
+
+Transport* CreateTransport(TransportKind kind)
+{
+    if (gTransportFactory != nullptr)
+    {
+        return gTransportFactory(kind);
+    }
+
+    switch (kind)
+    {
+    case kTransportUsb:
+        return new (std::nothrow) VisaUsbTransport();
+    case kTransportSerial:
+        return new (std::nothrow) VisaSerialTransport();
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * @file transport.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Byte transport shared by the USB, serial and future ITECH DC power backends.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct FlightRing;
+
+/*
+ * Status codes follow the VISA convention: everything below zero is an error.
+ * The values are identical to their VISA counterparts so that a VISA backend
+ * can pass ViStatus through unchanged and non-VISA backends stay comparable.
+ */
+typedef int32_t TransportStatus;
+
+const TransportStatus kTransportOk            = 0;
+const TransportStatus kTransportErrorClosed   = (TransportStatus)0xBFFF000E; /* VI_ERROR_INV_OBJECT  */
+const TransportStatus kTransportErrorAbort    = (TransportStatus)0xBFFF0010; /* VI_ERROR_ABORT       */
+const TransportStatus kTransportErrorNotFound = (TransportStatus)0xBFFF0011; /* VI_ERROR_RSRC_NFOUND */
+const TransportStatus kTransportErrorTimeout  = (TransportStatus)0xBFFF0015; /* VI_ERROR_TMO         */
+const TransportStatus kTransportErrorIo       = (TransportStatus)0xBFFF003E; /* VI_ERROR_IO          */
+const TransportStatus kTransportErrorNotSupported = (TransportStatus)0xBFFF0067; /* VI_ERROR_NSUP_OPER */
+
+/**
+ * @brief The backends the ItechDcPower* functions can ask for.
+ */
+enum TransportKind
+{
+    kTransportUsb    = 0, /* VISA USBTMC, every "USB?*INSTR" resource */
+    kTransportSerial = 1, /* VISA ASRL, the fixed COM port            */
+    kTransportKindCount
+};
+
+/**
+ * @brief Counters kept for every transport instance.
+ */
+struct TransportStats
+{
+    uint64_t discoveries;
+    uint64_t opens;
+    uint64_t closes;
+    uint64_t writes;
+    uint64_t reads;
+    uint64_t flushes;
+    uint64_t bytesWritten;
+    uint64_t bytesRead;
+    uint64_t serviceRequests;
+    uint64_t errors;
+};
+
+/**
+ * @brief Abstract byte transport to one instrument at a time.
+ *
+ * The public methods are not virtual: they keep the statistics and then call
+ * the protected Do* hooks a backend implements. Anything that has to happen
+ * for every backend (counting, timing, tracing, flight recording) belongs in
+ * the public layer.
+ */
+class Transport
+{
+public:
+    Transport();
+    virtual ~Transport();
+
+    /* List the resources this backend can open. */
+    TransportStatus Discover(std::vector<std::string>* resources);
+    TransportStatus Open(const char* resource);
+    TransportStatus Write(const char* data, size_t length);
+    /* Read until termChar is received, the buffer is full or a timeout occurs. */
+    TransportStatus ReadUntil(char* buffer, size_t capacity, char termChar, size_t* count);
+    /*
+     * Read exactly length bytes whatever they are, the body of a binary
+     * block. A termination character in the data does not end the read.
+     */
+    TransportStatus Read(char* buffer, size_t length, size_t* count);
+    /* Discard whatever is left in the receive and transmit buffers. */
+    TransportStatus Flush();
+    TransportStatus Close();
+    /* Timeout of the reads from now on, previous receives the one before. */
+    TransportStatus SetTimeout(uint32_t timeoutMs, uint32_t* previous);
+
+    /*
+     * Service requests (SRQ) of the open instrument. Once enabled,
+     * WaitServiceRequest returns kTransportOk when the instrument asked for
+     * service and kTransportErrorTimeout otherwise; ReadStatusByte then tells
+     * why and clears the request. A backend without SRQ returns
+     * kTransportErrorNotSupported, the caller polls "*STB?" instead.
+     */
+    TransportStatus EnableServiceRequest();
+    TransportStatus WaitServiceRequest(uint32_t timeoutMs);
+    TransportStatus ReadStatusByte(uint8_t* status);
+
+    bool IsOpen() const { return mOpen; }
+    const char* Resource() const { return mResource.c_str(); }
+    const TransportStats& Stats() const { return mStats; }
+
+    /* Termination appended to every command written by the SCPI layer. */
+    virtual const char* CommandTerminator() const = 0;
+
+protected:
+    virtual TransportStatus DoDiscover(std::vector<std::string>* resources) = 0;
+    virtual TransportStatus DoOpen(const char* resource) = 0;
+    virtual TransportStatus DoWrite(const char* data, size_t length, size_t* written) = 0;
+    virtual TransportStatus DoReadUntil(char* buffer, size_t capacity, char termChar, size_t* count) = 0;
+    virtual TransportStatus DoFlush() = 0;
+    virtual TransportStatus DoClose() = 0;
+    virtual TransportStatus DoRead(char* buffer, size_t length, size_t* count);
+    virtual TransportStatus DoSetTimeout(uint32_t timeoutMs, uint32_t* previous);
+    virtual TransportStatus DoEnableServiceRequest();
+    virtual TransportStatus DoWaitServiceRequest(uint32_t timeoutMs);
+    virtual TransportStatus DoReadStatusByte(uint8_t* status);
+
+private:
+    Transport(const Transport&);
+    Transport& operator=(const Transport&);
+
+    TransportStatus Count(TransportStatus status);
+
+    TransportStats mStats;
+    std::string    mResource;
+    bool           mOpen;
+    FlightRing*    mRecorder; /* flight recorder ring of the open instrument */
+};
+
+/**
+ * @brief Creates the transport used for a backend kind.
+ *
+ * Returns nullptr if the backend is not available. The caller owns the
+ * returned object.
+ */
+typedef Transport* (*TransportFactory)(TransportKind kind);
+
+/* Replace the backend factory, nullptr restores the VISA backends. */
+void SetTransportFactory(TransportFactory factory);
+Transport* CreateTransport(TransportKind kind);
+
+#endif
@@ -0,0 +1,314 @@
+/**
+ * @file visatransport.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief VISA implementations of the transport: USBTMC and ASRL (RS232).
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include "visatransport.h"
+
+VisaTransport::VisaTransport()
+    : mDefaultRM(VI_NULL),
+      mInstr(VI_NULL),
+      mTermChar(-1)
+{
+}
+
+VisaTransport::~VisaTransport()
+{
+    Close();
+    if (mDefaultRM != VI_NULL)
+    {
+        viClose(mDefaultRM);
+    }
+}
+
+ViStatus VisaTransport::OpenResourceManager()
+{
+    if (mDefaultRM != VI_NULL)
+    {
+        return VI_SUCCESS;
+    }
+
+    /*
+     * First we must call viOpenDefaultRM to get the manager
+     * handle.  We will store this handle in mDefaultRM.
+     */
+    ViStatus status = viOpenDefaultRM(&mDefaultRM);
+    if (status < VI_SUCCESS)
+    {
+        mDefaultRM = VI_NULL;
+    }
+    return status;
+}
+
+TransportStatus VisaTransport::DoOpen(const char* resource)
+{
+    ViStatus status = OpenResourceManager();
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+
+    /*
+     * The AccessMode and Timeout parameters in this function are
+     * reserved for future functionality.  These two parameters are
+     * given the value VI_NULL.
+     */
+    status = viOpen(mDefaultRM, (ViConstRsrc)resource, VI_NULL, VI_NULL, &mInstr);
+    if (status < VI_SUCCESS)
+    {
+        mInstr = VI_NULL;
+        return status;
+    }
+
+    mTermChar = -1;
+    status = Configure();
+    if (status < VI_SUCCESS)
+    {
+        viClose(mInstr);
+        mInstr = VI_NULL;
+    }
+    return status;
+}
+
+ViStatus VisaTransport::Configure()
+{
+    return VI_SUCCESS;
+}
+
+TransportStatus VisaTransport::DoWrite(const char* data, size_t length, size_t* written)
+{
+    ViUInt32 writeCount = 0;
+    ViStatus status = viWrite(mInstr, (ViBuf)data, (ViUInt32)length, &writeCount);
+    *written = writeCount;
+    return status;
+}
+
+TransportStatus VisaTransport::DoReadUntil(char* buffer, size_t capacity, char termChar, size_t* count)
+{
+    ViStatus status;
+
+    /*
+     * Let VISA stop the read on the termination character. The attribute is
+     * only touched when the requested character changes.
+     */
+    if (mTermChar != (unsigned char)termChar)
+    {
+        status = viSetAttribute(mInstr, VI_ATTR_TERMCHAR, (unsigned char)termChar);
+        if (status < VI_SUCCESS)
+        {
+            return status;
+        }
+        status = viSetAttribute(mInstr, VI_ATTR_TERMCHAR_EN, VI_TRUE);
+        if (status < VI_SUCCESS)
+        {
+            return status;
+        }
+        mTermChar = (unsigned char)termChar;
+    }
+
+    ViUInt32 retCount = 0;
+    status = viRead(mInstr, (ViBuf)buffer, (ViUInt32)capacity, &retCount);
+    *count = retCount;
+    return status;
+}
+
+TransportStatus VisaTransport::DoRead(char* buffer, size_t length, size_t* count)
+{
+    /*
+     * A line feed in the data must not end the read. The next ReadUntil
+     * finds mTermChar unknown and enables the character again.
+     */
+    mTermChar = -1;
+    ViStatus status = viSetAttribute(mInstr, VI_ATTR_TERMCHAR_EN, VI_FALSE);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+
+    /* a USBTMC transfer may end before length, read on until it is there */
+    size_t total = 0;
+    while (total < length)
+    {
+        ViUInt32 retCount = 0;
+        status = viRead(mInstr, (ViBuf)(buffer + total), (ViUInt32)(length - total), &retCount);
+        total += retCount;
+        if (status < VI_SUCCESS)
+        {
+            break;
+        }
+        if (retCount == 0)
+        {
+            status = VI_ERROR_IO;
+            break;
+        }
+    }
+    *count = total;
+    return status < VI_SUCCESS ? status : VI_SUCCESS;
+}
+
+TransportStatus VisaTransport::DoFlush()
+{
+    return viFlush(mInstr, VI_READ_BUF_DISCARD | VI_WRITE_BUF_DISCARD);
+}
+
+TransportStatus VisaTransport::DoClose()
+{
+    ViStatus status = viClose(mInstr);
+    mInstr = VI_NULL;
+    return status;
+}
+
+TransportStatus VisaTransport::DoSetTimeout(uint32_t timeoutMs, uint32_t* previous)
+{
+    ViUInt32 current = 0;
+    ViStatus status = viGetAttribute(mInstr, VI_ATTR_TMO_VALUE, &current);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+    *previous = current;
+    return viSetAttribute(mInstr, VI_ATTR_TMO_VALUE, timeoutMs);
+}
+
+/* A serial poll on USBTMC, VISA sends "*STB?" on RS232. */
+TransportStatus VisaTransport::DoReadStatusByte(uint8_t* status)
+{
+    ViUInt16 statusByte = 0;
+    ViStatus result = viReadSTB(mInstr, &statusByte);
+    *status = (uint8_t)statusByte;
+    return result;
+}
+
+TransportStatus VisaUsbTransport::DoEnableServiceRequest()
+{
+    /* Queue the requests, viWaitOnEvent picks them up. */
+    ViStatus status = viEnableEvent(mInstr, VI_EVENT_SERVICE_REQ, VI_QUEUE, VI_NULL);
+    if (status == VI_ERROR_INV_EVENT || status == VI_ERROR_INV_MECH)
+    {
+        return kTransportErrorNotSupported;
+    }
+    return status;
+}
+
+TransportStatus VisaUsbTransport::DoWaitServiceRequest(uint32_t timeoutMs)
+{
+    ViEventType eventType;
+    ViEvent event;
+    ViStatus status = viWaitOnEvent(mInstr, VI_EVENT_SERVICE_REQ, timeoutMs, &eventType, &event);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+    viClose(event);
+    return VI_SUCCESS;
+}
+
+TransportStatus VisaUsbTransport::DoDiscover(std::vector<std::string>* resources)
+{
+    ViStatus status = OpenResourceManager();
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+
+    /* Find all the USB TMC VISA resources in our system. */
+    ViFindList findList;
+    ViUInt32 numInstrs = 0;
+    char instrResourceString[VI_FIND_BUFLEN];
+
+    status = viFindRsrc(mDefaultRM, "USB?*INSTR", &findList, &numInstrs, instrResourceString);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+
+    for (ViUInt32 i = 0; i < numInstrs; i++)
+    {
+        if (i > 0)
+        {
+            viFindNext(findList, instrResourceString);
+        }
+        resources->push_back(instrResourceString);
+    }
+    viClose(findList);
+
+    return VI_SUCCESS;
+}
+
+TransportStatus VisaSerialTransport::DoDiscover(std::vector<std::string>* resources)
+{
+    /* The supply is expected on the first serial port (COM1). */
+    resources->push_back("ASRL1::INSTR");
+    return VI_SUCCESS;
+}
+
+ViStatus VisaSerialTransport::Configure()
+{
+    ViStatus status;
+
+    /* Set the timeout to 5 seconds (5000 milliseconds). */
+    status = viSetAttribute(mInstr, VI_ATTR_TMO_VALUE, 5000);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+
+    /* Set the baud rate to 9600, 8 data bits, no parity and one stop bit. */
+    status = viSetAttribute(mInstr, VI_ATTR_ASRL_BAUD, 9600);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+    status = viSetAttribute(mInstr, VI_ATTR_ASRL_DATA_BITS, 8);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+    status = viSetAttribute(mInstr, VI_ATTR_ASRL_PARITY, VI_ASRL_PAR_NONE);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+    status = viSetAttribute(mInstr, VI_ATTR_ASRL_STOP_BITS, VI_ASRL_STOP_ONE);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+
+    /*
+     * Specify that the read operation should terminate when a termination
+     * character (0xA) is received.
+     */
+    status = viSetAttribute(mInstr, VI_ATTR_TERMCHAR_EN, VI_TRUE);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+    status = viSetAttribute(mInstr, VI_ATTR_TERMCHAR, 0xA);
+    if (status < VI_SUCCESS)
+    {
+        return status;
+    }
+    mTermChar = 0xA;
+
+    return VI_SUCCESS;
+}
+
+TransportStatus VisaSerialTransport::DoRead(char* buffer, size_t length, size_t* count)
+{
+    /* ASRL ends a read on the termination character by default, whatever VI_ATTR_TERMCHAR_EN says */
+    ViStatus status = viSetAttribute(mInstr, VI_ATTR_ASRL_END_IN, VI_ASRL_END_NONE);
+    if (status < VI_SUCCESS)
+    {
+        *count = 0;
+        return status;
+    }
+    TransportStatus result = VisaTransport::DoRead(buffer, length, count);
+    status = viSetAttribute(mInstr, VI_ATTR_ASRL_END_IN, VI_ASRL_END_TERMCHAR);
+    return result < kTransportOk ? result : status;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file visatransport.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief VISA implementations of the transport: USBTMC and ASRL (RS232).
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#ifndef VISATRANSPORT_H
+#define VISATRANSPORT_H
+
+#include "visa.h"
+#include "transport.h"
+
+/**
+ * @brief Common VISA session handling.
+ *
+ * The resource manager session is opened on first use and kept until the
+ * transport is destroyed, so several instruments can be opened one after
+ * another without reopening it.
+ */
+class VisaTransport : public Transport
+{
+public:
+    VisaTransport();
+    virtual ~VisaTransport();
+
+protected:
+    virtual TransportStatus DoOpen(const char* resource);
+    virtual TransportStatus DoWrite(const char* data, size_t length, size_t* written);
+    virtual TransportStatus DoReadUntil(char* buffer, size_t capacity, char termChar, size_t* count);
+    virtual TransportStatus DoRead(char* buffer, size_t length, size_t* count);
+    virtual TransportStatus DoFlush();
+    virtual TransportStatus DoClose();
+    virtual TransportStatus DoSetTimeout(uint32_t timeoutMs, uint32_t* previous);
+    virtual TransportStatus DoReadStatusByte(uint8_t* status);
+
+    /* Called after viOpen succeeded, e.g. to set up the serial port. */
+    virtual ViStatus Configure();
+
+    ViStatus OpenResourceManager();
+
+    ViSession mDefaultRM;
+    ViSession mInstr;
+    int       mTermChar; /* currently configured termination character, -1: unknown */
+};
+
+/**
+ * @brief All USB Test & Measurement Class instruments found by VISA.
+ *
+ * USBTMC reports service requests on the interrupt endpoint, VISA queues
+ * them as VI_EVENT_SERVICE_REQ events of the session.
+ */
+class VisaUsbTransport : public VisaTransport
+{
+public:
+    virtual const char* CommandTerminator() const { return ""; }
+
+protected:
+    virtual TransportStatus DoDiscover(std::vector<std::string>* resources);
+    virtual TransportStatus DoEnableServiceRequest();
+    virtual TransportStatus DoWaitServiceRequest(uint32_t timeoutMs);
+};
+
+/**
+ * @brief The ITECH supply on the first serial port, 9600 baud 8N1.
+ *
+ * RS232 has no SRQ line, the service request hooks stay unsupported.
+ */
+class VisaSerialTransport : public VisaTransport
+{
+public:
+    virtual const char* CommandTerminator() const { return "\n"; }
+
+protected:
+    virtual TransportStatus DoDiscover(std::vector<std::string>* resources);
+    virtual TransportStatus DoRead(char* buffer, size_t length, size_t* count);
+    virtual ViStatus Configure();
+};
+
+#endif
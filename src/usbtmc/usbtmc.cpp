@@ -0,0 +1,57 @@
+/**
+ * @file usbtmc.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief 
+ * @version 0.2
+ * @date 2023-05-26
+ * 
+ * @copyright Copyright (c) 2023 MIT
+ * 
+ */
+/********************************************************************/
+/*                Read and Write to a USBTMC Instrument             */
+/*                                                                  */
+/* The commands are sent to all the USB Test & Measurement Class    */
+/* (USBTMC) instruments connected to the system. The VISA details   */
+/* live in the USB transport, see visatransport.cpp.                */
+/********************************************************************/
+
+#include "usbtmc.h"
+#include "itechdc.h"
+
+/**
+ * @brief Deprecated. This func control an ITECH DC power's output.
+ * 
+ * @param state Output state.
+ *              0: close;
+ *              1: open.
+ * @return int 
+ */
+int ItechDcPowerOutput(unsigned char state)
+{
+    return ItechDcPowerExchange(kTransportUsb, state ? "OUTP 1" : "OUTP 0", nullptr, nullptr);
+}
+
+/**
+ * @brief Write a standard SIPC command to an ITECH DC power supply.
+ * 
+ * @param command SIPC command string.
+ * @return int 
+ */
+int ItechDcPowerWrite(char* command)
+{
+    return ItechDcPowerExchange(kTransportUsb, command, nullptr, nullptr);
+}
+
+/**
+ * @brief Write a query command to an ITECH DC power supply and read back its reply.
+ * 
+ * @param command SIPC query command string.
+ * @param resultString Buffer to save a reply string.
+ * @param result Numberic reply will also be saved in this buffer.
+ * @return int 
+ */
+int ItechDcPowerQuery(char* command, char *resultString,  double *result)
+{
+    return ItechDcPowerExchange(kTransportUsb, command, resultString, result);
+}
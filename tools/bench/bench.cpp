@@ -0,0 +1,516 @@
+/**
+ * @file bench.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief itechbench: latency of the exported ITECHDC functions against a simulated supply.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * Every exported ITECHDC function is called the given number of times. For
+ * each one the latency distribution, the throughput and the mean time spent
+ * in the individual steps (discover, open, write, read, parse, log, close)
+ * are reported, optionally as JSON so runs can be compared.
+ *
+ * The callbacks suite times the CAPL DLL life cycle against the fake VIA
+ * objects: VIARegisterCDLL, dllInit/dllEnd and the functions that call back
+ * into CAPL. Whether the features behave is checked by itechcheck.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "cdll.h"
+#include "fakevia.h"
+#include "opstats.h"
+#include "itechsim.h"
+#include "minilogger.h"
+#include "simserver.h"
+#include "simtransport.h"
+#include "tracer.h"
+#include "visasim.h"
+
+// Exported by capldll.cpp
+void CAPLEXPORT CAPLPASCAL appItechDcPowerWrite(char* command);
+void CAPLEXPORT CAPLPASCAL appItechDcPowerQuery(char* command, char* resultString, double* result);
+void CAPLEXPORT CAPLPASCAL appItechDcPowerWriteSerial(char* command);
+void CAPLEXPORT CAPLPASCAL appItechDcPowerQuerySerial(char* command, char* resultString, double* result);
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeWrite(uint32_t handle, char* command);
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeWriteSerial(uint32_t handle, char* command);
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeQuery(uint32_t handle, char* command, char* resultString, int32_t size, double* result);
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeQuerySerial(uint32_t handle, char* command, char* resultString, int32_t size, double* result);
+int32_t CAPLEXPORT CAPLPASCAL appItechWaitComplete(uint32_t handle, int32_t timeoutMs);
+int32_t CAPLEXPORT CAPLPASCAL appItechWaitCompleteSerial(uint32_t handle, int32_t timeoutMs);
+void CAPLEXPORT CAPLPASCAL appInit(uint32_t handle);
+void CAPLEXPORT CAPLPASCAL appEnd(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appSetValue(uint32_t handle, int32_t x);
+int32_t CAPLEXPORT CAPLPASCAL appReadData(uint32_t handle, int32_t a);
+void ClearAll();
+int32_t CAPLEXPORT CAPLPASCAL appItechLogToWriteWindow(int32_t level);
+VIACLIENT(void) VIASetService(VIAService* service);
+
+static const uint32_t kCaplHandle = 1;
+
+/**
+ * @brief One benchmarked CAPL function.
+ */
+struct BenchCase
+{
+    const char* suite;
+    const char* name;
+    bool (*call)(); /* false if the call failed or its reply is empty */
+};
+
+/**
+ * @brief Results of one benchmarked CAPL function.
+ */
+struct BenchResult
+{
+    const char*           name;
+    std::vector<uint64_t> latencies;              /* ns per call                 */
+    uint64_t              opTotal[kItechOpCount]; /* ns per step over all calls  */
+    uint64_t              wallTotal;              /* ns for all calls            */
+    int                   failures;               /* measured calls that failed  */
+};
+
+static uint64_t gOpNs[kItechOpCount];
+static char     gResultString[100];
+static double   gResult;
+
+static void sObserve(ItechOp op, const char* resource, uint64_t nanoseconds)
+{
+    (void)resource;
+    gOpNs[op] += nanoseconds;
+}
+
+/* The void functions give no status: a write is not checked, a query by its reply. */
+static bool sWrite()
+{
+    appItechDcPowerWrite((char*)"VOLT 5V");
+    return true;
+}
+
+static bool sQuery()
+{
+    gResultString[0] = '\0';
+    appItechDcPowerQuery((char*)"MEAS:VOLT?", gResultString, &gResult);
+    return gResultString[0] != '\0';
+}
+
+static bool sWriteSerial()
+{
+    appItechDcPowerWriteSerial((char*)"VOLT 5V");
+    return true;
+}
+
+static bool sQuerySerial()
+{
+    gResultString[0] = '\0';
+    appItechDcPowerQuerySerial((char*)"MEAS:VOLT?", gResultString, &gResult);
+    return gResultString[0] != '\0';
+}
+
+/* The sessions of the node stay open, only the first call finds and opens the supply. */
+static bool sNodeWrite()
+{
+    return appItechNodeWrite(kCaplHandle, (char*)"VOLT 5V") == 0;
+}
+
+static bool sNodeQuery()
+{
+    gResultString[0] = '\0';
+    return appItechNodeQuery(kCaplHandle, (char*)"MEAS:VOLT?", gResultString, (int32_t)sizeof(gResultString), &gResult) == 0
+           && gResultString[0] != '\0';
+}
+
+static bool sNodeQuerySerial()
+{
+    gResultString[0] = '\0';
+    return appItechNodeQuerySerial(kCaplHandle, (char*)"MEAS:VOLT?", gResultString, (int32_t)sizeof(gResultString), &gResult) == 0
+           && gResultString[0] != '\0';
+}
+
+/* A setting and the wait for it, what replaces testWaitForTimeout after each step. */
+static bool sWaitComplete()
+{
+    return appItechNodeWrite(kCaplHandle, (char*)"VOLT 5V") == 0 && appItechWaitComplete(kCaplHandle, 5000) == 0;
+}
+
+static bool sWaitCompleteSerial()
+{
+    return appItechNodeWriteSerial(kCaplHandle, (char*)"VOLT 5V") == 0
+           && appItechWaitCompleteSerial(kCaplHandle, 5000) == 0;
+}
+
+/* Leaves the instance initialized for the cases that follow. */
+static bool sEndInit()
+{
+    appEnd(kCaplHandle);
+    appInit(kCaplHandle);
+    return true;
+}
+
+static bool sSetValue()
+{
+    appSetValue(kCaplHandle, 42);
+    return true;
+}
+
+static bool sReadData()
+{
+    appReadData(kCaplHandle, 0x01234567);
+    return true;
+}
+
+/* A device failing on every call, the limiter keeps the Write window free. */
+static bool sLogError()
+{
+    LOG_ERROR("Cannot open a session to the device %d.", 1);
+    return true;
+}
+
+static const BenchCase sCases[] = {
+    {"itechdc",   "dllItechDcPowerWrite",       sWrite},
+    {"itechdc",   "dllItechDcPowerQuery",       sQuery},
+    {"itechdc",   "dllItechDcPowerWriteSerial", sWriteSerial},
+    {"itechdc",   "dllItechDcPowerQuerySerial", sQuerySerial},
+    {"itechdc",   "dllItechNodeWrite",          sNodeWrite},
+    {"itechdc",   "dllItechNodeQuery",          sNodeQuery},
+    {"itechdc",   "dllItechNodeQuerySerial",    sNodeQuerySerial},
+    {"itechdc",   "dllItechWaitComplete",       sWaitComplete},
+    {"itechdc",   "dllItechWaitCompleteSerial", sWaitCompleteSerial},
+    {"callbacks", "dllEnd+dllInit",             sEndInit},
+    {"callbacks", "dllSetValue",                sSetValue},
+    {"callbacks", "dllReadData",                sReadData},
+    {"callbacks", "LOG_ERROR to Write window",  sLogError},
+};
+
+/*
+ * The CAPL program of the callbacks suite: the callbacks capldll.cpp looks
+ * up in dllInit, with the signatures it checks.
+ */
+static void sDefineCallbacks(FakeCapl* capl)
+{
+    capl->AddFunction("CALLBACK_ShowValue", 'D', "D");
+    capl->AddFunction("CALLBACK_ShowDates", 'D', "IDI");
+    capl->AddFunction("CALLBACK_DllInfo", 'V', "C");
+    capl->AddFunction("CALLBACK_ArrayValues", 'V', "DBB", "010");
+    capl->AddFunction("CALLBACK_DllVersion", 'V', "C");
+    capl->AddFunction("CALLBACK_ItechSamples", 'V', "FDF", "100");
+    capl->AddFunction("CALLBACK_ItechRule", 'V', "LLFFF");
+    capl->AddFunction("CALLBACK_ItechSrq", 'V', "LLLLF");
+    capl->AddFunction("CALLBACK_ItechSeqStep", 'V', "LLFF");
+    capl->AddFunction("CALLBACK_ItechSeqDone", 'V', "LLF");
+}
+
+static double sPercentileUs(const std::vector<uint64_t>& sorted, double percentile)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    size_t index = (size_t)(percentile / 100.0 * (double)(sorted.size() - 1) + 0.5);
+    return (double)sorted[index] / 1000.0;
+}
+
+static void sRun(const BenchCase& benchCase, int warmup, int iterations, BenchResult* result)
+{
+    result->name = benchCase.name;
+    result->latencies.clear();
+    result->latencies.reserve(iterations);
+    memset(result->opTotal, 0, sizeof(result->opTotal));
+    result->failures = 0;
+
+    for (int i = 0; i < warmup; i++)
+    {
+        benchCase.call();
+    }
+
+    memset(gOpNs, 0, sizeof(gOpNs));
+    uint64_t begin = ItechNowNs();
+    for (int i = 0; i < iterations; i++)
+    {
+        uint64_t start = ItechNowNs();
+        bool ok = benchCase.call();
+        result->latencies.push_back(ItechNowNs() - start);
+        result->failures += ok ? 0 : 1;
+    }
+    result->wallTotal = ItechNowNs() - begin;
+    memcpy(result->opTotal, gOpNs, sizeof(gOpNs));
+}
+
+static void sPrint(const BenchResult& result)
+{
+    std::vector<uint64_t> sorted(result.latencies);
+    std::sort(sorted.begin(), sorted.end());
+    double calls = (double)sorted.size();
+
+    printf("%-28s p50 %9.1f us  p90 %9.1f us  p99 %9.1f us  max %9.1f us  %10.0f calls/s\n",
+           result.name, sPercentileUs(sorted, 50), sPercentileUs(sorted, 90), sPercentileUs(sorted, 99),
+           sPercentileUs(sorted, 100), calls * 1e9 / (double)result.wallTotal);
+
+    printf("%-28s", "");
+    for (int op = 0; op < kItechOpCount; op++)
+    {
+        printf(" %s %.1f", ItechOpName((ItechOp)op), (double)result.opTotal[op] / calls / 1000.0);
+    }
+    printf(" (mean us)\n");
+    if (result.failures > 0)
+    {
+        fprintf(stderr, "%s: %d of %zu calls failed.\n", result.name, result.failures, sorted.size());
+    }
+}
+
+static void sWriteJson(FILE* file, const char* endpoint, int iterations, uint32_t delayUs,
+                       const std::vector<BenchResult>& results)
+{
+    fprintf(file, "{\n  \"tool\": \"itechbench\",\n  \"endpoint\": \"%s\",\n", endpoint);
+    fprintf(file, "  \"iterations\": %d,\n  \"delay_us\": %u,\n  \"functions\": [\n", iterations, delayUs);
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult& result = results[i];
+        std::vector<uint64_t> sorted(result.latencies);
+        std::sort(sorted.begin(), sorted.end());
+        double calls = (double)sorted.size();
+        uint64_t sum = 0;
+        uint64_t opSum = 0;
+        for (size_t j = 0; j < sorted.size(); j++)
+        {
+            sum += sorted[j];
+        }
+
+        fprintf(file, "    {\n      \"name\": \"%s\",\n      \"calls\": %zu,\n", result.name, sorted.size());
+        fprintf(file, "      \"failures\": %d,\n", result.failures);
+        fprintf(file, "      \"throughput_per_s\": %.1f,\n", calls * 1e9 / (double)result.wallTotal);
+        fprintf(file, "      \"latency_us\": {\"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+                (double)sum / calls / 1000.0, sPercentileUs(sorted, 50), sPercentileUs(sorted, 90),
+                sPercentileUs(sorted, 99), sPercentileUs(sorted, 100));
+        fprintf(file, "      \"breakdown_us\": {");
+        for (int op = 0; op < kItechOpCount; op++)
+        {
+            fprintf(file, "\"%s\": %.3f, ", ItechOpName((ItechOp)op), (double)result.opTotal[op] / calls / 1000.0);
+            opSum += result.opTotal[op];
+        }
+        /* Whatever is not covered by a step: CAPL wrapper, string handling, ... */
+        fprintf(file, "\"other\": %.3f}\n", sum > opSum ? (double)(sum - opSum) / calls / 1000.0 : 0.0);
+        fprintf(file, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+static void sUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--endpoint visa|memory|pty|tcp] [--iterations <n>] [--warmup <n>]\n"
+            "          [--delay-us <us>] [--suite itechdc|callbacks|all] [--filter <name>] [--json <file>]\n"
+            "          [--trace <file>] [--log-level <0-6>] [--binlog <file>]\n"
+            "  --endpoint    how the simulator is reached (default visa: stand-in VISA library)\n"
+            "  --iterations  calls per function (default 1000)\n"
+            "  --warmup      calls per function before measuring (default 10)\n"
+            "  --delay-us    processing time of the simulator per program message\n"
+            "  --suite       itechdc: ITECHDC functions (default), callbacks: DLL life cycle\n"
+            "                against the fake VIA objects, all: both\n"
+            "  --filter      only run functions whose name contains this text\n"
+            "  --json        write the results to a JSON file\n"
+            "  --trace       write a Chrome trace_event timeline of the measured calls\n"
+            "  --log-level   minimum level written to capldlllog, 0 trace ... 6 off (default 2 info)\n"
+            "  --binlog      log into this binary ring file instead of capldlllog\n"
+            "Exits with 1 if a measured call failed or returned an empty reply.\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* endpoint = "visa";
+    const char* jsonPath = nullptr;
+    const char* tracePath = nullptr;
+    const char* filter = nullptr;
+    const char* suite = "itechdc";
+    int iterations = 1000;
+    int warmup = 10;
+    uint32_t delayUs = 0;
+    int logLevel = LOG_DEFAULT_LEVEL;
+    const char* binLogPath = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--endpoint") == 0 && i + 1 < argc)
+        {
+            endpoint = argv[++i];
+        }
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            iterations = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+        {
+            warmup = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--delay-us") == 0 && i + 1 < argc)
+        {
+            delayUs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--suite") == 0 && i + 1 < argc)
+        {
+            suite = argv[++i];
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+        {
+            logLevel = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--binlog") == 0 && i + 1 < argc)
+        {
+            binLogPath = argv[++i];
+        }
+        else
+        {
+            sUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (iterations <= 0)
+    {
+        sUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ItechSimulator simulator;
+    simulator.SetResponseDelayUs(delayUs);
+    SimServer server(&simulator);
+    std::string resource;
+
+    if (strcmp(endpoint, "visa") == 0)
+    {
+        VisaSimBind(SIM_USB_RESOURCE, &simulator);
+        VisaSimBind(SIM_SERIAL_RESOURCE, &simulator);
+    }
+    else if (strcmp(endpoint, "memory") == 0)
+    {
+        AttachSimulator(&simulator);
+    }
+    else if (strcmp(endpoint, "pty") == 0)
+    {
+        std::string path = server.StartPty();
+        if (path.empty())
+        {
+            fprintf(stderr, "Could not open a pseudo terminal.\n");
+            return EXIT_FAILURE;
+        }
+        resource = "ASRL" + path + "::INSTR";
+        AttachStreamEndpoint(resource.c_str());
+    }
+    else if (strcmp(endpoint, "tcp") == 0)
+    {
+        int port = server.StartTcp(0);
+        if (port < 0)
+        {
+            fprintf(stderr, "Could not listen on a TCP port.\n");
+            return EXIT_FAILURE;
+        }
+        resource = "TCPIP::127.0.0.1::" + std::to_string(port) + "::SOCKET";
+        AttachStreamEndpoint(resource.c_str());
+    }
+    else
+    {
+        sUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bool allSuites = (strcmp(suite, "all") == 0);
+    if (!allSuites && strcmp(suite, "itechdc") != 0 && strcmp(suite, "callbacks") != 0)
+    {
+        sUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FakeCapl capl(kCaplHandle);
+    sDefineCallbacks(&capl);
+    FakeVIAService service;
+    VIASetService(&service);
+    VIARegisterCDLL(&capl);
+    appInit(kCaplHandle);
+    appItechLogToWriteWindow(LOG_LEVEL_WARN);
+
+    FileLoggerSetLevel(logLevel);
+    if (binLogPath != nullptr && BinLogStart(binLogPath, 0) != 0)
+    {
+        fprintf(stderr, "Could not create the binary log %s.\n", binLogPath);
+        return EXIT_FAILURE;
+    }
+    SetItechOpObserver(sObserve);
+    if (tracePath != nullptr && TraceStart(tracePath, 0) != 0)
+    {
+        fprintf(stderr, "Could not allocate the trace buffer.\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<BenchResult> results;
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(sCases) / sizeof(sCases[0]); i++)
+    {
+        if (!allSuites && strcmp(sCases[i].suite, suite) != 0)
+        {
+            continue;
+        }
+        if (filter != nullptr && strstr(sCases[i].name, filter) == nullptr)
+        {
+            continue;
+        }
+        BenchResult result;
+        sRun(sCases[i], warmup, iterations, &result);
+        sPrint(result);
+        results.push_back(result);
+        failures += result.failures;
+    }
+
+    SetItechOpObserver(nullptr);
+    server.Stop();
+
+    if (tracePath != nullptr)
+    {
+        int events = TraceStop();
+        if (events < 0)
+        {
+            fprintf(stderr, "Could not write %s.\n", tracePath);
+            return EXIT_FAILURE;
+        }
+        printf("trace: %d events, %llu dropped\n", events, (unsigned long long)TraceDropped());
+    }
+    if (binLogPath != nullptr)
+    {
+        BinLogStop();
+    }
+
+    appEnd(kCaplHandle);
+    ClearAll();
+
+    if (jsonPath != nullptr)
+    {
+        FILE* file = fopen(jsonPath, "w");
+        if (file == nullptr)
+        {
+            fprintf(stderr, "Could not write %s.\n", jsonPath);
+            return EXIT_FAILURE;
+        }
+        sWriteJson(file, endpoint, iterations, delayUs, results);
+        fclose(file);
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,625 @@
+/**
+ * @file itechcheck.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief itechcheck: functional checks of the CAPL DLL against a simulated supply.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * The DLL runs its life cycle against the fake VIA objects and the
+ * simulator behind the stand-in VISA library. Each check drives one feature
+ * through its exports and the fake CAPL callbacks, whose parameters are read
+ * with FakeCaplHandler and the signature the DLL binds them with.
+ *
+ * Counts, values and states are checked exactly. Durations depend on the
+ * load of the host: a duration the simulated supply cannot beat, e.g. a
+ * ramp, is a hard lower bound, what the DLL promises, e.g. the latency of a
+ * batch, an upper bound with a generous margin.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cdll.h"
+#include "fakevia.h"
+#include "itechsim.h"
+#include "minilogger.h"
+#include "simtransport.h"
+#include "visasim.h"
+
+// Exported by capldll.cpp
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeWrite(uint32_t handle, char* command);
+int32_t CAPLEXPORT CAPLPASCAL appItechNodeQuery(uint32_t handle, char* command, char* resultString, int32_t size, double* result);
+int32_t CAPLEXPORT CAPLPASCAL appItechWaitSettled(uint32_t handle, int32_t device, char* quantity, double target, double tolerance, int32_t stableMs, int32_t timeoutMs);
+void CAPLEXPORT CAPLPASCAL appInit(uint32_t handle);
+void CAPLEXPORT CAPLPASCAL appEnd(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appSetValue(uint32_t handle, int32_t x);
+int32_t CAPLEXPORT CAPLPASCAL appReadData(uint32_t handle, int32_t a);
+int32_t CAPLEXPORT CAPLPASCAL appItechSampleStart(uint32_t handle, int32_t device, char* command, int32_t periodUs, int32_t batchSize, int32_t maxLatencyMs);
+int32_t CAPLEXPORT CAPLPASCAL appItechSampleStop(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechRuleAdd(uint32_t handle, int32_t device, char* command, int32_t kind, double limits[], int32_t count);
+int32_t CAPLEXPORT CAPLPASCAL appItechMonitorStart(uint32_t handle, int32_t periodUs);
+int32_t CAPLEXPORT CAPLPASCAL appItechMonitorStop(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechSrqStart(uint32_t handle, int32_t serviceEnable, int32_t eventEnable, int32_t questionableEnable, int32_t pollUs);
+int32_t CAPLEXPORT CAPLPASCAL appItechSrqStartSerial(uint32_t handle, int32_t serviceEnable, int32_t eventEnable, int32_t questionableEnable, int32_t pollUs);
+int32_t CAPLEXPORT CAPLPASCAL appItechSrqStop(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqAdd(uint32_t handle, int32_t offsetUs, char* command);
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqClear(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqStart(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqAbort(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechSeqResult(uint32_t handle, int32_t step, double values[], int32_t count);
+int32_t CAPLEXPORT CAPLPASCAL appItechListLoad(uint32_t handle, double values[], int32_t count);
+int32_t CAPLEXPORT CAPLPASCAL appItechListRun(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechListAbort(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechListWait(uint32_t handle, int32_t timeoutMs);
+int32_t CAPLEXPORT CAPLPASCAL appItechDlogConfig(uint32_t handle, int32_t intervalUs, int32_t points, int32_t source);
+int32_t CAPLEXPORT CAPLPASCAL appItechDlogStart(uint32_t handle);
+int32_t CAPLEXPORT CAPLPASCAL appItechDlogRead(uint32_t handle, int32_t device, char* quantity, double values[], int32_t count, int32_t timeoutMs);
+void ClearAll();
+int32_t CAPLEXPORT CAPLPASCAL appItechLogToWriteWindow(int32_t level);
+VIACLIENT(void) VIASetService(VIAService* service);
+
+static const uint32_t kCaplHandle = 1;
+
+/**
+ * @brief What every check works with.
+ */
+struct CheckEnv
+{
+    FakeVIAService* service;
+    FakeCapl*       capl;
+    ItechSimulator* simulator;
+};
+
+/**
+ * @brief One functional check.
+ */
+struct CheckCase
+{
+    const char* name;
+    bool (*run)(CheckEnv& env);
+};
+
+/*
+ * The CAPL program: the callbacks capldll.cpp looks up in dllInit, with the
+ * signatures it checks.
+ */
+static void sDefineCallbacks(FakeCapl* capl)
+{
+    capl->AddFunction("CALLBACK_ShowValue", 'D', "D");
+    capl->AddFunction("CALLBACK_ShowDates", 'D', "IDI");
+    capl->AddFunction("CALLBACK_DllInfo", 'V', "C");
+    capl->AddFunction("CALLBACK_ArrayValues", 'V', "DBB", "010");
+    capl->AddFunction("CALLBACK_DllVersion", 'V', "C");
+    capl->AddFunction("CALLBACK_ItechSamples", 'V', "FDF", "100");
+    capl->AddFunction("CALLBACK_ItechRule", 'V', "LLFFF");
+    capl->AddFunction("CALLBACK_ItechSrq", 'V', "LLLLF");
+    capl->AddFunction("CALLBACK_ItechSeqStep", 'V', "LLFF");
+    capl->AddFunction("CALLBACK_ItechSeqDone", 'V', "LLF");
+}
+
+/* Let the threads of the DLL see the supply for ms, the simulated time following the wall clock. */
+static void sSettle(FakeVIAService& service, int ms)
+{
+    for (int i = 0; i < ms; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        service.AdvanceTime(1000000);
+    }
+}
+
+/* dllSetValue and dllReadData reach their callbacks with the values of the DLL. */
+static bool sCheckCallbacks(CheckEnv& env)
+{
+    uint32_t shown = 0;
+    std::string info;
+    FakeCaplFunction* showValue = env.capl->Function("CALLBACK_ShowValue");
+    FakeCaplFunction* dllInfo = env.capl->Function("CALLBACK_DllInfo");
+    showValue->SetHandler(FakeCaplHandler<uint32_t(uint32_t)>([&](uint32_t value) -> uint32_t {
+        shown = value;
+        return value;
+    }));
+    dllInfo->SetHandler(FakeCaplHandler<void(CaplString)>([&](CaplString text) {
+        info.assign(text.data != nullptr ? text.data : "");
+    }));
+
+    int32_t value = appSetValue(kCaplHandle, 42);
+    appReadData(kCaplHandle, 0x01234567);
+    showValue->SetHandler(FakeCaplFunction::Handler());
+    dllInfo->SetHandler(FakeCaplFunction::Handler());
+
+    printf("callbacks: ShowValue %u (returned %d), DllInfo \"%s\"\n", shown, value, info.c_str());
+    if (shown != 42 || info != "DLL: processing")
+    {
+        fprintf(stderr, "The callbacks received wrong parameters.\n");
+        return false;
+    }
+    return true;
+}
+
+/* A reply longer than the array of the node is cut to its size, the byte behind it stays untouched. */
+static bool sCheckReply(CheckEnv& env)
+{
+    (void)env;
+    char reply[9];
+    memset(reply, 0x7f, sizeof(reply));
+    double value = 0.0;
+    int32_t rc = appItechNodeQuery(kCaplHandle, (char*)"*IDN?", reply, 8, &value);
+    int32_t rcSize = appItechNodeQuery(kCaplHandle, (char*)"*IDN?", reply, 0, &value);
+
+    printf("reply: \"%.8s\" (%d), size 0 -> %d\n", reply, rc, rcSize);
+    if (rc != 0 || strlen(reply) != 7 || reply[8] != 0x7f || rcSize != -1)
+    {
+        fprintf(stderr, "The reply was not cut to the size of the array.\n");
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Sample every 1 ms in batches of 10 with at most 20 ms latency for 200 ms.
+ * The simulated time follows the wall clock in 1 ms steps, so the latency of
+ * every batch is known from the measurement time of its first sample.
+ */
+static bool sCheckSamples(CheckEnv& env)
+{
+    static const int32_t kBatch = 10;
+    static const int32_t kLatencyMs = 20;
+    static const uint64_t kMinSamples = 150; /* of 200, one every 1 ms */
+    uint64_t batches = 0;
+    uint64_t samples = 0;
+    uint32_t largest = 0;
+    double worstMs = 0.0;
+
+    FakeCaplFunction* callback = env.capl->Function("CALLBACK_ItechSamples");
+    callback->SetHandler(FakeCaplHandler<void(CaplArray<double>, uint32_t, double)>(
+        [&](CaplArray<double> values, uint32_t count, double first) {
+            (void)values;
+            batches++;
+            samples += count;
+            largest = std::max(largest, count);
+            worstMs = std::max(worstMs, ((double)env.service->Now() / 1e9 - first) * 1e3);
+        }));
+
+    int32_t rc = appItechSampleStart(kCaplHandle, 0, (char*)"MEAS:VOLT?", 1000, kBatch, kLatencyMs);
+    for (int ms = 0; ms < 200 && rc == 0; ms++)
+    {
+        sSettle(*env.service, 1);
+    }
+    int32_t dropped = appItechSampleStop(kCaplHandle);
+    callback->SetHandler(FakeCaplFunction::Handler());
+
+    printf("samples: %llu in %llu batches, largest %u, worst latency %.1f ms (%d ms asked), %d dropped\n",
+           (unsigned long long)samples, (unsigned long long)batches, largest, worstMs, kLatencyMs, dropped);
+    if (rc != 0 || batches == 0 || largest > (uint32_t)kBatch || dropped != 0 || samples < kMinSamples)
+    {
+        fprintf(stderr, "Batched sample delivery failed (start %d).\n", rc);
+        return false;
+    }
+    /* a quarter of the latency for the timer, the rest for a loaded host */
+    if (worstMs > kLatencyMs * 1.25 + 20.0)
+    {
+        fprintf(stderr, "A batch waited longer than the maximum latency.\n");
+        return false;
+    }
+    return true;
+}
+
+/*
+ * An overvoltage rule at 5 V with 0.5 V hysteresis and a rule on the output
+ * state. The voltage goes 1 V, 8 V, 7 V (still above, no new event), 1 V
+ * (armed again), 8 V, then the output is switched off: two overvoltage
+ * events and one output event.
+ */
+static bool sCheckRules(CheckEnv& env)
+{
+    uint64_t above = 0;
+    uint64_t changes = 0;
+    int32_t overvoltage = 0;
+    int32_t output = 0;
+
+    FakeCaplFunction* callback = env.capl->Function("CALLBACK_ItechRule");
+    callback->SetHandler(FakeCaplHandler<void(int32_t, int32_t, double, double, double)>(
+        [&](int32_t rule, int32_t device, double value, double previous, double time) {
+            (void)device;
+            (void)value;
+            (void)previous;
+            (void)time;
+            above += (rule == overvoltage) ? 1 : 0;
+            changes += (rule == output) ? 1 : 0;
+        }));
+
+    static const char* const steps[] = {"VOLT 8", "VOLT 7", "VOLT 1", "VOLT 8", "OUTP 0"};
+    appItechNodeWrite(kCaplHandle, (char*)"VOLT 1");
+    appItechNodeWrite(kCaplHandle, (char*)"OUTP 1");
+    double level[2] = {5.0, 0.5};
+    double mask[1] = {0.0};
+    overvoltage = appItechRuleAdd(kCaplHandle, 0, (char*)"MEAS:VOLT?", 0, level, 2);
+    output = appItechRuleAdd(kCaplHandle, 0, (char*)"OUTP?", 3, mask, 1);
+    int32_t rc = appItechMonitorStart(kCaplHandle, 1000);
+    sSettle(*env.service, 20);
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]) && rc == 0; i++)
+    {
+        appItechNodeWrite(kCaplHandle, (char*)steps[i]);
+        sSettle(*env.service, 20);
+    }
+    int32_t dropped = appItechMonitorStop(kCaplHandle);
+    callback->SetHandler(FakeCaplFunction::Handler());
+
+    printf("rules: %llu overvoltage events, %llu output events, %d dropped\n", (unsigned long long)above,
+           (unsigned long long)changes, dropped);
+    if (rc != 0 || overvoltage <= 0 || output <= 0 || above != 2 || changes != 1 || dropped != 0)
+    {
+        fprintf(stderr, "Rule evaluation failed (start %d).\n", rc);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Service requests on operation complete and on protection, first through
+ * USB, where the stand-in VISA raises SRQ, then through RS232, where the
+ * status byte is polled. Each "*OPC" and each trip is one request.
+ */
+static bool sCheckRequests(CheckEnv& env)
+{
+    static const int32_t kServiceEnable = 0x28; /* ESB, QUES */
+    static const int32_t kEventEnable = 0x01;   /* OPC       */
+    uint64_t complete = 0;
+    uint64_t tripped = 0;
+    uint64_t requests = 0;
+
+    FakeCaplFunction* callback = env.capl->Function("CALLBACK_ItechSrq");
+    callback->SetHandler(FakeCaplHandler<void(int32_t, int32_t, int32_t, int32_t, double)>(
+        [&](int32_t device, int32_t statusByte, int32_t eventStatus, int32_t questionable, double time) {
+            (void)device;
+            (void)statusByte;
+            (void)time;
+            requests++;
+            complete += (eventStatus & kEventEnable) != 0 ? 1 : 0;
+            tripped += (questionable & SIM_QUES_OVP) != 0 ? 1 : 0;
+        }));
+
+    int32_t rc = appItechSrqStart(kCaplHandle, kServiceEnable, kEventEnable, SIM_QUES_OVP, 5000);
+    if (rc == 0)
+    {
+        sSettle(*env.service, 20);
+        appItechNodeWrite(kCaplHandle, (char*)"*OPC");
+        sSettle(*env.service, 20);
+        env.simulator->TripProtection(SIM_QUES_OVP);
+        sSettle(*env.service, 20);
+    }
+    int32_t dropped = appItechSrqStop(kCaplHandle);
+    appItechNodeWrite(kCaplHandle, (char*)"OUTP:PROT:CLE");
+    uint64_t usbRequests = requests;
+
+    int32_t rcSerial = appItechSrqStartSerial(kCaplHandle, kServiceEnable, kEventEnable, SIM_QUES_OVP, 2000);
+    if (rcSerial == 0)
+    {
+        sSettle(*env.service, 20);
+        env.simulator->TripProtection(SIM_QUES_OVP);
+        sSettle(*env.service, 20);
+    }
+    dropped += appItechSrqStop(kCaplHandle);
+    appItechNodeWrite(kCaplHandle, (char*)"OUTP:PROT:CLE");
+    callback->SetHandler(FakeCaplFunction::Handler());
+
+    printf("requests: %llu through USB, %llu through RS232, %llu operations complete, %llu trips, %d dropped\n",
+           (unsigned long long)usbRequests, (unsigned long long)(requests - usbRequests),
+           (unsigned long long)complete, (unsigned long long)tripped, dropped);
+    if (rc != 0 || rcSerial != 0 || usbRequests != 2 || requests != 3 || complete != 1 || tripped != 2
+        || dropped != 0)
+    {
+        fprintf(stderr, "Service request handling failed (start %d, %d).\n", rc, rcSerial);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Settling of a 1 V to 10 V step at 100 V/s: the ramp alone takes 90 ms,
+ * the output cannot be within 50 mV sooner, and the polling must notice it
+ * well within 500 ms. The measurements taken show the
+ * adaptive polling, fast on the ramp and only a few once the value rests.
+ */
+static bool sCheckSettled(CheckEnv& env)
+{
+    env.simulator->SetSlewRate(100.0);
+    appItechNodeWrite(kCaplHandle, (char*)"VOLT 1");
+    appItechNodeWrite(kCaplHandle, (char*)"OUTP 1");
+    int32_t rise = appItechWaitSettled(kCaplHandle, 0, (char*)"MEAS:VOLT?", 1.0, 0.05, 20, 2000);
+
+    appItechNodeWrite(kCaplHandle, (char*)"VOLT 10");
+    uint64_t before = env.simulator->MessageCount();
+    int32_t settled = appItechWaitSettled(kCaplHandle, 0, (char*)"MEAS:VOLT?", 10.0, 0.05, 20, 2000);
+    uint64_t measurements = env.simulator->MessageCount() - before;
+    int32_t timeout = appItechWaitSettled(kCaplHandle, 0, (char*)"MEAS:VOLT?", 12.0, 0.05, 20, 50);
+
+    appItechNodeWrite(kCaplHandle, (char*)"OUTP 0");
+    env.simulator->SetSlewRate(0.0);
+
+    printf("settled: %d ms after the step in %llu measurements, %d ms from off, %d to an unreachable target\n",
+           settled, (unsigned long long)measurements, rise, timeout);
+    if (rise < 0 || settled < 80 || settled > 500 || timeout != (int32_t)0xBFFF0015)
+    {
+        fprintf(stderr, "Waiting until settled failed.\n");
+        return false;
+    }
+    return true;
+}
+
+/*
+ * A staircase of 11 steps, 10 ms apart, added last step first: the steps
+ * run by offset, none later than 20 ms, and the last one leaves 10 V. Then a sequence aborted
+ * between its two steps, 1 s apart.
+ */
+static bool sCheckSequence(CheckEnv& env)
+{
+    static const int kSteps = 11;
+    int steps = 0;
+    int outOfOrder = 0;
+    int failed = 0;
+    int32_t previous = kSteps;
+    double maxErrorUs = -1.0;
+    int32_t executed = -1;
+    int32_t aborted = -1;
+
+    FakeCaplFunction* stepCallback = env.capl->Function("CALLBACK_ItechSeqStep");
+    FakeCaplFunction* doneCallback = env.capl->Function("CALLBACK_ItechSeqDone");
+    stepCallback->SetHandler(FakeCaplHandler<void(int32_t, int32_t, double, double)>(
+        [&](int32_t step, int32_t status, double errorUs, double time) {
+            (void)errorUs;
+            (void)time;
+            steps++;
+            outOfOrder += step >= previous ? 1 : 0;
+            failed += status < 0 ? 1 : 0;
+            previous = step;
+        }));
+    doneCallback->SetHandler(FakeCaplHandler<void(int32_t, int32_t, double)>(
+        [&](int32_t count, int32_t abort, double errorUs) {
+            executed = count;
+            aborted = abort;
+            maxErrorUs = errorUs;
+        }));
+
+    for (int i = kSteps - 1; i >= 0; i--)
+    {
+        char command[32];
+        snprintf(command, sizeof(command), "VOLT %d", i);
+        appItechSeqAdd(kCaplHandle, i * 10000, command);
+    }
+    int32_t rc = appItechSeqStart(kCaplHandle);
+    for (int waited = 0; rc == 0 && executed < 0 && waited < 2000; waited += 10)
+    {
+        sSettle(*env.service, 10);
+    }
+    double last[3] = {-1.0, -1.0, -1.0};
+    appItechSeqResult(kCaplHandle, 0, last, 3);
+    char reply[100];
+    double voltage = 0.0;
+    appItechNodeQuery(kCaplHandle, (char*)"VOLT?", reply, (int32_t)sizeof(reply), &voltage);
+    int32_t runExecuted = executed;
+    int32_t runAborted = aborted;
+    double runMaxErrorUs = maxErrorUs;
+
+    appItechSeqClear(kCaplHandle);
+    appItechSeqAdd(kCaplHandle, 0, (char*)"VOLT 1");
+    appItechSeqAdd(kCaplHandle, 1000000, (char*)"VOLT 2");
+    executed = -1;
+    previous = kSteps;
+    int32_t rcAbort = appItechSeqStart(kCaplHandle);
+    sSettle(*env.service, 20);
+    int32_t notRun = appItechSeqAbort(kCaplHandle);
+    appItechSeqClear(kCaplHandle);
+    appItechNodeWrite(kCaplHandle, (char*)"VOLT 0");
+    stepCallback->SetHandler(FakeCaplFunction::Handler());
+    doneCallback->SetHandler(FakeCaplFunction::Handler());
+
+    printf("sequence: %d steps, worst %.1f us late, last step %.1f us late in %.1f us, abort left %d step\n",
+           runExecuted, runMaxErrorUs, last[1], last[2], notRun);
+    if (rc != 0 || runExecuted != kSteps || runAborted != 0 || outOfOrder != 0 || failed != 0 || voltage != 10.0
+        || runMaxErrorUs < 0.0 || runMaxErrorUs > 20000.0 || last[0] != 0.0 || rcAbort != 0 || notRun != 1 || executed != 1 || aborted != 1
+        || steps != kSteps + 1)
+    {
+        fprintf(stderr, "Sequence failed (start %d, %d).\n", rc, rcAbort);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * A profile of 150 steps of 2 ms, two LIST slots, ending at 12 V: it cannot
+ * end before 300 ms nor take twice as long, takes a handful of messages,
+ * and the supply holds the last step. Then a profile of one 5 s step
+ * aborted after 20 ms.
+ */
+static bool sCheckList(CheckEnv& env)
+{
+    static const int kSteps = 150;
+    std::vector<double> profile;
+    for (int i = 0; i < kSteps; i++)
+    {
+        profile.push_back(i == kSteps - 1 ? 12.0 : 1.0 + i % 10);
+        profile.push_back(5.0);
+        profile.push_back(0.002);
+    }
+
+    appItechNodeWrite(kCaplHandle, (char*)"VOLT 1;OUTP 1");
+    int32_t slots = appItechListLoad(kCaplHandle, profile.data(), (int32_t)profile.size());
+    uint64_t before = env.simulator->MessageCount();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int32_t rc = appItechListRun(kCaplHandle);
+    int32_t status = appItechListWait(kCaplHandle, 5000);
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    uint64_t messages = env.simulator->MessageCount() - before;
+    double held = env.simulator->MeasuredVoltage();
+
+    double longStep[3] = {8.0, 5.0, 5.0};
+    int32_t rcAbort = appItechListLoad(kCaplHandle, longStep, 3) == 1 ? appItechListRun(kCaplHandle) : -1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    double during = env.simulator->MeasuredVoltage();
+    int32_t aborted = appItechListAbort(kCaplHandle);
+    int32_t abortStatus = appItechListWait(kCaplHandle, 1000);
+    double after = env.simulator->MeasuredVoltage();
+    appItechNodeWrite(kCaplHandle, (char*)"LIST:STAT OFF;OUTP 0;VOLT 0");
+
+    printf("list: %d steps in %d slots ran in %.1f ms with %llu messages, held %.1f V, aborted at %.1f V -> %.1f V\n",
+           kSteps, slots, elapsedMs, (unsigned long long)messages, held, during, after);
+    if (slots != 2 || rc != 0 || status != 0 || elapsedMs < 300.0 || elapsedMs > 600.0 || messages > 100 || held != 12.0
+        || rcAbort != 0 || during != 8.0 || aborted != 0 || abortStatus != (int32_t)0xBFFF0010 || after != 1.0)
+    {
+        fprintf(stderr, "LIST profile failed (load %d, run %d, wait %d).\n", slots, rc, status);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * A 200 ms acquisition armed for the bus trigger captures a two step LIST
+ * profile started by the same *TRG, 4 V for 50 ms then 9 V, and comes back
+ * in one binary block. A second one started at once reads the current.
+ */
+static bool sCheckDatalog(CheckEnv& env)
+{
+    static const int kPoints = 200;
+    double profile[6] = {4.0, 5.0, 0.05, 9.0, 5.0, 0.1};
+    std::vector<double> voltage(kPoints + 10, -1.0);
+    std::vector<double> current(kPoints, -1.0);
+
+    appItechNodeWrite(kCaplHandle, (char*)"VOLT 1;OUTP 1");
+    int32_t format = appItechDlogConfig(kCaplHandle, 1000, kPoints, 1);
+    int32_t armed = appItechDlogStart(kCaplHandle);
+    int32_t loaded = appItechListLoad(kCaplHandle, profile, 6);
+    int32_t run = appItechListRun(kCaplHandle);
+    uint64_t before = env.simulator->MessageCount();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int32_t points = appItechDlogRead(kCaplHandle, 0, (char*)"FETC:ARR:VOLT?", voltage.data(), (int32_t)voltage.size(), 5000);
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    uint64_t messages = env.simulator->MessageCount() - before;
+    appItechListWait(kCaplHandle, 5000);
+
+    int32_t immediate = appItechDlogConfig(kCaplHandle, 500, 20, 0) == 1 ? appItechDlogStart(kCaplHandle) : -1;
+    int32_t currents = appItechDlogRead(kCaplHandle, 0, (char*)"FETC:ARR:CURR?", current.data(), (int32_t)current.size(), 5000);
+    appItechNodeWrite(kCaplHandle, (char*)"LIST:STAT OFF;OUTP 0;VOLT 0");
+
+    printf("datalog: %d points (format %d) read in %.1f ms with %llu messages, %.1f V, %.1f V, %.1f V; %d currents %.2f A\n",
+           points, format, elapsedMs, (unsigned long long)messages, voltage[25], voltage[100], voltage[kPoints - 1],
+           currents, current[0]);
+    if (format != 1 || armed != 0 || loaded != 1 || run != 0 || points != kPoints || voltage[25] != 4.0
+        || voltage[100] != 9.0 || voltage[kPoints - 1] != 9.0 || voltage[kPoints] != -1.0 || messages > 100
+        || immediate != 0 || currents != 20 || fabs(current[0] - 0.9) > 1e-6)
+    {
+        fprintf(stderr, "Datalog failed (config %d, start %d, read %d, currents %d).\n", format, armed, points, currents);
+        return false;
+    }
+    return true;
+}
+
+/* An error logged on every call, as by a device that is gone, reaches the Write window only a few times. */
+static bool sCheckWriteWindow(CheckEnv& env)
+{
+    for (int i = 0; i < 500; i++)
+    {
+        LOG_ERROR("Cannot open a session to the device %d.", 1);
+    }
+    std::vector<std::string> messages = env.service->DebugInfo()->Messages();
+    printf("write window: %zu lines", messages.size());
+    if (!messages.empty())
+    {
+        printf(", last \"%s\"", messages.back().c_str());
+    }
+    printf("\n");
+    if (messages.empty() || messages.size() > 10)
+    {
+        fprintf(stderr, "The repeated error was not merged.\n");
+        return false;
+    }
+    return true;
+}
+
+static const CheckCase sChecks[] = {
+    {"callbacks",   sCheckCallbacks},
+    {"reply",       sCheckReply},
+    {"samples",     sCheckSamples},
+    {"rules",       sCheckRules},
+    {"requests",    sCheckRequests},
+    {"settled",     sCheckSettled},
+    {"sequence",    sCheckSequence},
+    {"list",        sCheckList},
+    {"datalog",     sCheckDatalog},
+    {"writewindow", sCheckWriteWindow},
+};
+
+static void sUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--filter <name>]\n"
+            "  --filter  only run checks whose name contains this text:",
+            program);
+    for (size_t i = 0; i < sizeof(sChecks) / sizeof(sChecks[0]); i++)
+    {
+        fprintf(stderr, " %s", sChecks[i].name);
+    }
+    fprintf(stderr, "\nExits with 1 if a check failed or a CAPL function handle was not released.\n");
+}
+
+int main(int argc, char* argv[])
+{
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else
+        {
+            sUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    ItechSimulator simulator;
+    VisaSimBind(SIM_USB_RESOURCE, &simulator);
+    VisaSimBind(SIM_SERIAL_RESOURCE, &simulator);
+
+    FakeCapl capl(kCaplHandle);
+    sDefineCallbacks(&capl);
+    FakeVIAService service;
+    VIASetService(&service);
+    VIARegisterCDLL(&capl);
+    appInit(kCaplHandle);
+    appItechLogToWriteWindow(LOG_LEVEL_WARN);
+
+    CheckEnv env = {&service, &capl, &simulator};
+    int run = 0;
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(sChecks) / sizeof(sChecks[0]); i++)
+    {
+        if (filter != nullptr && strstr(sChecks[i].name, filter) == nullptr)
+        {
+            continue;
+        }
+        run++;
+        failed += sChecks[i].run(env) ? 0 : 1;
+    }
+
+    appEnd(kCaplHandle);
+    ClearAll();
+    VisaSimUnbindAll();
+    if (capl.Outstanding() != 0)
+    {
+        fprintf(stderr, "%lld CAPL function handles were not released.\n", (long long)capl.Outstanding());
+        failed++;
+    }
+
+    printf("itechcheck: %d of %d checks failed\n", failed, run);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,892 @@
+/**
+ * @file fakevia.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Host-side fakes of the VIA objects CANoe hands to a CAPL DLL.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+#include "fakevia.h"
+
+/* Same condition as capldll.cpp uses for the 64 bit call stack layout. */
+#if defined(_WIN64) || defined(__linux__)
+static const int32_t kScalarSlot = 8;
+static const int32_t kArraySlot  = 16;
+#else
+static const int32_t kScalarSlot = 4;
+static const int32_t kArraySlot  = 8;
+#endif
+
+/* ========================================================================== */
+/* FakeCaplFunction                                                           */
+/* ========================================================================== */
+
+FakeCaplFunction::FakeCaplFunction(const char* name, char resultType, const char* paramTypes, const char* arrays)
+    : mName(name),
+      mResultType(resultType),
+      mParamTypes(paramTypes),
+      mParamSize(0),
+      mResult(0),
+      mHistoryLimit(16),
+      mCallCount(0)
+{
+    for (size_t i = 0; i < mParamTypes.size(); i++)
+    {
+        bool isArray = (mParamTypes[i] == 'C') || (arrays != nullptr && i < strlen(arrays) && arrays[i] == '1');
+        mParamSize += isArray ? kArraySlot : kScalarSlot;
+    }
+}
+
+VIASTDDEF FakeCaplFunction::ParamSize(int32* size)
+{
+    *size = mParamSize;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeCaplFunction::ParamCount(int32* size)
+{
+    *size = (int32)mParamTypes.size();
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeCaplFunction::ParamType(char* type, int32 nth)
+{
+    if (nth < 0 || nth >= (int32)mParamTypes.size())
+    {
+        return kVIA_ParameterInvalid;
+    }
+    *type = mParamTypes[nth];
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeCaplFunction::ResultType(char* type)
+{
+    *type = mResultType;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeCaplFunction::Call(uint32* result, void* params)
+{
+    uint32_t value = Invoke(params);
+    if (result != nullptr)
+    {
+        *result = value;
+    }
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeCaplFunction::CallReturnsDouble(double* result, void* params)
+{
+    uint32_t value = Invoke(params);
+    if (result != nullptr)
+    {
+        *result = (double)value;
+    }
+    return kVIA_OK;
+}
+
+uint32_t FakeCaplFunction::Invoke(const void* params)
+{
+    Handler handler;
+    uint32_t result;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCallCount++;
+        if (mHistoryLimit > 0)
+        {
+            if (mHistory.size() >= mHistoryLimit)
+            {
+                mHistory.erase(mHistory.begin());
+            }
+            const uint8_t* bytes = (const uint8_t*)params;
+            mHistory.push_back(std::vector<uint8_t>(bytes, bytes + (params != nullptr ? mParamSize : 0)));
+        }
+        handler = mHandler;
+        result = mResult;
+    }
+    /* The handler runs unlocked, it may call back into the DLL. */
+    return handler ? handler((const uint8_t*)params) : result;
+}
+
+void FakeCaplFunction::SetResult(uint32_t result)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResult = result;
+}
+
+void FakeCaplFunction::SetHandler(const Handler& handler)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mHandler = handler;
+}
+
+void FakeCaplFunction::SetHistoryLimit(size_t limit)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mHistoryLimit = limit;
+    while (mHistory.size() > mHistoryLimit)
+    {
+        mHistory.erase(mHistory.begin());
+    }
+}
+
+uint64_t FakeCaplFunction::CallCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCallCount;
+}
+
+std::vector<uint8_t> FakeCaplFunction::LastParams() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHistory.empty() ? std::vector<uint8_t>() : mHistory.back();
+}
+
+std::vector<std::vector<uint8_t> > FakeCaplFunction::History() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHistory;
+}
+
+void FakeCaplFunction::Reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCallCount = 0;
+    mHistory.clear();
+}
+
+/* ========================================================================== */
+/* FakeCapl                                                                   */
+/* ========================================================================== */
+
+FakeCapl::FakeCapl(uint32_t handle)
+    : mHandle(handle),
+      mGetCount(0),
+      mGetFound(0),
+      mReleaseCount(0),
+      mReleaseFound(0)
+{
+}
+
+FakeCapl::~FakeCapl()
+{
+    for (std::map<std::string, FakeCaplFunction*>::iterator it = mFunctions.begin(); it != mFunctions.end(); ++it)
+    {
+        delete it->second;
+    }
+}
+
+VIASTDDEF FakeCapl::GetVersion(int32* major, int32* minor)
+{
+    *major = VIACDLLMajorVersion;
+    *minor = VIACDLLMinorVersion;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeCapl::GetCaplHandle(uint32* handle)
+{
+    *handle = mHandle;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeCapl::GetCaplFunction(VIACaplFunction** caplfct, const char* functionName)
+{
+    mGetCount++;
+    FakeCaplFunction* function = Function(functionName);
+    *caplfct = function;
+    if (function == nullptr)
+    {
+        return kVIA_ObjectNotFound;
+    }
+    mGetFound++;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeCapl::ReleaseCaplFunction(VIACaplFunction* caplfct)
+{
+    /* CANoe accepts a nullptr, capldll.cpp relies on it. */
+    mReleaseCount++;
+    if (caplfct != nullptr)
+    {
+        mReleaseFound++;
+    }
+    return kVIA_OK;
+}
+
+FakeCaplFunction* FakeCapl::AddFunction(const char* name, char resultType, const char* paramTypes, const char* arrays)
+{
+    FakeCaplFunction*& function = mFunctions[name];
+    delete function;
+    function = new FakeCaplFunction(name, resultType, paramTypes, arrays);
+    return function;
+}
+
+FakeCaplFunction* FakeCapl::Function(const char* name) const
+{
+    std::map<std::string, FakeCaplFunction*>::const_iterator it = mFunctions.find(name);
+    return it == mFunctions.end() ? nullptr : it->second;
+}
+
+/* ========================================================================== */
+/* FakeTimer                                                                  */
+/* ========================================================================== */
+
+FakeTimer::FakeTimer(FakeVIAService* service, VIAOnTimerSink* sink, const char* name)
+    : mService(service),
+      mSink(sink),
+      mName(name != nullptr ? name : ""),
+      mArmed(false),
+      mDue(0),
+      mFireCount(0)
+{
+}
+
+VIASTDDEF FakeTimer::SetSink(VIAOnTimerSink* sink)
+{
+    mSink = sink;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeTimer::SetName(const char* name)
+{
+    mName = (name != nullptr) ? name : "";
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeTimer::SetTimer(VIATime nanoseconds)
+{
+    if (nanoseconds < 0)
+    {
+        return kVIA_ParameterInvalid;
+    }
+    mArmed = true;
+    mDue = mService->Now() + nanoseconds;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeTimer::CancelTimer()
+{
+    mArmed = false;
+    return kVIA_OK;
+}
+
+/* ========================================================================== */
+/* FakeDebugInfoService                                                       */
+/* ========================================================================== */
+
+FakeDebugInfoService::FakeDebugInfoService()
+    : mLevel(kVIADebugLogLevel_Basic),
+      mReleaseCount(0)
+{
+}
+
+VIASTDDEF FakeDebugInfoService::Release()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mReleaseCount++;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeDebugInfoService::WriteKnownMessage0(uint32, uint32)
+{
+    return kVIA_FunctionNotImplemented;
+}
+
+VIASTDDEF FakeDebugInfoService::WriteKnownMessage1(uint32, uint32, const char*)
+{
+    return kVIA_FunctionNotImplemented;
+}
+
+VIASTDDEF FakeDebugInfoService::WriteKnownMessage2(uint32, uint32, const char*, const char*)
+{
+    return kVIA_FunctionNotImplemented;
+}
+
+VIASTDDEF FakeDebugInfoService::WriteKnownMessage3(uint32, uint32, const char*, const char*, const char*)
+{
+    return kVIA_FunctionNotImplemented;
+}
+
+VIASTDDEF FakeDebugInfoService::AssertFail(const char* condition, const char* file, int32 line)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMessages.push_back(std::string("assert: ") + condition + " (" + file + ":" + std::to_string(line) + ")");
+    return kVIA_OK;
+}
+
+bool FakeDebugInfoService::IsLoggingActive()
+{
+    return mLevel != kVIADebugLogLevel_Inactive;
+}
+
+VIASTDDEF FakeDebugInfoService::GetLogLevel(int32, VIADebugLogLevel* outLogLevel)
+{
+    *outLogLevel = mLevel;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeDebugInfoService::GetLogComponentId(const char*, int32* outComponentId)
+{
+    *outComponentId = 0;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeDebugInfoService::WriteLogMessage(const char* logComponentName, const char* msg)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMessages.push_back(std::string(logComponentName) + ": " + msg);
+    return kVIA_OK;
+}
+
+std::vector<std::string> FakeDebugInfoService::Messages() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMessages;
+}
+
+void FakeDebugInfoService::Reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMessages.clear();
+    mReleaseCount = 0;
+}
+
+/* ========================================================================== */
+/* FakeVIAService                                                             */
+/* ========================================================================== */
+
+FakeVIAService::FakeVIAService()
+    : mNow(0)
+{
+}
+
+FakeVIAService::~FakeVIAService()
+{
+    for (size_t i = 0; i < mTimers.size(); i++)
+    {
+        delete mTimers[i];
+    }
+}
+
+void FakeVIAService::AdvanceTime(VIATime nanoseconds)
+{
+    VIATime target = mNow + nanoseconds;
+    for (;;)
+    {
+        /* Timers may be armed, cancelled or released by OnTimer, search again every time. */
+        FakeTimer* next = nullptr;
+        for (size_t i = 0; i < mTimers.size(); i++)
+        {
+            if (mTimers[i]->mArmed && mTimers[i]->mDue <= target && (next == nullptr || mTimers[i]->mDue < next->mDue))
+            {
+                next = mTimers[i];
+            }
+        }
+        if (next == nullptr)
+        {
+            break;
+        }
+        mNow = next->mDue;
+        next->mArmed = false;
+        next->mFireCount++;
+        if (next->mSink != nullptr)
+        {
+            next->mSink->OnTimer(mNow);
+        }
+    }
+    mNow = target;
+}
+
+std::vector<std::string> FakeVIAService::Written() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWritten;
+}
+
+std::vector<std::string> FakeVIAService::Logged() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLogged;
+}
+
+uint64_t FakeVIAService::CallCount(const char* method) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::map<std::string, uint64_t>::const_iterator it = mCalls.find(method);
+    return it == mCalls.end() ? 0 : it->second;
+}
+
+void FakeVIAService::Count(const char* method)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCalls[method]++;
+}
+
+VIAResult FakeVIAService::NotImplemented(const char* method)
+{
+    Count(method);
+    return kVIA_FunctionNotImplemented;
+}
+
+VIASTDDEF FakeVIAService::GetVersion(int32* major, int32* minor, int32* patchlevel)
+{
+    Count("GetVersion");
+    *major = VIAMajorVersion;
+    *minor = VIAMinorVersion;
+    *patchlevel = 0;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::CreateTimer(VIATimer** timer, VIANode*, VIAOnTimerSink* sink, const char* name)
+{
+    Count("CreateTimer");
+    FakeTimer* created = new (std::nothrow) FakeTimer(this, sink, name);
+    if (created == nullptr)
+    {
+        return kVIA_Failed;
+    }
+    mTimers.push_back(created);
+    *timer = created;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::ReleaseTimer(VIATimer* timer)
+{
+    Count("ReleaseTimer");
+    std::vector<FakeTimer*>::iterator it = std::find(mTimers.begin(), mTimers.end(), timer);
+    if (it == mTimers.end())
+    {
+        return kVIA_ObjectNotFound;
+    }
+    delete *it;
+    mTimers.erase(it);
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::WriteString(const char* text)
+{
+    Count("WriteString");
+    std::lock_guard<std::mutex> lock(mMutex);
+    mWritten.push_back(text);
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::WriteToLog(const char* text)
+{
+    Count("WriteToLog");
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLogged.push_back(text);
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::RtKernelIsRunning()
+{
+    Count("RtKernelIsRunning");
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::GetCurrentSimTime(VIATime* time)
+{
+    Count("GetCurrentSimTime");
+    *time = mNow;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::Stop()
+{
+    Count("Stop");
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::GetDebugInfoService(VIADebugInfoService** ppService)
+{
+    Count("GetDebugInfoService");
+    *ppService = &mDebugInfo;
+    return kVIA_OK;
+}
+
+VIASTDDEF FakeVIAService::GetClientWindow(void**)
+{
+    return NotImplemented("GetClientWindow");
+}
+
+VIASTDDEF FakeVIAService::GetConfigItem(uint32, uint32, char*, int32)
+{
+    return NotImplemented("GetConfigItem");
+}
+
+VIASTDDEF FakeVIAService::GetDBAttributeType(uint32*, uint32, const char*, const char*, const char*)
+{
+    return NotImplemented("GetDBAttributeType");
+}
+
+VIASTDDEF FakeVIAService::GetDBAttributeValue(double*, uint32, const char*, const char*, const char*)
+{
+    return NotImplemented("GetDBAttributeValue");
+}
+
+VIASTDDEF FakeVIAService::GetDBAttributeString(char*, int32, uint32, const char*, const char*, const char*)
+{
+    return NotImplemented("GetDBAttributeString");
+}
+
+VIASTDDEF FakeVIAService::GetEnvVar(VIAEnvVar**, VIANode*, const char*, VIAOnEnvVar*)
+{
+    return NotImplemented("GetEnvVar");
+}
+
+VIASTDDEF FakeVIAService::ReleaseEnvVar(VIAEnvVar*)
+{
+    return NotImplemented("ReleaseEnvVar");
+}
+
+VIASTDDEF FakeVIAService::GetBusInterface(VIABus**, VIANode*, uint32, int32, int32)
+{
+    return NotImplemented("GetBusInterface");
+}
+
+VIASTDDEF FakeVIAService::ReleaseBusInterface(VIABus*)
+{
+    return NotImplemented("ReleaseBusInterface");
+}
+
+VIASTDDEF FakeVIAService::GetUtilService(VIAUtil**, int32, int32)
+{
+    return NotImplemented("GetUtilService");
+}
+
+VIASTDDEF FakeVIAService::ReleaseUtilService(VIAUtil*)
+{
+    return NotImplemented("ReleaseUtilService");
+}
+
+VIASTDDEF FakeVIAService::Assertion(char*, char*, char*, int32)
+{
+    return NotImplemented("Assertion");
+}
+
+VIASTDDEF FakeVIAService::MsgBox(char*)
+{
+    return NotImplemented("MsgBox");
+}
+
+VIASTDDEF FakeVIAService::GetCurrentNode(VIANode**)
+{
+    return NotImplemented("GetCurrentNode");
+}
+
+VIASTDDEF FakeVIAService::GetCurrentNodeLayer(VIANodeLayerApi**, VIAModuleApi*)
+{
+    return NotImplemented("GetCurrentNodeLayer");
+}
+
+VIASTDDEF FakeVIAService::GetSystemFiber(void**)
+{
+    return NotImplemented("GetSystemFiber");
+}
+
+VIASTDDEF FakeVIAService::GetServiceFlags(uint32*)
+{
+    return NotImplemented("GetServiceFlags");
+}
+
+VIASTDDEF FakeVIAService::CreateWriteTab(uint32*, const char*)
+{
+    return NotImplemented("CreateWriteTab");
+}
+
+VIASTDDEF FakeVIAService::ReleaseWriteTab(uint32)
+{
+    return NotImplemented("ReleaseWriteTab");
+}
+
+VIASTDDEF FakeVIAService::WriteStringToTab(uint32, VIAWriteSeverity, const char*)
+{
+    return NotImplemented("WriteStringToTab");
+}
+
+VIASTDDEF FakeVIAService::GetTestControlApi(VIATestControlApi**, VIANode*)
+{
+    return NotImplemented("GetTestControlApi");
+}
+
+VIASTDDEF FakeVIAService::ReleaseTestControlApi(VIATestControlApi*)
+{
+    return NotImplemented("ReleaseTestControlApi");
+}
+
+VIASTDDEF FakeVIAService::ClearWriteTab(uint32)
+{
+    return NotImplemented("ClearWriteTab");
+}
+
+VIASTDDEF FakeVIAService::SetNLServiceApi(VIANLServiceApi*, VIANode*)
+{
+    return NotImplemented("SetNLServiceApi");
+}
+
+VIASTDDEF FakeVIAService::ProvideNLService(int8, VIANLService*, VIANode*, VIANLServiceApi*)
+{
+    return NotImplemented("ProvideNLService");
+}
+
+VIASTDDEF FakeVIAService::AcquireNLService(const char*, int32, VIANLService**, VIANode*, VIANLServiceApi*)
+{
+    return NotImplemented("AcquireNLService");
+}
+
+VIASTDDEF FakeVIAService::CancelNLService(VIANLService*, VIANode*, VIANLServiceApi*)
+{
+    return NotImplemented("CancelNLService");
+}
+
+VIASTDDEF FakeVIAService::ReleaseNLService(VIANLService*, VIANode*, VIANLServiceApi*)
+{
+    return NotImplemented("ReleaseNLService");
+}
+
+VIASTDDEF FakeVIAService::GetSignalAccessApi(VIASignalAccessApi**, VIANode*, int32, int32)
+{
+    return NotImplemented("GetSignalAccessApi");
+}
+
+VIASTDDEF FakeVIAService::GetSystemVariablesRootNamespace(VIANamespace*&)
+{
+    return NotImplemented("GetSystemVariablesRootNamespace");
+}
+
+VIASTDDEF FakeVIAService::RegisterSystemVariablesClient(VIASysVarClientHandle, const char*)
+{
+    return NotImplemented("RegisterSystemVariablesClient");
+}
+
+VIASTDDEF FakeVIAService::UnregisterSystemVariablesClient(VIASysVarClientHandle)
+{
+    return NotImplemented("UnregisterSystemVariablesClient");
+}
+
+VIASTDDEF FakeVIAService::GetDatabaseIterator(VIDBDatabaseIterator**)
+{
+    return NotImplemented("GetDatabaseIterator");
+}
+
+VIASTDDEF FakeVIAService::DebugBreak()
+{
+    return NotImplemented("DebugBreak");
+}
+
+VIASTDDEF FakeVIAService::IsSimulated(int32*)
+{
+    return NotImplemented("IsSimulated");
+}
+
+VIASTDDEF FakeVIAService::GetSocketService(VIASocketService**, VIANode*, VIASocketServiceType)
+{
+    return NotImplemented("GetSocketService");
+}
+
+VIASTDDEF FakeVIAService::ReleaseSocketService(VIASocketService*)
+{
+    return NotImplemented("ReleaseSocketService");
+}
+
+VIASTDDEF FakeVIAService::NotifyDiagnosticEvent(VIAProtocolType, void*, int32, int8[], uint32)
+{
+    return NotImplemented("NotifyDiagnosticEvent");
+}
+
+VIASTDDEF FakeVIAService::GetDiagDescription(const char*, char*, int32, char*, int32, char*, int32, char*, int32)
+{
+    return NotImplemented("GetDiagDescription");
+}
+
+VIASTDDEF FakeVIAService::GetSerialService(VIASerialService**, VIANode*, VIASerialServiceType)
+{
+    return NotImplemented("GetSerialService");
+}
+
+VIASTDDEF FakeVIAService::ReleaseSerialService(VIASerialService*)
+{
+    return NotImplemented("ReleaseSerialService");
+}
+
+VIASTDDEF FakeVIAService::GetUserFilePath(const char*, char*, int32)
+{
+    return NotImplemented("GetUserFilePath");
+}
+
+VIASTDDEF FakeVIAService::GetSystemVariablesDefaultClientHandle(VIASysVarClientHandle*, VIAModuleApi*)
+{
+    return NotImplemented("GetSystemVariablesDefaultClientHandle");
+}
+
+VIASTDDEF FakeVIAService::RegisterUserFile(const char*, bool)
+{
+    return NotImplemented("RegisterUserFile");
+}
+
+VIASTDDEF FakeVIAService::IncrementTimerBase(VIATime, int32)
+{
+    return NotImplemented("IncrementTimerBase");
+}
+
+VIASTDDEF FakeVIAService::IsSlaveMode(bool*)
+{
+    return NotImplemented("IsSlaveMode");
+}
+
+VIASTDDEF FakeVIAService::GetCAPLonBoardConstruction(VIACAPLonBoardConstruction**)
+{
+    return NotImplemented("GetCAPLonBoardConstruction");
+}
+
+VIASTDDEF FakeVIAService::ReleaseCAPLonBoardConstruction(VIACAPLonBoardConstruction*)
+{
+    return NotImplemented("ReleaseCAPLonBoardConstruction");
+}
+
+VIASTDDEF FakeVIAService::GetTestApi(VIATestApi**, VIANode*)
+{
+    return NotImplemented("GetTestApi");
+}
+
+VIASTDDEF FakeVIAService::ReleaseTestApi(VIATestApi*)
+{
+    return NotImplemented("ReleaseTestApi");
+}
+
+VIASTDDEF FakeVIAService::GetSocketServiceEx(VIASocketServiceEx**, VIANode*)
+{
+    return NotImplemented("GetSocketServiceEx");
+}
+
+VIASTDDEF FakeVIAService::ReleaseSocketServiceEx(VIASocketServiceEx*)
+{
+    return NotImplemented("ReleaseSocketServiceEx");
+}
+
+VIASTDDEF FakeVIAService::GetParameterServerService(VIAParameterServerService**)
+{
+    return NotImplemented("GetParameterServerService");
+}
+
+VIASTDDEF FakeVIAService::SetNLServiceApi2(VIANLServiceApi*, VIANode*, VIANLServiceExecutionMode)
+{
+    return NotImplemented("SetNLServiceApi2");
+}
+
+VIASTDDEF FakeVIAService::ProvideNLService2(int8, VIANLService*, VIANode*, VIANLServiceApi*, VIANLServiceExecutionMode)
+{
+    return NotImplemented("ProvideNLService2");
+}
+
+VIASTDDEF FakeVIAService::AcquireNLService2(const char*, int32, VIANLService**, VIANode*, VIANLServiceApi*, VIANLServiceExecutionMode)
+{
+    return NotImplemented("AcquireNLService2");
+}
+
+VIASTDDEF FakeVIAService::CancelNLService2(VIANLService*, VIANode*, VIANLServiceApi*, VIANLServiceExecutionMode)
+{
+    return NotImplemented("CancelNLService2");
+}
+
+VIASTDDEF FakeVIAService::ReleaseNLService2(VIANLService*, VIANode*, VIANLServiceApi*, VIANLServiceExecutionMode)
+{
+    return NotImplemented("ReleaseNLService2");
+}
+
+VIASTDDEF FakeVIAService::GetSynchronizedFilePath(const char*, char*, uint32)
+{
+    return NotImplemented("GetSynchronizedFilePath");
+}
+
+VIASTDDEF FakeVIAService::GetMediaService(VIAMediaService**, VIANode*)
+{
+    return NotImplemented("GetMediaService");
+}
+
+VIASTDDEF FakeVIAService::ReleaseMediaService(VIAMediaService*)
+{
+    return NotImplemented("ReleaseMediaService");
+}
+
+VIASTDDEF FakeVIAService::GetCurrentClient(void**)
+{
+    return NotImplemented("GetCurrentClient");
+}
+
+VIASTDDEF FakeVIAService::GetClient(VIANode*, void**)
+{
+    return NotImplemented("GetClient");
+}
+
+VIASTDDEF FakeVIAService::SetCurrentClient(void*)
+{
+    return NotImplemented("SetCurrentClient");
+}
+
+VIASTDDEF FakeVIAService::GetBusContext(VIANode*, uint32*, uint32*)
+{
+    return NotImplemented("GetBusContext");
+}
+
+VIASTDDEF FakeVIAService::SetBusContext(VIANode*, uint32, uint32)
+{
+    return NotImplemented("SetBusContext");
+}
+
+VIASTDDEF FakeVIAService::GetFunctionBusService(VIAFbViaService**, int32, int32)
+{
+    return NotImplemented("GetFunctionBusService");
+}
+
+VIASTDDEF FakeVIAService::ReleaseFunctionBusService(VIAFbViaService*)
+{
+    return NotImplemented("ReleaseFunctionBusService");
+}
+
+VIASTDDEF FakeVIAService::RegisterCoreProcessingFunction(ICoreProcessingFunction*, bool, uint32*)
+{
+    return NotImplemented("RegisterCoreProcessingFunction");
+}
+
+VIASTDDEF FakeVIAService::UnregisterCoreProcessingFunction(uint32)
+{
+    return NotImplemented("UnregisterCoreProcessingFunction");
+}
+
+VIASTDDEF FakeVIAService::GetSocketService2(VIASocketService2**, VIANode*, VIASocketServiceType)
+{
+    return NotImplemented("GetSocketService2");
+}
+
+VIASTDDEF FakeVIAService::ReleaseSocketService2(VIASocketService2*)
+{
+    return NotImplemented("ReleaseSocketService2");
+}
+
+VIASTDDEF FakeVIAService::GetSocketServiceEx2(VIASocketServiceEx2**, VIANode*)
+{
+    return NotImplemented("GetSocketServiceEx2");
+}
+
+VIASTDDEF FakeVIAService::ReleaseSocketServiceEx2(VIASocketServiceEx2*)
+{
+    return NotImplemented("ReleaseSocketServiceEx2");
+}
+
+VIASTDDEF FakeVIAService::GetFBDataModelIterator(VIDBDatabaseIterator**)
+{
+    return NotImplemented("GetFBDataModelIterator");
+}
+
+VIASTDDEF FakeVIAService::IsValidLicense(uint32, uint32, uint32)
+{
+    return NotImplemented("IsValidLicense");
+}
@@ -0,0 +1,359 @@
+/**
+ * @file fakevia.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Host-side fakes of the VIA objects CANoe hands to a CAPL DLL.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * With these fakes the CAPL DLL life cycle (VIARegisterCDLL, dllInit, the
+ * CAPL callbacks, dllEnd) runs on Linux without CANoe. Every fake counts how
+ * often it is used and the CAPL functions keep copies of the parameter
+ * buffers they were called with, so the call stack layout built by the DLL
+ * can be checked byte by byte. FakeCaplHandler reads the buffer back with
+ * the layout of caplcall.h.
+ */
+#ifndef FAKEVIA_H
+#define FAKEVIA_H
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "VIA.h"
+#include "VIA_CDLL.h"
+#include "caplcall.h"
+
+/**
+ * @brief A CAPL function implemented by the test instead of a CAPL program.
+ *
+ * The signature is given like in the function table of the DLL: the result
+ * type, one type character per parameter and, optionally, one '0'/'1' per
+ * parameter marking arrays. 'C' parameters are always arrays. The size of
+ * the parameter buffer follows the CAPL call stack: 8 bytes per scalar and
+ * 16 per array on 64 bit, 4 and 8 on 32 bit.
+ */
+class FakeCaplFunction final : public VIACaplFunction
+{
+public:
+    typedef std::function<uint32_t(const uint8_t* params)> Handler;
+
+    FakeCaplFunction(const char* name, char resultType, const char* paramTypes, const char* arrays = nullptr);
+
+    VIASTDDECL ParamSize(int32* size);
+    VIASTDDECL ParamCount(int32* size);
+    VIASTDDECL ParamType(char* type, int32 nth);
+    VIASTDDECL ResultType(char* type);
+    VIASTDDECL Call(uint32* result, void* params);
+    VIASTDDECL CallReturnsDouble(double* result, void* params);
+
+    const std::string& Name() const { return mName; }
+
+    /* Result of the next calls, used when no handler is set. */
+    void SetResult(uint32_t result);
+    /* Computes the result from the parameter buffer. */
+    void SetHandler(const Handler& handler);
+    /* Number of parameter buffers kept, the oldest ones are dropped (default 16). */
+    void SetHistoryLimit(size_t limit);
+
+    uint64_t CallCount() const;
+    /* Copy of the parameter buffer of the latest call, empty before the first call. */
+    std::vector<uint8_t> LastParams() const;
+    /* Parameter buffers of the latest calls, oldest first. */
+    std::vector<std::vector<uint8_t> > History() const;
+    void Reset();
+
+private:
+    uint32_t Invoke(const void* params);
+
+    std::string                        mName;
+    char                               mResultType;
+    std::string                        mParamTypes;
+    int32_t                            mParamSize;
+    mutable std::mutex                 mMutex;
+    uint32_t                           mResult;
+    Handler                            mHandler;
+    size_t                             mHistoryLimit;
+    uint64_t                           mCallCount;
+    std::vector<std::vector<uint8_t> > mHistory;
+};
+
+/**
+ * @brief Calls a C++ function with the parameters of a CAPL function of the
+ *        signature R(Args...), the one given to CaplCallback in the DLL.
+ */
+template <typename Signature>
+struct FakeCaplDecoder;
+
+template <typename R, typename... Args>
+struct FakeCaplDecoder<R(Args...)>
+{
+    template <typename F>
+    static FakeCaplFunction::Handler Handler(F function)
+    {
+        return [function](const uint8_t* params) -> uint32_t {
+            return Call(function, params, std::index_sequence_for<Args...>());
+        };
+    }
+
+    template <typename F, size_t... I>
+    static uint32_t Call(const F& function, const uint8_t* params, std::index_sequence<I...>)
+    {
+        (void)params; /* a function without parameters does not read it */
+        if constexpr (std::is_void<R>::value)
+        {
+            function(CaplParam<Args>::Load(params + CaplOffset<I, Args...>::kValue)...);
+            return 0;
+        }
+        else
+        {
+            return (uint32_t)function(CaplParam<Args>::Load(params + CaplOffset<I, Args...>::kValue)...);
+        }
+    }
+};
+
+/*
+ * Handler for FakeCaplFunction::SetHandler receiving the parameters as C++
+ * values, e.g. FakeCaplHandler<void(int32_t, double)>([&](int32_t rule, double time) { ... }).
+ */
+template <typename Signature, typename F>
+FakeCaplFunction::Handler FakeCaplHandler(F function)
+{
+    return FakeCaplDecoder<Signature>::Handler(function);
+}
+
+/**
+ * @brief A CAPL program as seen by VIARegisterCDLL.
+ */
+class FakeCapl : public VIACapl
+{
+public:
+    explicit FakeCapl(uint32_t handle);
+    ~FakeCapl();
+
+    VIASTDDECL GetVersion(int32* major, int32* minor);
+    VIASTDDECL GetCaplHandle(uint32* handle);
+    VIASTDDECL GetCaplFunction(VIACaplFunction** caplfct, const char* functionName);
+    VIASTDDECL ReleaseCaplFunction(VIACaplFunction* caplfct);
+
+    /* Define a function of the CAPL program, see FakeCaplFunction. Owned by the program. */
+    FakeCaplFunction* AddFunction(const char* name, char resultType, const char* paramTypes,
+                                  const char* arrays = nullptr);
+    /* Function by name, nullptr if it was not added. */
+    FakeCaplFunction* Function(const char* name) const;
+
+    uint64_t GetCount() const { return mGetCount; }
+    /* ReleaseCaplFunction calls, including the ones with a nullptr function. */
+    uint64_t ReleaseCount() const { return mReleaseCount; }
+    /* Handles handed out by GetCaplFunction and not released yet. */
+    int64_t Outstanding() const { return (int64_t)mGetFound - (int64_t)mReleaseFound; }
+
+private:
+    uint32_t                                 mHandle;
+    std::map<std::string, FakeCaplFunction*> mFunctions;
+    uint64_t                                 mGetCount;
+    uint64_t                                 mGetFound;
+    uint64_t                                 mReleaseCount;
+    uint64_t                                 mReleaseFound;
+};
+
+class FakeVIAService;
+
+/**
+ * @brief A timer running on the simulated time of a FakeVIAService.
+ */
+class FakeTimer final : public VIATimer
+{
+public:
+    FakeTimer(FakeVIAService* service, VIAOnTimerSink* sink, const char* name);
+
+    VIASTDDECL SetSink(VIAOnTimerSink* sink);
+    VIASTDDECL SetName(const char* name);
+    VIASTDDECL SetTimer(VIATime nanoseconds);
+    VIASTDDECL CancelTimer();
+
+    bool IsArmed() const { return mArmed; }
+    VIATime Due() const { return mDue; }
+    const std::string& Name() const { return mName; }
+    uint64_t FireCount() const { return mFireCount; }
+
+private:
+    friend class FakeVIAService;
+
+    FakeVIAService* mService;
+    VIAOnTimerSink* mSink;
+    std::string     mName;
+    bool            mArmed;
+    VIATime         mDue;
+    uint64_t        mFireCount;
+};
+
+/**
+ * @brief The debug and logging service of CANoe, records every log message.
+ */
+class FakeDebugInfoService : public VIADebugInfoService
+{
+public:
+    FakeDebugInfoService();
+
+    VIASTDDECL Release();
+    VIASTDDECL WriteKnownMessage0(uint32 moduleId, uint32 messageId);
+    VIASTDDECL WriteKnownMessage1(uint32 moduleId, uint32 messageId, const char* param1);
+    VIASTDDECL WriteKnownMessage2(uint32 moduleId, uint32 messageId, const char* param1, const char* param2);
+    VIASTDDECL WriteKnownMessage3(uint32 moduleId, uint32 messageId, const char* param1, const char* param2,
+                                  const char* param3);
+    VIASTDDECL AssertFail(const char* condition, const char* file, int32 line);
+    VIABOOLDECL IsLoggingActive();
+    VIASTDDECL GetLogLevel(int32 componentId, VIADebugLogLevel* outLogLevel);
+    VIASTDDECL GetLogComponentId(const char* logComponentName, int32* outComponentId);
+    VIASTDDECL WriteLogMessage(const char* logComponentName, const char* msg);
+
+    void SetLogLevel(VIADebugLogLevel level) { mLevel = level; }
+    /* "<component>: <message>" for every WriteLogMessage call. */
+    std::vector<std::string> Messages() const;
+    uint64_t ReleaseCount() const { return mReleaseCount; }
+    void Reset();
+
+private:
+    mutable std::mutex       mMutex;
+    VIADebugLogLevel         mLevel;
+    std::vector<std::string> mMessages;
+    uint64_t                 mReleaseCount;
+};
+
+/**
+ * @brief The VIA service of CANoe with a simulated measurement time.
+ *
+ * Version, timers, Write window output, the simulation time and the debug
+ * info service behave like in CANoe. All other methods are counted and
+ * return kVIA_FunctionNotImplemented. The simulated time only advances with
+ * AdvanceTime, which fires the due timers in order of their due time.
+ * Counting and recording are thread safe, timers are meant to be driven by
+ * a single thread.
+ */
+class FakeVIAService : public VIAService
+{
+public:
+    FakeVIAService();
+    ~FakeVIAService();
+
+    /* Move the simulated time forward and fire all timers that become due. */
+    void AdvanceTime(VIATime nanoseconds);
+    VIATime Now() const { return mNow; }
+    /* Text written with WriteString, one entry per call. */
+    std::vector<std::string> Written() const;
+    /* Text written with WriteToLog, one entry per call. */
+    std::vector<std::string> Logged() const;
+    /* Calls of a method of this service by name, e.g. "CreateTimer". */
+    uint64_t CallCount(const char* method) const;
+    const std::vector<FakeTimer*>& Timers() const { return mTimers; }
+    FakeDebugInfoService* DebugInfo() { return &mDebugInfo; }
+
+    VIASTDDECL GetVersion(int32* major, int32* minor, int32* patchlevel);
+    VIASTDDECL CreateTimer(VIATimer** timer, VIANode* node, VIAOnTimerSink* sink, const char* name);
+    VIASTDDECL ReleaseTimer(VIATimer* timer);
+    VIASTDDECL WriteString(const char* text);
+    VIASTDDECL WriteToLog(const char* text);
+    VIASTDDECL RtKernelIsRunning();
+    VIASTDDECL GetCurrentSimTime(VIATime* time);
+    VIASTDDECL Stop();
+    VIASTDDECL GetDebugInfoService(VIADebugInfoService** ppService);
+
+    /* Not implemented */
+    VIASTDDECL GetClientWindow(void** handle);
+    VIASTDDECL GetConfigItem(uint32 topic, uint32 subtopic, char* buffer, int32 bufferLength);
+    VIASTDDECL GetDBAttributeType(uint32* attributeType, uint32 objectType, const char* objectName, const char* attrName, const char* dbName);
+    VIASTDDECL GetDBAttributeValue(double* attributeValue, uint32 objectType, const char* objectName, const char* attrName, const char* dbName);
+    VIASTDDECL GetDBAttributeString(char* buffer, int32 bufferLength, uint32 objectType, const char* objectName, const char* attrName, const char* dbName);
+    VIASTDDECL GetEnvVar(VIAEnvVar** ev, VIANode* node, const char* name, VIAOnEnvVar* sink);
+    VIASTDDECL ReleaseEnvVar(VIAEnvVar* ev);
+    VIASTDDECL GetBusInterface(VIABus** busInterface, VIANode* node, uint32 interfaceType, int32 majorversion, int32 minorversion);
+    VIASTDDECL ReleaseBusInterface(VIABus* busInterface);
+    VIASTDDECL GetUtilService(VIAUtil** service, int32 majorversion, int32 minorversion);
+    VIASTDDECL ReleaseUtilService(VIAUtil* service);
+    VIASTDDECL Assertion(char* message, char* condition, char* file, int32 line);
+    VIASTDDECL MsgBox(char* message);
+    VIASTDDECL GetCurrentNode(VIANode** node);
+    VIASTDDECL GetCurrentNodeLayer(VIANodeLayerApi** nodelayer, VIAModuleApi* module);
+    VIASTDDECL GetSystemFiber(void** fiber);
+    VIASTDDECL GetServiceFlags(uint32* flags);
+    VIASTDDECL CreateWriteTab(uint32* aSink, const char* aSinkName);
+    VIASTDDECL ReleaseWriteTab(uint32 aSink);
+    VIASTDDECL WriteStringToTab(uint32 aSink, VIAWriteSeverity aSeverity, const char* aText);
+    VIASTDDECL GetTestControlApi(VIATestControlApi** apTestControlObject, VIANode* node);
+    VIASTDDECL ReleaseTestControlApi(VIATestControlApi* apTestControlObject);
+    VIASTDDECL ClearWriteTab(uint32 aSink);
+    VIASTDDECL SetNLServiceApi(VIANLServiceApi* apNLServiceMember, VIANode* apMyNode);
+    VIASTDDECL ProvideNLService(int8 aMultiUserService, VIANLService* apServiceToProvide, VIANode* apMyNode, VIANLServiceApi* apNLServiceProvider);
+    VIASTDDECL AcquireNLService(const char* apServiceName, int32 aInterfaceVersion, VIANLService** appService, VIANode* apMyNode, VIANLServiceApi* apNLServiceUser);
+    VIASTDDECL CancelNLService(VIANLService* apServiceToCancel, VIANode* apMyNode, VIANLServiceApi* apNLServiceProvider);
+    VIASTDDECL ReleaseNLService(VIANLService* apServiceToRelease, VIANode* apMyNode, VIANLServiceApi* apNLServiceUser);
+    VIASTDDECL GetSignalAccessApi(VIASignalAccessApi** aSignalAccessApi, VIANode* aNode, int32 majorversion, int32 minorversion);
+    VIASTDDECL GetSystemVariablesRootNamespace(VIANamespace*& nameSpace);
+    VIASTDDECL RegisterSystemVariablesClient(VIASysVarClientHandle handle, const char* description);
+    VIASTDDECL UnregisterSystemVariablesClient(VIASysVarClientHandle handle);
+    VIASTDDECL GetDatabaseIterator(VIDBDatabaseIterator** iterator);
+    VIASTDDECL DebugBreak();
+    VIASTDDECL IsSimulated(int32* simulated);
+    VIASTDDECL GetSocketService(VIASocketService** ppService, VIANode* pNode, VIASocketServiceType type);
+    VIASTDDECL ReleaseSocketService(VIASocketService* pService);
+    VIASTDDECL NotifyDiagnosticEvent(VIAProtocolType type, void* params, int32 request, int8 buffer[], uint32 size);
+    VIASTDDECL GetDiagDescription(const char* aEcuQualifier_in, char* apEcuId_out, int32 aLenEcuId, char* apVariantQualifier_out, int32 aLenVariantQualifier, char* apLanguage_out, int32 aLenLanguage, char* apPath_out, int32 aLenPath);
+    VIASTDDECL GetSerialService(VIASerialService** ppService, VIANode* pNode, VIASerialServiceType type);
+    VIASTDDECL ReleaseSerialService(VIASerialService* pService);
+    VIASTDDECL GetUserFilePath(const char* filename, char* pathBuffer, int32 pathBufferLength);
+    VIASTDDECL GetSystemVariablesDefaultClientHandle(VIASysVarClientHandle* handle, VIAModuleApi* module);
+    VIASTDDECL RegisterUserFile(const char* filePath, bool isTempRegistration);
+    VIASTDDECL IncrementTimerBase(VIATime newTimeBaseTicks, int32 numberOfTicks);
+    VIASTDDECL IsSlaveMode(bool* isSlaveMode);
+    VIASTDDECL GetCAPLonBoardConstruction(VIACAPLonBoardConstruction** cob);
+    VIASTDDECL ReleaseCAPLonBoardConstruction(VIACAPLonBoardConstruction* cob);
+    VIASTDDECL GetTestApi(VIATestApi** apTestApi, VIANode* pNode);
+    VIASTDDECL ReleaseTestApi(VIATestApi* apTestApi);
+    VIASTDDECL GetSocketServiceEx(VIASocketServiceEx** ppService, VIANode* pNode);
+    VIASTDDECL ReleaseSocketServiceEx(VIASocketServiceEx* pService);
+    VIASTDDECL GetParameterServerService(VIAParameterServerService** pVIAParameterServerService);
+    VIASTDDECL SetNLServiceApi2(VIANLServiceApi* apNLServiceMember, VIANode* apMyNode, VIANLServiceExecutionMode execMode);
+    VIASTDDECL ProvideNLService2(int8 aMultiUserService, VIANLService* apServiceToProvide, VIANode* apMyNode, VIANLServiceApi* apNLServiceProvider, VIANLServiceExecutionMode execMode);
+    VIASTDDECL AcquireNLService2(const char* apServiceName, int32 aInterfaceVersion, VIANLService** appService, VIANode* apMyNode, VIANLServiceApi* apNLServiceUser, VIANLServiceExecutionMode execMode);
+    VIASTDDECL CancelNLService2(VIANLService* apServiceToCancel, VIANode* apMyNode, VIANLServiceApi* apNLServiceProvider, VIANLServiceExecutionMode execMode);
+    VIASTDDECL ReleaseNLService2(VIANLService* apServiceToRelease, VIANode* apMyNode, VIANLServiceApi* apNLServiceUser, VIANLServiceExecutionMode execMode);
+    VIASTDDECL GetSynchronizedFilePath(const char* filename, char* pathBuffer, uint32 pathBufferLength);
+    VIASTDDECL GetMediaService(VIAMediaService** ppService, VIANode* pNode);
+    VIASTDDECL ReleaseMediaService(VIAMediaService* pService);
+    VIASTDDECL GetCurrentClient(void** pClient);
+    VIASTDDECL GetClient(VIANode* pNode, void** pClient);
+    VIASTDDECL SetCurrentClient(void* pClient);
+    VIASTDDECL GetBusContext(VIANode* pNode, uint32* channelType, uint32* channelNumber);
+    VIASTDDECL SetBusContext(VIANode* pNode, uint32 channelType, uint32 channelNumber);
+    VIASTDDECL GetFunctionBusService(VIAFbViaService** outFbViaService, int32 majorversion, int32 minorversion);
+    VIASTDDECL ReleaseFunctionBusService(VIAFbViaService* inFbViaService);
+    VIASTDDECL RegisterCoreProcessingFunction(ICoreProcessingFunction* fct, bool once, uint32* handle);
+    VIASTDDECL UnregisterCoreProcessingFunction(uint32 handle);
+    VIASTDDECL GetSocketService2(VIASocketService2** ppService, VIANode* pNode, VIASocketServiceType type);
+    VIASTDDECL ReleaseSocketService2(VIASocketService2* pService);
+    VIASTDDECL GetSocketServiceEx2(VIASocketServiceEx2** ppService, VIANode* pNode);
+    VIASTDDECL ReleaseSocketServiceEx2(VIASocketServiceEx2* pService);
+    VIASTDDECL GetFBDataModelIterator(VIDBDatabaseIterator** iterator);
+    VIASTDDECL IsValidLicense(uint32 productCode, uint32 productVersionMajor, uint32 productVersionMinor);
+
+private:
+    void Count(const char* method);
+    VIAResult NotImplemented(const char* method);
+
+    mutable std::mutex              mMutex;
+    VIATime                         mNow;
+    std::vector<FakeTimer*>         mTimers;
+    std::vector<std::string>        mWritten;
+    std::vector<std::string>        mLogged;
+    std::map<std::string, uint64_t> mCalls;
+    FakeDebugInfoService            mDebugInfo;
+};
+
+#endif
@@ -0,0 +1,586 @@
+/**
+ * @file harness.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief caplharness: loads the Linux build of the dll and calls it through caplDllTable5.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * The harness plays the part of CANoe: it dlopens libcapl.so, registers a
+ * fake CAPL program through VIARegisterCDLL and calls the exported functions
+ * by their table name. The arguments are built from the parameter types
+ * declared in the table, so a function is called exactly like CAPL would
+ * call it, including the 63 and 64 parameter functions. With --repeat every
+ * call is timed to load test the functions, with --threads the functions
+ * flagged thread safe are called from several threads at once, like
+ * parallel CAPL nodes would.
+ */
+#include <dlfcn.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cdll.h"
+#include "fakevia.h"
+#include "itechsim.h"
+#include "simtransport.h"
+#include "visasim.h"
+
+#define HARNESS_ARRAY_SIZE 256
+
+static const uint32_t kCaplHandle = 1;
+
+/*
+ * Every parameter is passed in one machine word. With the cdecl and System V
+ * conventions the caller removes the arguments, so a function may be called
+ * through a pointer with more parameters than it declares.
+ *
+ * A double by value takes two words with cdecl. System V passes the first
+ * eight in the floating point registers, apart from the words, so they are
+ * passed behind the 64 words and land in those registers in their order.
+ */
+typedef uintptr_t Slot;
+
+#define HARNESS_FLOAT_REGS 8
+
+#define SLOTS8  Slot, Slot, Slot, Slot, Slot, Slot, Slot, Slot
+#define SLOTS64 SLOTS8, SLOTS8, SLOTS8, SLOTS8, SLOTS8, SLOTS8, SLOTS8, SLOTS8
+#define FLOATS8 double, double, double, double, double, double, double, double
+#define ARGS8(s, o) s[o + 0], s[o + 1], s[o + 2], s[o + 3], s[o + 4], s[o + 5], s[o + 6], s[o + 7]
+#define ARGS64(s) ARGS8(s, 0), ARGS8(s, 8), ARGS8(s, 16), ARGS8(s, 24), ARGS8(s, 32), ARGS8(s, 40), ARGS8(s, 48), ARGS8(s, 56)
+
+typedef Slot (CAPLPASCAL *WordFunction)(SLOTS64, FLOATS8);
+typedef double (CAPLPASCAL *DoubleFunction)(SLOTS64, FLOATS8);
+
+/**
+ * @brief The words and the floating point registers of one call.
+ */
+struct HarnessFrame
+{
+    Slot   words[MAXCAPLFUNCPARS_8_1];
+    double floats[HARNESS_FLOAT_REGS];
+};
+
+/**
+ * @brief One argument of a call, with the memory arrays and references point to.
+ */
+struct HarnessArgument
+{
+    char                 type;      /* CAPL type without the reference bit */
+    bool                 reference; /* passed as a pointer to a scalar     */
+    bool                 array;     /* passed as a pointer to an array     */
+    std::vector<uint8_t> buffer;
+    double               number;
+};
+
+static const char* sDefaultText = "*IDN?";
+static int         sThreads = 1;
+
+static bool sIsDouble(char type)
+{
+    return (type & 0x7f) == 'F';
+}
+
+static char sBaseType(char type)
+{
+    return (char)(type & 0x7f);
+}
+
+static const char* sParamName(const CAPL_DLL_INFO5& entry, int index)
+{
+    const char* name = entry.parNames[index];
+    return (name != nullptr && name[0] != '\0') ? name : "?";
+}
+
+static std::string sSignature(const CAPL_DLL_INFO5& entry)
+{
+    std::string text(1, entry.resultType);
+    text += " ";
+    text += entry.cdlName;
+    text += "(";
+    for (int i = 0; i < entry.parCount; i++)
+    {
+        if (i > 0)
+        {
+            text += ", ";
+        }
+        text += sBaseType(entry.parTypes[i]);
+        if (entry.parTypes[i] & 0x80)
+        {
+            text += "&";
+        }
+        if (entry.array[i] != 0)
+        {
+            text += "[]";
+        }
+        text += " ";
+        text += sParamName(entry, i);
+    }
+    text += ")";
+    if (entry.flags & CAPL_FUNCTION_FLAG_THREADSAFE)
+    {
+        text += " threadsafe";
+    }
+    return text;
+}
+
+static bool sIsFunction(const CAPL_DLL_INFO5& entry)
+{
+    return entry.cdlName[0] != '\0' && strcmp(entry.cdlName, CDLL_VERSION_NAME) != 0;
+}
+
+static const CAPL_DLL_INFO5* sFind(const CAPL_DLL_INFO5* table, const char* name)
+{
+    for (const CAPL_DLL_INFO5* entry = table; entry->cdlName[0] != '\0'; entry++)
+    {
+        if (sIsFunction(*entry) && strcmp(entry->cdlName, name) == 0)
+        {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+/*
+ * Build the arguments from the given texts. Missing scalars default to their
+ * position (1, 2, 3, ...), missing char arrays to the default text and byte
+ * arrays are filled with 1, 2, 3, ...
+ */
+static bool sPrepare(const CAPL_DLL_INFO5& entry, const std::vector<const char*>& texts,
+                     std::vector<HarnessArgument>* arguments, HarnessFrame* frame)
+{
+    if (entry.parCount > MAXCAPLFUNCPARS_8_1)
+    {
+        fprintf(stderr, "%s: %d parameters, at most %d are supported.\n", entry.cdlName, entry.parCount,
+                MAXCAPLFUNCPARS_8_1);
+        return false;
+    }
+
+    arguments->assign(entry.parCount, HarnessArgument());
+    memset(frame, 0, sizeof(*frame));
+    int words = 0;
+    int floats = 0;
+
+    for (int i = 0; i < entry.parCount; i++)
+    {
+        HarnessArgument& argument = (*arguments)[i];
+        const char* text = (i < (int)texts.size()) ? texts[i] : nullptr;
+        argument.type = sBaseType(entry.parTypes[i]);
+        argument.reference = (entry.parTypes[i] & 0x80) != 0;
+        argument.array = entry.array[i] != 0;
+        argument.number = (text != nullptr) ? strtod(text, nullptr) : (double)(i + 1);
+
+        if (argument.array)
+        {
+            argument.buffer.assign(HARNESS_ARRAY_SIZE, 0);
+            if (argument.type == 'C')
+            {
+                strncpy((char*)argument.buffer.data(), text != nullptr ? text : sDefaultText, HARNESS_ARRAY_SIZE - 1);
+            }
+            else
+            {
+                for (size_t j = 0; j < argument.buffer.size(); j++)
+                {
+                    argument.buffer[j] = (uint8_t)(j + 1);
+                }
+            }
+            frame->words[words++] = (Slot)argument.buffer.data();
+        }
+        else if (argument.reference)
+        {
+            argument.buffer.assign(sizeof(double), 0);
+            if (sIsDouble(argument.type))
+            {
+                memcpy(argument.buffer.data(), &argument.number, sizeof(double));
+            }
+            else
+            {
+                int64_t value = (int64_t)argument.number;
+                memcpy(argument.buffer.data(), &value, sizeof(value));
+            }
+            frame->words[words++] = (Slot)argument.buffer.data();
+        }
+        else if (sIsDouble(argument.type))
+        {
+#if defined(__x86_64__)
+            if (floats == HARNESS_FLOAT_REGS)
+            {
+                fprintf(stderr, "%s: parameter %s is double by value number %d, at most %d are supported.\n",
+                        entry.cdlName, sParamName(entry, i), floats + 1, HARNESS_FLOAT_REGS);
+                return false;
+            }
+            frame->floats[floats++] = argument.number;
+#else
+            if (words + 2 > MAXCAPLFUNCPARS_8_1)
+            {
+                fprintf(stderr, "%s: the parameters take more than %d words.\n", entry.cdlName, MAXCAPLFUNCPARS_8_1);
+                return false;
+            }
+            memcpy(&frame->words[words], &argument.number, sizeof(double));
+            words += 2;
+#endif
+        }
+        else
+        {
+            frame->words[words++] = (Slot)(intptr_t)(int64_t)argument.number;
+        }
+    }
+    return true;
+}
+
+static double sInvoke(const CAPL_DLL_INFO5& entry, const HarnessFrame& frame)
+{
+    if (sIsDouble(entry.resultType))
+    {
+        return ((DoubleFunction)entry.adr)(ARGS64(frame.words), ARGS8(frame.floats, 0));
+    }
+
+    Slot word = ((WordFunction)entry.adr)(ARGS64(frame.words), ARGS8(frame.floats, 0));
+    switch (entry.resultType)
+    {
+    case 'L':
+        return (double)(int32_t)word;
+    case 'D':
+        return (double)(uint32_t)word;
+    case 'I':
+        return (double)(int16_t)word;
+    case 'W':
+        return (double)(uint16_t)word;
+    case 'B':
+    case 'C':
+        return (double)(uint8_t)word;
+    default:
+        return 0.0;
+    }
+}
+
+static void sPrintCall(const CAPL_DLL_INFO5& entry, const std::vector<HarnessArgument>& arguments, double result)
+{
+    printf("%s", entry.cdlName);
+    if (entry.resultType != 'V')
+    {
+        printf(" = %.10g", result);
+    }
+    printf("\n");
+
+    /* Show what the function may have written back. */
+    for (size_t i = 0; i < arguments.size(); i++)
+    {
+        const HarnessArgument& argument = arguments[i];
+        if (argument.array && argument.type == 'C')
+        {
+            printf("  %s: \"%s\"\n", sParamName(entry, (int)i), (const char*)argument.buffer.data());
+        }
+        else if (argument.array && sIsDouble(argument.type))
+        {
+            printf("  %s:", sParamName(entry, (int)i));
+            for (size_t j = 0; j < 8; j++)
+            {
+                double number;
+                memcpy(&number, argument.buffer.data() + j * sizeof(double), sizeof(number));
+                printf(" %.6g", number);
+            }
+            printf(" ...\n");
+        }
+        else if (argument.array)
+        {
+            printf("  %s:", sParamName(entry, (int)i));
+            for (size_t j = 0; j < 8; j++)
+            {
+                printf(" %02x", argument.buffer[j]);
+            }
+            printf(" ...\n");
+        }
+        else if (argument.reference)
+        {
+            double number;
+            int64_t value;
+            memcpy(&number, argument.buffer.data(), sizeof(number));
+            memcpy(&value, argument.buffer.data(), sizeof(value));
+            printf("  %s: %.10g\n", sParamName(entry, (int)i), sIsDouble(argument.type) ? number : (double)value);
+        }
+    }
+}
+
+static double sPercentileUs(const std::vector<uint64_t>& sorted, double percentile)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    size_t index = (size_t)(percentile / 100.0 * (double)(sorted.size() - 1) + 0.5);
+    return (double)sorted[index] / 1000.0;
+}
+
+static uint64_t sNowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/* Time repeat calls, appending the latency of each call to latencies. */
+static bool sTimeCalls(const CAPL_DLL_INFO5& entry, const std::vector<const char*>& texts, int repeat,
+                       std::vector<uint64_t>* latencies)
+{
+    std::vector<HarnessArgument> arguments;
+    HarnessFrame frame;
+
+    if (!sPrepare(entry, texts, &arguments, &frame))
+    {
+        return false;
+    }
+    latencies->reserve(latencies->size() + repeat);
+    for (int i = 0; i < repeat; i++)
+    {
+        uint64_t start = sNowNs();
+        sInvoke(entry, frame);
+        latencies->push_back(sNowNs() - start);
+    }
+    return true;
+}
+
+/*
+ * Call one function once, or time it repeat times in every thread. Functions
+ * not flagged thread safe are always timed in one thread.
+ */
+static bool sRun(const CAPL_DLL_INFO5& entry, const std::vector<const char*>& texts, int repeat)
+{
+    if (repeat <= 0)
+    {
+        std::vector<HarnessArgument> arguments;
+        HarnessFrame frame;
+        if (!sPrepare(entry, texts, &arguments, &frame))
+        {
+            return false;
+        }
+        double result = sInvoke(entry, frame);
+        sPrintCall(entry, arguments, result);
+        return true;
+    }
+
+    int threads = (entry.flags & CAPL_FUNCTION_FLAG_THREADSAFE) ? sThreads : 1;
+    std::vector<std::vector<uint64_t> > latencies(threads);
+    std::vector<char> ok(threads, 0);
+    std::vector<std::thread> workers;
+    uint64_t begin = sNowNs();
+    for (int t = 1; t < threads; t++)
+    {
+        workers.push_back(std::thread([&, t]() { ok[t] = sTimeCalls(entry, texts, repeat, &latencies[t]); }));
+    }
+    ok[0] = sTimeCalls(entry, texts, repeat, &latencies[0]);
+    for (size_t t = 0; t < workers.size(); t++)
+    {
+        workers[t].join();
+    }
+    uint64_t wall = sNowNs() - begin;
+
+    std::vector<uint64_t> all;
+    for (int t = 0; t < threads; t++)
+    {
+        if (!ok[t])
+        {
+            return false;
+        }
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+    }
+    std::sort(all.begin(), all.end());
+    printf("%-48s p50 %9.1f us  p90 %9.1f us  p99 %9.1f us  max %9.1f us  %10.0f calls/s  %d thread%s\n",
+           entry.cdlName, sPercentileUs(all, 50), sPercentileUs(all, 90), sPercentileUs(all, 99),
+           sPercentileUs(all, 100), (double)all.size() * 1e9 / (double)wall, threads, threads > 1 ? "s" : "");
+    return true;
+}
+
+static std::string sDefaultLibrary()
+{
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0)
+    {
+        return "./libcapl.so";
+    }
+    path[length] = '\0';
+    std::string directory(path);
+    return directory.substr(0, directory.rfind('/') + 1) + "libcapl.so";
+}
+
+static void sUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--lib <file>] [--no-sim] [--text <text>] [--repeat <n> [--threads <n>]]\n"
+            "          (--list | --all | --call <function> [<argument> ...] [--call ...])\n"
+            "  --lib      shared object to load (default libcapl.so next to the harness)\n"
+            "  --no-sim   do not bind the simulated supply to the stand-in VISA resources\n"
+            "  --text     default for char array arguments (default \"%s\")\n"
+            "  --repeat   time n calls instead of calling once\n"
+            "  --threads  time the calls of thread safe functions in n threads at once\n"
+            "  --list     print the functions of caplDllTable5\n"
+            "  --all      call every function with default arguments, dllInit first and dllEnd last\n"
+            "  --call     call a function, missing arguments get their default; calls run in order\n"
+            "Scalars default to their position (1, 2, 3, ...), byte arrays are filled with 1, 2, 3, ...\n"
+            "The fake CAPL program has the handle %u.\n",
+            program, sDefaultText, kCaplHandle);
+}
+
+int main(int argc, char* argv[])
+{
+    std::string library = sDefaultLibrary();
+    std::vector<const char*> callNames;
+    std::vector<std::vector<const char*> > callTexts;
+    std::vector<const char*> noTexts;
+    bool list = false;
+    bool all = false;
+    bool simulate = true;
+    int repeat = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--lib") == 0 && i + 1 < argc)
+        {
+            library = argv[++i];
+        }
+        else if (strcmp(argv[i], "--no-sim") == 0)
+        {
+            simulate = false;
+        }
+        else if (strcmp(argv[i], "--text") == 0 && i + 1 < argc)
+        {
+            sDefaultText = argv[++i];
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            sThreads = atoi(argv[++i]);
+            sThreads = sThreads < 1 ? 1 : sThreads;
+        }
+        else if (strcmp(argv[i], "--list") == 0)
+        {
+            list = true;
+        }
+        else if (strcmp(argv[i], "--all") == 0)
+        {
+            all = true;
+        }
+        else if (strcmp(argv[i], "--call") == 0 && i + 1 < argc)
+        {
+            callNames.push_back(argv[++i]);
+            callTexts.push_back(std::vector<const char*>());
+            /* Everything up to the next --call are the arguments of the function. */
+            while (i + 1 < argc && strcmp(argv[i + 1], "--call") != 0)
+            {
+                callTexts.back().push_back(argv[++i]);
+            }
+        }
+        else
+        {
+            sUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((int)list + (int)all + (int)!callNames.empty() != 1)
+    {
+        sUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr)
+    {
+        fprintf(stderr, "Could not load %s: %s\n", library.c_str(), dlerror());
+        return EXIT_FAILURE;
+    }
+    CAPL_DLL_INFO5** tableVariable = (CAPL_DLL_INFO5**)dlsym(handle, "caplDllTable5");
+    if (tableVariable == nullptr || *tableVariable == nullptr)
+    {
+        fprintf(stderr, "%s does not export caplDllTable5.\n", library.c_str());
+        dlclose(handle);
+        return EXIT_FAILURE;
+    }
+    const CAPL_DLL_INFO5* table = *tableVariable;
+
+    if (list)
+    {
+        for (const CAPL_DLL_INFO5* entry = table; entry->cdlName[0] != '\0'; entry++)
+        {
+            if (sIsFunction(*entry))
+            {
+                printf("%s\n", sSignature(*entry).c_str());
+            }
+        }
+        dlclose(handle);
+        return EXIT_SUCCESS;
+    }
+
+    ItechSimulator simulator;
+    if (simulate)
+    {
+        VisaSimBind(SIM_USB_RESOURCE, &simulator);
+        VisaSimBind(SIM_SERIAL_RESOURCE, &simulator);
+    }
+
+    FakeCapl capl(kCaplHandle);
+    capl.AddFunction("CALLBACK_ShowValue", 'D', "D");
+    capl.AddFunction("CALLBACK_ShowDates", 'D', "IDI");
+    capl.AddFunction("CALLBACK_DllInfo", 'V', "C");
+    capl.AddFunction("CALLBACK_ArrayValues", 'V', "DBB", "010");
+    capl.AddFunction("CALLBACK_DllVersion", 'V', "C");
+
+    typedef void (*RegisterFunction)(VIACapl*);
+    RegisterFunction registerCdll = (RegisterFunction)dlsym(handle, "VIARegisterCDLL");
+    if (registerCdll != nullptr)
+    {
+        registerCdll(&capl);
+    }
+
+    bool ok = true;
+    if (!callNames.empty())
+    {
+        for (size_t i = 0; i < callNames.size(); i++)
+        {
+            const CAPL_DLL_INFO5* entry = sFind(table, callNames[i]);
+            if (entry == nullptr)
+            {
+                fprintf(stderr, "%s has no function %s.\n", library.c_str(), callNames[i]);
+                ok = false;
+                break;
+            }
+            ok = sRun(*entry, callTexts[i], repeat) && ok;
+        }
+    }
+    else
+    {
+        const CAPL_DLL_INFO5* init = sFind(table, "dllInit");
+        const CAPL_DLL_INFO5* end = sFind(table, "dllEnd");
+        if (init != nullptr)
+        {
+            ok = sRun(*init, noTexts, 0) && ok;
+        }
+        for (const CAPL_DLL_INFO5* entry = table; entry->cdlName[0] != '\0'; entry++)
+        {
+            if (sIsFunction(*entry) && entry != init && entry != end)
+            {
+                ok = sRun(*entry, noTexts, repeat) && ok;
+            }
+        }
+        if (end != nullptr)
+        {
+            ok = sRun(*end, noTexts, 0) && ok;
+        }
+    }
+
+    VisaSimUnbindAll();
+    dlclose(handle);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
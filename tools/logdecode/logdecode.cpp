@@ -0,0 +1,321 @@
+/**
+ * @file logdecode.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief logdecode: turns a binary log written by dllItechBinLogStart into text.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * The lines are printed oldest first in the format of capldlllog, with the
+ * time in nanoseconds. The file may be decoded while the dll still writes
+ * to it or after a crash; lines overwritten or not finished are skipped.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "binlog.h"
+
+static const char* const sLevelTags[] = {"T", "D", "I", "W", "E", "F"};
+
+/**
+ * @brief One argument as stored.
+ */
+struct DecodedArg
+{
+    char        type;
+    uint64_t    number;
+    double      real;
+    std::string text;
+};
+
+static bool sReadFile(const char* path, std::vector<uint8_t>* data)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        data->insert(data->end(), chunk, chunk + count);
+    }
+    fclose(file);
+    return true;
+}
+
+/* Parse the arguments of a record, false if they do not fit it. */
+static bool sParseArgs(const uint8_t* in, const uint8_t* end, int count, std::vector<DecodedArg>* args)
+{
+    for (int i = 0; i < count; i++)
+    {
+        DecodedArg arg;
+        if (in >= end)
+        {
+            return false;
+        }
+        arg.type = (char)*in++;
+        arg.number = 0;
+        arg.real = 0.0;
+        if (arg.type == 's')
+        {
+            uint16_t length;
+            if (in + sizeof(length) > end)
+            {
+                return false;
+            }
+            memcpy(&length, in, sizeof(length));
+            in += sizeof(length);
+            if (in + length > end)
+            {
+                return false;
+            }
+            arg.text.assign((const char*)in, length);
+            in += length;
+        }
+        else
+        {
+            if (in + sizeof(uint64_t) > end)
+            {
+                return false;
+            }
+            memcpy(arg.type == 'd' ? (void*)&arg.real : (void*)&arg.number, in, sizeof(uint64_t));
+            in += sizeof(uint64_t);
+        }
+        args->push_back(arg);
+    }
+    return true;
+}
+
+/* printf the format with the stored arguments, each conversion is redone with the stored type. */
+static std::string sFormat(const char* format, const std::vector<DecodedArg>& args)
+{
+    std::string out;
+    size_t next = 0;
+    char buffer[512];
+    for (const char* p = format; *p != '\0'; p++)
+    {
+        if (*p != '%')
+        {
+            out += *p;
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            out += '%';
+            p++;
+            continue;
+        }
+
+        /* flags, width and precision are kept, the length is taken from the stored type */
+        std::string spec = "%";
+        p++;
+        while (*p != '\0' && strchr("-+ #0", *p) != nullptr)
+        {
+            spec += *p++;
+        }
+        while (*p != '\0' && (*p == '.' || (*p >= '0' && *p <= '9')))
+        {
+            spec += *p++;
+        }
+        while (*p != '\0' && strchr("hlLqjzt", *p) != nullptr)
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        char conversion = *p;
+
+        if (next >= args.size())
+        {
+            out += "<missing>";
+            continue;
+        }
+        const DecodedArg& arg = args[next++];
+        if (strchr("diouxXc", conversion) != nullptr && (arg.type == 'i' || arg.type == 'u'))
+        {
+            spec += (conversion == 'c') ? "c" : std::string("ll") + conversion;
+            if (conversion == 'c')
+            {
+                snprintf(buffer, sizeof(buffer), spec.c_str(), (int)arg.number);
+            }
+            else
+            {
+                snprintf(buffer, sizeof(buffer), spec.c_str(), (long long)arg.number);
+            }
+        }
+        else if (strchr("fFeEgGaA", conversion) != nullptr && arg.type == 'd')
+        {
+            spec += conversion;
+            snprintf(buffer, sizeof(buffer), spec.c_str(), arg.real);
+        }
+        else if (conversion == 's' && arg.type == 's')
+        {
+            spec += 's';
+            snprintf(buffer, sizeof(buffer), spec.c_str(), arg.text.c_str());
+        }
+        else if (conversion == 'p' && arg.type == 'p')
+        {
+            snprintf(buffer, sizeof(buffer), "0x%llx", (unsigned long long)arg.number);
+        }
+        else
+        {
+            snprintf(buffer, sizeof(buffer), "<%%%c: type %c>", conversion, arg.type);
+        }
+        out += buffer;
+    }
+    return out;
+}
+
+static void sUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s <binary log> [--stats]\n"
+            "  --stats  only print the number of lines and formats\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = nullptr;
+    bool statsOnly = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--stats") == 0)
+        {
+            statsOnly = true;
+        }
+        else if (path == nullptr && argv[i][0] != '-')
+        {
+            path = argv[i];
+        }
+        else
+        {
+            sUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (path == nullptr)
+    {
+        sUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> data;
+    if (!sReadFile(path, &data))
+    {
+        fprintf(stderr, "Cannot read %s.\n", path);
+        return EXIT_FAILURE;
+    }
+    const BinLogFileHeader* header = reinterpret_cast<const BinLogFileHeader*>(data.data());
+    if (data.size() < sizeof(BinLogFileHeader) || memcmp(header->magic, BINLOG_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != BINLOG_VERSION || header->ringOffset + header->ringSize > data.size() ||
+        (uint64_t)header->formatOffset + header->formatAreaSize > header->ringOffset)
+    {
+        fprintf(stderr, "%s is not a binary log of this version.\n", path);
+        return EXIT_FAILURE;
+    }
+
+    /* Format table */
+    std::vector<const BinLogFormatEntry*> formats;
+    const uint8_t* table = data.data() + header->formatOffset;
+    uint32_t used = header->formatUsed.load(std::memory_order_relaxed);
+    for (uint32_t offset = 0; offset + sizeof(BinLogFormatEntry) <= used && used <= header->formatAreaSize;)
+    {
+        const BinLogFormatEntry* entry = reinterpret_cast<const BinLogFormatEntry*>(table + offset);
+        if (entry->size < sizeof(BinLogFormatEntry) || offset + entry->size > used)
+        {
+            break;
+        }
+        if (entry->id >= formats.size())
+        {
+            formats.resize(entry->id + 1, nullptr);
+        }
+        formats[entry->id] = entry;
+        offset += entry->size;
+    }
+
+    /* Ring, oldest record first */
+    const uint8_t* ring = data.data() + header->ringOffset;
+    uint64_t ringSize = header->ringSize;
+    uint64_t end = header->writePosition.load(std::memory_order_relaxed);
+    uint64_t position = (end > ringSize) ? end - ringSize : 0;
+    bool synced = (position == 0);
+    uint64_t lines = 0;
+    uint64_t skipped = 0;
+
+    while (position < end)
+    {
+        uint64_t offset = position % ringSize;
+        if (ringSize - offset < sizeof(BinLogRecord))
+        {
+            position += ringSize - offset;
+            continue;
+        }
+        const BinLogRecord* record = reinterpret_cast<const BinLogRecord*>(ring + offset);
+        bool valid = record->sequence.load(std::memory_order_relaxed) == position + 1 &&
+                     record->size >= sizeof(BinLogRecord) && record->size % 8 == 0 &&
+                     offset + record->size <= ringSize;
+        if (!valid)
+        {
+            /* Overwritten or not finished, look for the next record. */
+            if (synced)
+            {
+                skipped++;
+                synced = false;
+            }
+            position += 8;
+            continue;
+        }
+        synced = true;
+        position += record->size;
+        if (record->format == BINLOG_PADDING)
+        {
+            continue;
+        }
+
+        std::vector<DecodedArg> args;
+        const uint8_t* in = (const uint8_t*)record + sizeof(BinLogRecord);
+        if (!sParseArgs(in, (const uint8_t*)record + record->size, record->argCount, &args))
+        {
+            skipped++;
+            continue;
+        }
+        lines++;
+        if (statsOnly)
+        {
+            continue;
+        }
+
+        uint64_t wall = header->originWallNs + (record->timestamp - header->originSteadyNs);
+        time_t seconds = (time_t)(wall / 1000000000ULL);
+        struct tm local;
+        localtime_r(&seconds, &local);
+        char date[32];
+        strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local);
+        const char* tag = record->level < sizeof(sLevelTags) / sizeof(sLevelTags[0]) ? sLevelTags[record->level] : "?";
+
+        std::string text;
+        if (record->format < formats.size() && formats[record->format] != nullptr)
+        {
+            text = sFormat((const char*)(formats[record->format] + 1), args);
+        }
+        else
+        {
+            text = "<format " + std::to_string(record->format) + " not stored>";
+        }
+        printf("%s.%09llu [%s]: %s\n", date, (unsigned long long)(wall % 1000000000ULL), tag, text.c_str());
+    }
+
+    fprintf(statsOnly ? stdout : stderr, "%llu lines, %zu formats, %llu bytes written, %llu unreadable gaps\n",
+            (unsigned long long)lines, formats.size(), (unsigned long long)end, (unsigned long long)skipped);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,349 @@
+/**
+ * @file regbench.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief regbench: lookups of CAPL blocks from many threads while blocks come and go.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * Every reader thread looks up the blocks of a fixed set of handles, like
+ * the exported functions do at the top of every call, while one thread
+ * keeps registering and removing other blocks, like nodes calling dllInit
+ * and dllEnd. The HandleTable of the dll is compared with the std::map
+ * behind a mutex it replaced. A lookup that returns a deleted block or the
+ * block of another handle is counted as an error.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "epoch.h"
+#include "handletable.h"
+
+#define REGBENCH_READ_HANDLES  32  /* blocks the readers look up     */
+#define REGBENCH_CHURN_HANDLES 64  /* blocks registered and removed  */
+#define REGBENCH_ALIVE         0x600DB10Cu
+#define REGBENCH_DEAD          0xDEADB10Cu
+
+/**
+ * @brief Stand-in for CaplInstanceData.
+ */
+struct Block
+{
+    uint32_t              handle;
+    std::atomic<uint32_t> magic;
+};
+
+static Block* sNewBlock(uint32_t handle)
+{
+    Block* block = new Block();
+    block->handle = handle;
+    block->magic.store(REGBENCH_ALIVE, std::memory_order_relaxed);
+    return block;
+}
+
+static void sDeleteBlock(void* object)
+{
+    Block* block = static_cast<Block*>(object);
+    block->magic.store(REGBENCH_DEAD, std::memory_order_relaxed);
+    delete block;
+}
+
+/* Handles as CANoe hands them out: small, not consecutive. */
+static uint32_t sReadHandle(uint32_t i)
+{
+    return 0x1000 + i * 7;
+}
+
+static uint32_t sChurnHandle(uint32_t i)
+{
+    return 0x8000 + i * 13;
+}
+
+/**
+ * @brief The registry variants compared.
+ */
+class Registry
+{
+public:
+    virtual ~Registry() {}
+    virtual const char* Name() const = 0;
+    virtual void Add(uint32_t handle) = 0;
+    virtual void Remove(uint32_t handle) = 0;
+    /* false if the block found is wrong. */
+    virtual bool Check(uint32_t handle) = 0;
+    virtual void Drain() = 0;
+};
+
+static bool sValid(const Block* block, uint32_t handle)
+{
+    return block != nullptr && block->handle == handle && block->magic.load(std::memory_order_relaxed) == REGBENCH_ALIVE;
+}
+
+class TableRegistry : public Registry
+{
+public:
+    const char* Name() const { return "HandleTable + epoch"; }
+    void Add(uint32_t handle) { mTable.Insert(handle, sNewBlock(handle)); }
+    void Remove(uint32_t handle)
+    {
+        Block* block = mTable.Remove(handle);
+        if (block != nullptr)
+        {
+            EpochRetire(block, sDeleteBlock);
+        }
+    }
+    bool Check(uint32_t handle)
+    {
+        EpochGuard guard;
+        return sValid(mTable.Find(handle), handle);
+    }
+    void Drain()
+    {
+        std::vector<uint32_t> handles = mTable.Handles();
+        for (size_t i = 0; i < handles.size(); i++)
+        {
+            Remove(handles[i]);
+        }
+        EpochReclaim();
+    }
+
+private:
+    HandleTable<Block> mTable;
+};
+
+/* What capldll.cpp had, made safe with a mutex. */
+template <typename Mutex, typename ReadLock>
+class MapRegistry : public Registry
+{
+public:
+    explicit MapRegistry(const char* name) : mName(name) {}
+    const char* Name() const { return mName; }
+    void Add(uint32_t handle)
+    {
+        std::lock_guard<Mutex> lock(mMutex);
+        mMap[handle] = sNewBlock(handle);
+    }
+    void Remove(uint32_t handle)
+    {
+        std::lock_guard<Mutex> lock(mMutex);
+        std::map<uint32_t, Block*>::iterator found = mMap.find(handle);
+        if (found != mMap.end())
+        {
+            sDeleteBlock(found->second);
+            mMap.erase(found);
+        }
+    }
+    bool Check(uint32_t handle)
+    {
+        ReadLock lock(mMutex);
+        std::map<uint32_t, Block*>::iterator found = mMap.find(handle);
+        return found != mMap.end() && sValid(found->second, handle);
+    }
+    void Drain()
+    {
+        std::lock_guard<Mutex> lock(mMutex);
+        for (std::map<uint32_t, Block*>::iterator i = mMap.begin(); i != mMap.end(); ++i)
+        {
+            sDeleteBlock(i->second);
+        }
+        mMap.clear();
+    }
+
+private:
+    const char*                mName;
+    Mutex                      mMutex;
+    std::map<uint32_t, Block*> mMap;
+};
+
+static uint64_t sNowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief Result of one run.
+ */
+struct RunResult
+{
+    double   lookupsPerSecond;
+    double   nsPerLookup; /* per thread */
+    uint64_t churn;       /* registrations and removals */
+    uint64_t errors;
+};
+
+static RunResult sRun(Registry* registry, int threads, uint64_t lookups, bool churn)
+{
+    for (uint32_t i = 0; i < REGBENCH_READ_HANDLES; i++)
+    {
+        registry->Add(sReadHandle(i));
+    }
+
+    std::atomic<bool> start(false);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> errors(0);
+    std::atomic<uint64_t> churned(0);
+    std::vector<uint64_t> elapsed(threads, 0);
+    std::vector<std::thread> readers;
+
+    for (int t = 0; t < threads; t++)
+    {
+        readers.push_back(std::thread([&, t]() {
+            uint32_t state = 2463534242u + (uint32_t)t * 97u;
+            uint64_t wrong = 0;
+            while (!start.load(std::memory_order_acquire))
+            {
+            }
+            uint64_t begin = sNowNs();
+            for (uint64_t i = 0; i < lookups; i++)
+            {
+                /* xorshift, cheap and different per thread */
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                if (!registry->Check(sReadHandle(state % REGBENCH_READ_HANDLES)))
+                {
+                    wrong++;
+                }
+            }
+            elapsed[t] = sNowNs() - begin;
+            errors.fetch_add(wrong);
+        }));
+    }
+
+    std::thread writer;
+    if (churn)
+    {
+        writer = std::thread([&]() {
+            while (!start.load(std::memory_order_acquire))
+            {
+            }
+            uint64_t count = 0;
+            for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); i = (i + 1) % REGBENCH_CHURN_HANDLES)
+            {
+                registry->Add(sChurnHandle(i));
+                registry->Remove(sChurnHandle((i + REGBENCH_CHURN_HANDLES / 2) % REGBENCH_CHURN_HANDLES));
+                count += 2;
+            }
+            churned.store(count);
+        });
+    }
+
+    uint64_t begin = sNowNs();
+    start.store(true, std::memory_order_release);
+    for (size_t t = 0; t < readers.size(); t++)
+    {
+        readers[t].join();
+    }
+    uint64_t wall = sNowNs() - begin;
+    stop.store(true);
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+    registry->Drain();
+
+    uint64_t busy = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        busy += elapsed[t];
+    }
+    RunResult result;
+    result.lookupsPerSecond = (double)lookups * threads * 1e9 / (double)wall;
+    result.nsPerLookup = (double)busy / ((double)lookups * threads);
+    result.churn = churned.load();
+    result.errors = errors.load();
+    return result;
+}
+
+static bool sParseThreads(const char* text, std::vector<int>* threads)
+{
+    threads->clear();
+    for (const char* p = text; *p != '\0';)
+    {
+        char* end;
+        long count = strtol(p, &end, 10);
+        if (end == p || count < 1)
+        {
+            return false;
+        }
+        threads->push_back((int)count);
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return !threads->empty();
+}
+
+static void sUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--threads <n>[,<n>...]] [--lookups <n>] [--no-churn]\n"
+            "  --threads   reader thread counts to run (default 1,2,4,8)\n"
+            "  --lookups   lookups per reader thread (default 2000000)\n"
+            "  --no-churn  no thread registering and removing blocks meanwhile\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> threadCounts;
+    sParseThreads("1,2,4,8", &threadCounts);
+    uint64_t lookups = 2000000;
+    bool churn = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            if (!sParseThreads(argv[++i], &threadCounts))
+            {
+                sUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--lookups") == 0 && i + 1 < argc)
+        {
+            lookups = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--no-churn") == 0)
+        {
+            churn = false;
+        }
+        else
+        {
+            sUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    TableRegistry table;
+    MapRegistry<std::mutex, std::lock_guard<std::mutex> > map("std::map + mutex");
+    MapRegistry<std::shared_mutex, std::shared_lock<std::shared_mutex> > sharedMap("std::map + shared_mutex");
+    Registry* registries[] = {&table, &map, &sharedMap};
+
+    bool ok = true;
+    printf("%-24s %7s %14s %12s %12s %7s\n", "registry", "threads", "lookups/s", "ns/lookup", "churn", "errors");
+    for (size_t r = 0; r < sizeof(registries) / sizeof(registries[0]); r++)
+    {
+        for (size_t t = 0; t < threadCounts.size(); t++)
+        {
+            RunResult result = sRun(registries[r], threadCounts[t], lookups, churn);
+            printf("%-24s %7d %14.0f %12.1f %12llu %7llu\n", registries[r]->Name(), threadCounts[t],
+                   result.lookupsPerSecond, result.nsPerLookup, (unsigned long long)result.churn,
+                   (unsigned long long)result.errors);
+            ok = ok && result.errors == 0;
+        }
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1202 @@
+/**
+ * @file itechsim.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Simulated ITECH DC power supply for hardware-free testing.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "itechsim.h"
+
+#define SIM_MAX_VOLTAGE   60.0
+#define SIM_MAX_CURRENT   10.0
+#define SIM_ERROR_QUEUE   16
+
+/* Status byte */
+#define SIM_STB_EAV       0x04 /* error queue not empty          */
+#define SIM_STB_QUES      0x08 /* questionable summary           */
+#define SIM_STB_ESB       0x20 /* standard event summary         */
+#define SIM_STB_RQS       0x40 /* master summary / request       */
+
+/* Standard event status register */
+#define SIM_ESR_OPC       0x01 /* operation complete             */
+#define SIM_ESR_QYE       0x04 /* query error, -4xx              */
+#define SIM_ESR_DDE       0x08 /* device dependent error, -3xx   */
+#define SIM_ESR_EXE       0x10 /* execution error, -2xx          */
+#define SIM_ESR_CME       0x20 /* command error, -1xx            */
+
+#define SIM_LIST_MAX_COUNT 65535
+#define SIM_LIST_MAX_WIDTH 3600.0 /* s */
+#define SIM_LIST_MIN_WIDTH 0.001  /* s */
+
+/**
+ * @brief A parsed program header, e.g. ":SOUR:VOLT:LEV?" -> {SOUR,VOLT,LEV}, query.
+ */
+struct ItechSimulator::Header
+{
+    std::vector<std::string> nodes;
+    bool query;
+    bool common;
+};
+
+static std::string sTrim(const std::string& text)
+{
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && isspace((unsigned char)text[begin]))
+    {
+        begin++;
+    }
+    while (end > begin && isspace((unsigned char)text[end - 1]))
+    {
+        end--;
+    }
+    return text.substr(begin, end - begin);
+}
+
+/*
+ * Compare one mnemonic with its pattern form. The upper case letters of the
+ * form are the short form, e.g. "VOLTage" accepts "VOLT" and "VOLTAGE".
+ */
+static bool sMatchMnemonic(const std::string& token, const char* form, size_t formLength)
+{
+    size_t shortLength = 0;
+    while (shortLength < formLength && isupper((unsigned char)form[shortLength]))
+    {
+        shortLength++;
+    }
+    if (token.size() != shortLength && token.size() != formLength)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < token.size(); i++)
+    {
+        if (toupper((unsigned char)token[i]) != toupper((unsigned char)form[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Match header nodes against a pattern such as
+ * "[SOURce:]VOLTage[:LEVel][:IMMediate]". Optional nodes are in brackets.
+ */
+static bool sMatchNodes(const std::vector<std::string>& nodes, size_t index, const char* pattern)
+{
+    while (*pattern == ':')
+    {
+        pattern++;
+    }
+    if (*pattern == '\0')
+    {
+        return index == nodes.size();
+    }
+
+    bool optional = (*pattern == '[');
+    if (optional)
+    {
+        pattern++;
+        while (*pattern == ':')
+        {
+            pattern++;
+        }
+    }
+
+    const char* end = pattern;
+    while (*end != '\0' && *end != ':' && *end != '[' && *end != ']')
+    {
+        end++;
+    }
+    const char* next = end;
+    if (optional)
+    {
+        while (*next != '\0' && *next != ']')
+        {
+            next++;
+        }
+        if (*next == ']')
+        {
+            next++;
+        }
+    }
+
+    if (index < nodes.size() && sMatchMnemonic(nodes[index], pattern, (size_t)(end - pattern))
+        && sMatchNodes(nodes, index + 1, next))
+    {
+        return true;
+    }
+    return optional && sMatchNodes(nodes, index, next);
+}
+
+/*
+ * Parse a numeric parameter with an optional unit suffix ("800mV", "2.5A").
+ */
+static bool sParseNumber(const std::string& text, double* value)
+{
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    *value = strtod(begin, &end);
+    if (end == begin)
+    {
+        return false;
+    }
+
+    std::string suffix;
+    for (; *end != '\0'; end++)
+    {
+        if (!isspace((unsigned char)*end))
+        {
+            suffix += (char)toupper((unsigned char)*end);
+        }
+    }
+    if (suffix.empty() || suffix == "V" || suffix == "A" || suffix == "W" || suffix == "S")
+    {
+        return true;
+    }
+    if (suffix == "MV" || suffix == "MA" || suffix == "MW" || suffix == "MS")
+    {
+        *value *= 1e-3;
+        return true;
+    }
+    if (suffix == "UV" || suffix == "UA" || suffix == "US")
+    {
+        *value *= 1e-6;
+        return true;
+    }
+    return false;
+}
+
+/* Split "3,12.5" into its comma separated parameters. */
+static std::vector<std::string> sSplitParameters(const std::string& text)
+{
+    std::vector<std::string> parameters;
+    size_t begin = 0;
+    while (begin <= text.size())
+    {
+        size_t end = text.find(',', begin);
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+        parameters.push_back(sTrim(text.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+    return parameters;
+}
+
+static bool sParseBoolean(const std::string& text, bool* value)
+{
+    std::string upper;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        upper += (char)toupper((unsigned char)text[i]);
+    }
+    if (upper == "1" || upper == "ON")
+    {
+        *value = true;
+        return true;
+    }
+    if (upper == "0" || upper == "OFF")
+    {
+        *value = false;
+        return true;
+    }
+    return false;
+}
+
+ItechSimulator::ItechSimulator()
+    : mLoadResistance(10.0),
+      mRequireRemote(false),
+      mResponseDelayUs(0),
+      mSlewRate(0.0),
+      mMessageCount(0)
+{
+    /* the saved lists are kept over Reset like in the non-volatile memory of a supply */
+    Reset();
+}
+
+void ItechSimulator::Reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mVoltageSetting = 0.0;
+    mCurrentSetting = SIM_MAX_CURRENT;
+    mOutput = false;
+    mRemote = false;
+    mErrors.clear();
+    mEventStatus = 0;
+    mEventEnable = 0;
+    mServiceEnable = 0;
+    mQuesCondition = 0;
+    mQuesEvent = 0;
+    mQuesEnable = 0;
+    mSummary = false;
+    mRequest = false;
+    StartRamp(0.0);
+    ListStep step = {0.0, SIM_MAX_CURRENT, 1.0};
+    mListEdit.assign(1, step);
+    mListCount = 1;
+    mListRunCount = 1;
+    mListOn = false;
+    mListTriggered = false;
+    ResetAcquisition();
+}
+
+void ItechSimulator::SetLoadResistance(double ohms)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLoadResistance = ohms;
+}
+
+void ItechSimulator::SetSlewRate(double voltsPerSecond)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSlewRate = voltsPerSecond;
+}
+
+void ItechSimulator::SetRequireRemote(bool required)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRequireRemote = required;
+}
+
+void ItechSimulator::SetResponseDelayUs(uint32_t microseconds)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mResponseDelayUs = microseconds;
+}
+
+double ItechSimulator::MeasuredVoltage() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    double voltage, current;
+    Measure(&voltage, &current, std::chrono::steady_clock::now());
+    return voltage;
+}
+
+double ItechSimulator::MeasuredCurrent() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    double voltage, current;
+    Measure(&voltage, &current, std::chrono::steady_clock::now());
+    return current;
+}
+
+bool ItechSimulator::Output() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mOutput;
+}
+
+uint64_t ItechSimulator::MessageCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMessageCount;
+}
+
+void ItechSimulator::TripProtection(uint16_t bits)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Acquire(std::chrono::steady_clock::now());
+    mOutput = false;
+    mQuesCondition |= bits;
+    mQuesEvent |= bits;
+    UpdateRequest();
+}
+
+bool ItechSimulator::ServiceRequested() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRequest;
+}
+
+uint8_t ItechSimulator::SerialPoll()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    uint8_t status = (uint8_t)(StatusByte() & ~SIM_STB_RQS);
+    if (mRequest)
+    {
+        status |= SIM_STB_RQS;
+        mRequest = false;
+    }
+    return status;
+}
+
+/* The status byte as "*STB?" reports it, bit 6 is the master summary. */
+uint8_t ItechSimulator::StatusByte() const
+{
+    uint8_t status = 0;
+    if (!mErrors.empty())
+    {
+        status |= SIM_STB_EAV;
+    }
+    if ((mQuesEvent & mQuesEnable) != 0)
+    {
+        status |= SIM_STB_QUES;
+    }
+    if ((mEventStatus & mEventEnable) != 0)
+    {
+        status |= SIM_STB_ESB;
+    }
+    if ((status & mServiceEnable & ~SIM_STB_RQS) != 0)
+    {
+        status |= SIM_STB_RQS;
+    }
+    return status;
+}
+
+/* SRQ is asserted when the master summary comes up, not while it stays up. */
+void ItechSimulator::UpdateRequest()
+{
+    bool summary = (StatusByte() & SIM_STB_RQS) != 0;
+    if (summary && !mSummary)
+    {
+        mRequest = true;
+    }
+    mSummary = summary;
+}
+
+/* Where the ramp to the voltage setting is at. */
+double ItechSimulator::OutputVoltage(Time at) const
+{
+    if (mSlewRate <= 0.0)
+    {
+        return mVoltageSetting;
+    }
+    double elapsed = std::chrono::duration<double>(at - mRampStart).count();
+    if (elapsed < 0.0)
+    {
+        elapsed = 0.0; /* a point measured late, just before the ramp */
+    }
+    double step = mSlewRate * elapsed;
+    if (fabs(mVoltageSetting - mRampFrom) <= step)
+    {
+        return mVoltageSetting;
+    }
+    return mVoltageSetting > mRampFrom ? mRampFrom + step : mRampFrom - step;
+}
+
+void ItechSimulator::StartRamp(double from)
+{
+    mRampFrom = from;
+    mRampStart = std::chrono::steady_clock::now();
+}
+
+/*
+ * The settings of the step a triggered list is at, or of its last step once
+ * it ran. Returns false if no list was triggered since "LIST:STAT ON".
+ */
+bool ItechSimulator::ListSettings(double* voltage, double* current, Time at) const
+{
+    if (!mListOn || !mListTriggered || mListRun.empty())
+    {
+        return false;
+    }
+    double cycle = 0.0;
+    for (size_t i = 0; i < mListRun.size(); i++)
+    {
+        cycle += mListRun[i].width;
+    }
+    double elapsed = std::chrono::duration<double>(at - mListStart).count();
+    const ListStep* step = &mListRun.back();
+    if (elapsed < 0.0)
+    {
+        elapsed = 0.0;
+    }
+    if (elapsed < cycle * mListRunCount)
+    {
+        double offset = fmod(elapsed, cycle);
+        for (size_t i = 0; i < mListRun.size(); i++)
+        {
+            if (offset < mListRun[i].width)
+            {
+                step = &mListRun[i];
+                break;
+            }
+            offset -= mListRun[i].width;
+        }
+    }
+    *voltage = step->voltage;
+    *current = step->current;
+    return true;
+}
+
+bool ItechSimulator::ListRunning(Time at) const
+{
+    if (!mListOn || !mListTriggered)
+    {
+        return false;
+    }
+    double cycle = 0.0;
+    for (size_t i = 0; i < mListRun.size(); i++)
+    {
+        cycle += mListRun[i].width;
+    }
+    double elapsed = std::chrono::duration<double>(at - mListStart).count();
+    return elapsed < cycle * mListRunCount;
+}
+
+void ItechSimulator::Measure(double* voltage, double* current, Time at) const
+{
+    if (!mOutput || mLoadResistance <= 0.0)
+    {
+        *voltage = 0.0;
+        *current = 0.0;
+        return;
+    }
+
+    /* CV until the load draws more than the current setting, CC after that. */
+    double currentSetting = mCurrentSetting;
+    if (!ListSettings(voltage, &currentSetting, at))
+    {
+        *voltage = OutputVoltage(at);
+    }
+    *current = *voltage / mLoadResistance;
+    if (*current > currentSetting)
+    {
+        *current = currentSetting;
+        *voltage = currentSetting * mLoadResistance;
+    }
+}
+
+/* "LIST:VOLT <step>,<value>" and its siblings, field 0 voltage, 1 current, 2 width. */
+void ItechSimulator::EditList(const Header& header, const std::string& parameter, int field, std::string* reply)
+{
+    static const double kMaximum[] = {SIM_MAX_VOLTAGE, SIM_MAX_CURRENT, SIM_LIST_MAX_WIDTH};
+    static const double kMinimum[] = {0.0, 0.0, SIM_LIST_MIN_WIDTH};
+    std::vector<std::string> parameters = sSplitParameters(parameter);
+    double number;
+    double value = 0.0;
+    if (parameters.size() != (header.query ? 1u : 2u) || !sParseNumber(parameters[0], &number)
+        || (!header.query && !sParseNumber(parameters[1], &value)))
+    {
+        PushError(-104, "Data type error");
+        return;
+    }
+    if (number < 1.0 || number > (double)mListEdit.size())
+    {
+        PushError(-222, "Data out of range");
+        return;
+    }
+    ListStep& step = mListEdit[(size_t)number - 1];
+    double* target = field == 0 ? &step.voltage : (field == 1 ? &step.current : &step.width);
+    if (header.query)
+    {
+        AppendNumber(*target, reply);
+    }
+    else if (value < kMinimum[field] || value > kMaximum[field])
+    {
+        PushError(-222, "Data out of range");
+    }
+    else if (CheckRemote())
+    {
+        *target = value;
+    }
+}
+
+void ItechSimulator::PushError(int code, const char* text)
+{
+    char entry[96];
+    snprintf(entry, sizeof(entry), "%d,\"%s\"", code, text);
+    if (code <= -100 && code > -200)
+    {
+        mEventStatus |= SIM_ESR_CME;
+    }
+    else if (code <= -200 && code > -300)
+    {
+        mEventStatus |= SIM_ESR_EXE;
+    }
+    else if (code <= -300 && code > -400)
+    {
+        mEventStatus |= SIM_ESR_DDE;
+    }
+    else if (code <= -400 && code > -500)
+    {
+        mEventStatus |= SIM_ESR_QYE;
+    }
+    if (mErrors.size() >= SIM_ERROR_QUEUE)
+    {
+        mErrors.back() = "-350,\"Queue overflow\"";
+        return;
+    }
+    mErrors.push_back(entry);
+}
+
+bool ItechSimulator::CheckRemote()
+{
+    if (mRequireRemote && !mRemote)
+    {
+        PushError(-221, "Settings conflict");
+        return false;
+    }
+    return true;
+}
+
+void ItechSimulator::AppendNumber(double value, std::string* reply) const
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.5f\n", value);
+    *reply += text;
+}
+
+void ItechSimulator::AppendInteger(int value, std::string* reply) const
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%d\n", value);
+    *reply += text;
+}
+
+/* Set one of the 8 bit registers, or append its value for a query. */
+void ItechSimulator::AccessRegister(const Header& header, const std::string& parameter, uint8_t* value,
+                                    std::string* reply)
+{
+    double number;
+    if (header.query)
+    {
+        AppendInteger(*value, reply);
+    }
+    else if (!sParseNumber(parameter, &number))
+    {
+        PushError(-104, "Data type error");
+    }
+    else if (number < 0.0 || number > 255.0)
+    {
+        PushError(-222, "Data out of range");
+    }
+    else
+    {
+        *value = (uint8_t)number;
+    }
+}
+
+void ItechSimulator::Process(const std::string& message, std::string* reply)
+{
+    uint32_t delay;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        delay = mResponseDelayUs;
+    }
+    if (delay > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(delay));
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMessageCount++;
+    Acquire(std::chrono::steady_clock::now());
+
+    size_t begin = 0;
+    while (begin <= message.size())
+    {
+        size_t end = message.find(';', begin);
+        if (end == std::string::npos)
+        {
+            end = message.size();
+        }
+        std::string command = sTrim(message.substr(begin, end - begin));
+        if (!command.empty())
+        {
+            Execute(command, reply);
+        }
+        begin = end + 1;
+    }
+    UpdateRequest();
+}
+
+/*
+ * Run the edited list from its first step, again if it ran or runs already,
+ * and start an acquisition armed for the bus trigger at the same instant.
+ */
+void ItechSimulator::Trigger()
+{
+    Time now = std::chrono::steady_clock::now();
+    bool acquisition = mAcqState == kAcquisitionArmed && mAcqBus;
+    if (!mListOn && !acquisition)
+    {
+        PushError(-211, "Trigger ignored");
+        return;
+    }
+    if (acquisition)
+    {
+        mAcqState = kAcquisitionMeasuring;
+        mAcqStart = now;
+    }
+    if (mListOn && CheckRemote())
+    {
+        mListRun = mListEdit;
+        mListRunCount = mListCount;
+        mListTriggered = true;
+        mListStart = now;
+    }
+}
+
+/* Power-on settings, and no points. */
+void ItechSimulator::ResetAcquisition()
+{
+    mAcqPoints = 1024;
+    mAcqInterval = 0.001;
+    mAcqBus = false;
+    mFormatReal = false;
+    mAcqState = kAcquisitionIdle;
+    mAcqVoltage.clear();
+    mAcqCurrent.clear();
+}
+
+/* Measure the points due until now, with the state since the message before. */
+void ItechSimulator::Acquire(Time now)
+{
+    while (mAcqState == kAcquisitionMeasuring)
+    {
+        std::chrono::duration<double> offset(mAcqInterval * (double)mAcqVoltage.size());
+        Time at = mAcqStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+        if (at > now)
+        {
+            break;
+        }
+        double voltage, current;
+        Measure(&voltage, &current, at);
+        mAcqVoltage.push_back((float)voltage);
+        mAcqCurrent.push_back((float)current);
+        if (mAcqVoltage.size() >= mAcqPoints)
+        {
+            mAcqState = kAcquisitionDone;
+        }
+    }
+}
+
+/* The points in the data format, a definite length block "#<n><length><bytes>" for REAL,32. */
+void ItechSimulator::AppendArray(const std::vector<float>& points, std::string* reply) const
+{
+    if (!mFormatReal)
+    {
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            char text[32];
+            snprintf(text, sizeof(text), i == 0 ? "%.5f" : ",%.5f", points[i]);
+            *reply += text;
+        }
+        *reply += '\n';
+        return;
+    }
+
+    char header[16];
+    char length[12];
+    snprintf(length, sizeof(length), "%u", (unsigned)(points.size() * 4));
+    snprintf(header, sizeof(header), "#%u%s", (unsigned)strlen(length), length);
+    *reply += header;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        uint32_t word;
+        memcpy(&word, &points[i], sizeof(word));
+        *reply += (char)(word >> 24);
+        *reply += (char)(word >> 16);
+        *reply += (char)(word >> 8);
+        *reply += (char)word;
+    }
+    *reply += '\n';
+}
+
+void ItechSimulator::Execute(const std::string& command, std::string* reply)
+{
+    size_t split = 0;
+    while (split < command.size() && !isspace((unsigned char)command[split]))
+    {
+        split++;
+    }
+    std::string headerText = command.substr(0, split);
+    std::string parameter = sTrim(command.substr(split));
+
+    Header header;
+    header.query = !headerText.empty() && headerText[headerText.size() - 1] == '?';
+    if (header.query)
+    {
+        headerText.erase(headerText.size() - 1);
+    }
+    header.common = !headerText.empty() && headerText[0] == '*';
+
+    if (header.common)
+    {
+        std::string upper;
+        for (size_t i = 0; i < headerText.size(); i++)
+        {
+            upper += (char)toupper((unsigned char)headerText[i]);
+        }
+        if (upper == "*IDN" && header.query)
+        {
+            *reply += "ITECH Ltd., IT6722, 800000000000000000, 1.02-1.00\n";
+        }
+        else if (upper == "*RST" && !header.query)
+        {
+            mVoltageSetting = 0.0;
+            mCurrentSetting = SIM_MAX_CURRENT;
+            mOutput = false;
+            StartRamp(0.0);
+            mListOn = false;
+            mListTriggered = false;
+            ResetAcquisition();
+        }
+        else if (upper == "*CLS" && !header.query)
+        {
+            mErrors.clear();
+            mEventStatus = 0;
+            mQuesEvent = 0;
+        }
+        else if (upper == "*OPC")
+        {
+            /* every operation is complete once its command is processed */
+            if (header.query)
+            {
+                *reply += "1\n";
+            }
+            else
+            {
+                mEventStatus |= SIM_ESR_OPC;
+            }
+        }
+        else if (upper == "*ESR" && header.query)
+        {
+            AppendInteger(mEventStatus, reply);
+            mEventStatus = 0;
+        }
+        else if (upper == "*ESE")
+        {
+            AccessRegister(header, parameter, &mEventEnable, reply);
+        }
+        else if (upper == "*SRE")
+        {
+            AccessRegister(header, parameter, &mServiceEnable, reply);
+        }
+        else if (upper == "*STB" && header.query)
+        {
+            AppendInteger(StatusByte(), reply);
+        }
+        else if (upper == "*TRG" && !header.query)
+        {
+            Trigger();
+        }
+        else
+        {
+            PushError(-113, "Undefined header");
+        }
+        return;
+    }
+
+    size_t begin = (!headerText.empty() && headerText[0] == ':') ? 1 : 0;
+    while (begin <= headerText.size())
+    {
+        size_t end = headerText.find(':', begin);
+        if (end == std::string::npos)
+        {
+            end = headerText.size();
+        }
+        header.nodes.push_back(headerText.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    double value;
+    bool state;
+    double voltage, current;
+
+    if (sMatchNodes(header.nodes, 0, "[SOURce:]VOLTage[:LEVel][:IMMediate][:AMPLitude]"))
+    {
+        if (header.query)
+        {
+            AppendNumber(mVoltageSetting, reply);
+        }
+        else if (!sParseNumber(parameter, &value))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (value < 0.0 || value > SIM_MAX_VOLTAGE)
+        {
+            PushError(-222, "Data out of range");
+        }
+        else if (CheckRemote())
+        {
+            StartRamp(OutputVoltage(std::chrono::steady_clock::now()));
+            mVoltageSetting = value;
+        }
+    }
+    else if (sMatchNodes(header.nodes, 0, "[SOURce:]CURRent[:LEVel][:IMMediate][:AMPLitude]"))
+    {
+        if (header.query)
+        {
+            AppendNumber(mCurrentSetting, reply);
+        }
+        else if (!sParseNumber(parameter, &value))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (value < 0.0 || value > SIM_MAX_CURRENT)
+        {
+            PushError(-222, "Data out of range");
+        }
+        else if (CheckRemote())
+        {
+            mCurrentSetting = value;
+        }
+    }
+    else if (sMatchNodes(header.nodes, 0, "OUTPut[:STATe]"))
+    {
+        if (header.query)
+        {
+            *reply += mOutput ? "1\n" : "0\n";
+        }
+        else if (!sParseBoolean(parameter, &state))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (state && mQuesCondition != 0)
+        {
+            PushError(-221, "Settings conflict"); /* protection tripped, clear it first */
+        }
+        else if (CheckRemote())
+        {
+            if (state && !mOutput)
+            {
+                StartRamp(0.0);
+            }
+            mOutput = state;
+        }
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "OUTPut:PROTection:CLEar"))
+    {
+        mQuesCondition = 0;
+    }
+    else if (header.query && sMatchNodes(header.nodes, 0, "STATus:QUEStionable[:EVENt]"))
+    {
+        AppendInteger(mQuesEvent, reply);
+        mQuesEvent = 0;
+    }
+    else if (header.query && sMatchNodes(header.nodes, 0, "STATus:QUEStionable:CONDition"))
+    {
+        AppendInteger(mQuesCondition, reply);
+    }
+    else if (sMatchNodes(header.nodes, 0, "STATus:QUEStionable:ENABle"))
+    {
+        if (header.query)
+        {
+            AppendInteger(mQuesEnable, reply);
+        }
+        else if (!sParseNumber(parameter, &value))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (value < 0.0 || value > 65535.0)
+        {
+            PushError(-222, "Data out of range");
+        }
+        else
+        {
+            mQuesEnable = (uint16_t)value;
+        }
+    }
+    else if (header.query && sMatchNodes(header.nodes, 0, "MEASure[:SCALar]:VOLTage[:DC]"))
+    {
+        Measure(&voltage, &current, std::chrono::steady_clock::now());
+        AppendNumber(voltage, reply);
+    }
+    else if (header.query && sMatchNodes(header.nodes, 0, "MEASure[:SCALar]:CURRent[:DC]"))
+    {
+        Measure(&voltage, &current, std::chrono::steady_clock::now());
+        AppendNumber(current, reply);
+    }
+    else if (header.query && sMatchNodes(header.nodes, 0, "MEASure[:SCALar]:POWer[:DC]"))
+    {
+        Measure(&voltage, &current, std::chrono::steady_clock::now());
+        AppendNumber(voltage * current, reply);
+    }
+    else if (header.query && sMatchNodes(header.nodes, 0, "STATus:OPERation:CONDition"))
+    {
+        int operation = ListRunning(std::chrono::steady_clock::now()) ? SIM_OPER_LIST : 0;
+        if (mAcqState == kAcquisitionArmed)
+        {
+            operation |= SIM_OPER_WTG_MEAS;
+        }
+        else if (mAcqState == kAcquisitionMeasuring)
+        {
+            operation |= SIM_OPER_MEAS;
+        }
+        AppendInteger(operation, reply);
+    }
+    else if (sMatchNodes(header.nodes, 0, "[SENSe:]SWEep:POINts"))
+    {
+        if (header.query)
+        {
+            AppendInteger((int)mAcqPoints, reply);
+        }
+        else if (!sParseNumber(parameter, &value))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (value < 1.0 || value > SIM_ACQ_POINTS)
+        {
+            PushError(-222, "Data out of range");
+        }
+        else if (mAcqState == kAcquisitionArmed || mAcqState == kAcquisitionMeasuring)
+        {
+            PushError(-221, "Settings conflict");
+        }
+        else
+        {
+            mAcqPoints = (uint32_t)value;
+        }
+    }
+    else if (sMatchNodes(header.nodes, 0, "[SENSe:]SWEep:TINTerval"))
+    {
+        if (header.query)
+        {
+            char text[32];
+            snprintf(text, sizeof(text), "%g\n", mAcqInterval);
+            *reply += text;
+        }
+        else if (!sParseNumber(parameter, &value))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (value < SIM_ACQ_MIN_INTERVAL || value > SIM_ACQ_MAX_INTERVAL)
+        {
+            PushError(-222, "Data out of range");
+        }
+        else if (mAcqState == kAcquisitionArmed || mAcqState == kAcquisitionMeasuring)
+        {
+            PushError(-221, "Settings conflict");
+        }
+        else
+        {
+            mAcqInterval = value;
+        }
+    }
+    else if (sMatchNodes(header.nodes, 0, "TRIGger:ACQuire:SOURce"))
+    {
+        if (header.query)
+        {
+            *reply += mAcqBus ? "BUS\n" : "IMM\n";
+        }
+        else if (sMatchMnemonic(parameter, "BUS", 3) || sMatchMnemonic(parameter, "IMMediate", 9))
+        {
+            mAcqBus = sMatchMnemonic(parameter, "BUS", 3);
+        }
+        else
+        {
+            PushError(-224, "Illegal parameter value");
+        }
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "INITiate[:IMMediate]:ACQuire"))
+    {
+        if (mAcqState == kAcquisitionArmed || mAcqState == kAcquisitionMeasuring)
+        {
+            PushError(-213, "Init ignored");
+        }
+        else
+        {
+            mAcqVoltage.clear();
+            mAcqCurrent.clear();
+            mAcqState = mAcqBus ? kAcquisitionArmed : kAcquisitionMeasuring;
+            mAcqStart = std::chrono::steady_clock::now();
+        }
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "TRIGger:ACQuire[:IMMediate]"))
+    {
+        if (mAcqState != kAcquisitionArmed)
+        {
+            PushError(-211, "Trigger ignored");
+        }
+        else
+        {
+            mAcqState = kAcquisitionMeasuring;
+            mAcqStart = std::chrono::steady_clock::now();
+        }
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "ABORt:ACQuire"))
+    {
+        if (mAcqState == kAcquisitionArmed || mAcqState == kAcquisitionMeasuring)
+        {
+            mAcqState = kAcquisitionIdle;
+        }
+    }
+    else if (sMatchNodes(header.nodes, 0, "FORMat[:DATA]"))
+    {
+        std::vector<std::string> parameters = sSplitParameters(parameter);
+        if (header.query)
+        {
+            *reply += mFormatReal ? "REAL,32\n" : "ASC\n";
+        }
+        else if (parameters.size() == 1 && sMatchMnemonic(parameters[0], "ASCii", 5))
+        {
+            mFormatReal = false;
+        }
+        else if (sMatchMnemonic(parameters[0], "REAL", 4)
+                 && (parameters.size() == 1 || (parameters.size() == 2 && parameters[1] == "32")))
+        {
+            mFormatReal = true;
+        }
+        else
+        {
+            PushError(-224, "Illegal parameter value");
+        }
+    }
+    else if (header.query && (sMatchNodes(header.nodes, 0, "FETCh[:SCALar]:ARRay:VOLTage[:DC]")
+                              || sMatchNodes(header.nodes, 0, "FETCh[:SCALar]:ARRay:CURRent[:DC]")))
+    {
+        if (mAcqState != kAcquisitionDone)
+        {
+            PushError(-230, "Data corrupt or stale");
+        }
+        else
+        {
+            bool volts = sMatchNodes(header.nodes, 0, "FETCh[:SCALar]:ARRay:VOLTage[:DC]");
+            AppendArray(volts ? mAcqVoltage : mAcqCurrent, reply);
+        }
+    }
+    else if (sMatchNodes(header.nodes, 0, "LIST:STEP"))
+    {
+        if (header.query)
+        {
+            AppendInteger((int)mListEdit.size(), reply);
+        }
+        else if (!sParseNumber(parameter, &value))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (value < 1.0 || value > SIM_LIST_STEPS)
+        {
+            PushError(-222, "Data out of range");
+        }
+        else if (CheckRemote())
+        {
+            ListStep step = {0.0, SIM_MAX_CURRENT, 1.0};
+            mListEdit.resize((size_t)value, step);
+        }
+    }
+    else if (sMatchNodes(header.nodes, 0, "LIST:VOLTage"))
+    {
+        EditList(header, parameter, 0, reply);
+    }
+    else if (sMatchNodes(header.nodes, 0, "LIST:CURRent"))
+    {
+        EditList(header, parameter, 1, reply);
+    }
+    else if (sMatchNodes(header.nodes, 0, "LIST:WIDth"))
+    {
+        EditList(header, parameter, 2, reply);
+    }
+    else if (sMatchNodes(header.nodes, 0, "LIST:COUNt"))
+    {
+        if (header.query)
+        {
+            AppendInteger((int)mListCount, reply);
+        }
+        else if (!sParseNumber(parameter, &value))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (value < 1.0 || value > SIM_LIST_MAX_COUNT)
+        {
+            PushError(-222, "Data out of range");
+        }
+        else if (CheckRemote())
+        {
+            mListCount = (uint32_t)value;
+        }
+    }
+    else if (!header.query && (sMatchNodes(header.nodes, 0, "LIST:SAVe") || sMatchNodes(header.nodes, 0, "LIST:RECall")))
+    {
+        bool save = sMatchNodes(header.nodes, 0, "LIST:SAVe");
+        if (!sParseNumber(parameter, &value))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (value < 1.0 || value > SIM_LIST_SLOTS)
+        {
+            PushError(-222, "Data out of range");
+        }
+        else if (!save && mListSlots[(size_t)value - 1].empty())
+        {
+            PushError(-221, "Settings conflict"); /* nothing saved there */
+        }
+        else if (CheckRemote())
+        {
+            if (save)
+            {
+                mListSlots[(size_t)value - 1] = mListEdit;
+            }
+            else
+            {
+                mListEdit = mListSlots[(size_t)value - 1];
+            }
+        }
+    }
+    else if (sMatchNodes(header.nodes, 0, "LIST[:STATe]"))
+    {
+        if (header.query)
+        {
+            *reply += mListOn ? "1\n" : "0\n";
+        }
+        else if (!sParseBoolean(parameter, &state))
+        {
+            PushError(-104, "Data type error");
+        }
+        else if (CheckRemote())
+        {
+            mListOn = state;
+            mListTriggered = mListTriggered && state;
+        }
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "TRIGger:SOURce"))
+    {
+        std::string upper;
+        for (size_t i = 0; i < parameter.size(); i++)
+        {
+            upper += (char)toupper((unsigned char)parameter[i]);
+        }
+        if (upper != "BUS")
+        {
+            PushError(-224, "Illegal parameter value"); /* only *TRG and TRIG start a list here */
+        }
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "TRIGger[:IMMediate]"))
+    {
+        Trigger();
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "ABORt"))
+    {
+        mListTriggered = false;
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "SYSTem:REMote"))
+    {
+        mRemote = true;
+    }
+    else if (!header.query && sMatchNodes(header.nodes, 0, "SYSTem:LOCal"))
+    {
+        mRemote = false;
+    }
+    else if (header.query && sMatchNodes(header.nodes, 0, "SYSTem:ERRor[:NEXT]"))
+    {
+        if (mErrors.empty())
+        {
+            *reply += "0,\"No error\"\n";
+        }
+        else
+        {
+            *reply += mErrors.front() + "\n";
+            mErrors.pop_front();
+        }
+    }
+    else
+    {
+        PushError(-113, "Undefined header");
+    }
+}
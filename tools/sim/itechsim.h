@@ -0,0 +1,187 @@
+/**
+ * @file itechsim.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Simulated ITECH DC power supply for hardware-free testing.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#ifndef ITECHSIM_H
+#define ITECHSIM_H
+
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Questionable status bits of the simulated supply, the ones TripProtection takes. */
+#define SIM_QUES_OVP 0x0001 /* over voltage protection  */
+#define SIM_QUES_OCP 0x0002 /* over current protection  */
+#define SIM_QUES_OTP 0x0010 /* over temperature         */
+
+/* Operation status bit of a running list (SCPI: program running). */
+#define SIM_OPER_LIST 0x4000
+/* Steps of one list, and the lists saved by "LIST:SAV". */
+#define SIM_LIST_STEPS 100
+#define SIM_LIST_SLOTS 10
+
+/* Operation status bits of an acquisition waiting for its trigger and measuring. */
+#define SIM_OPER_WTG_MEAS 0x0008
+#define SIM_OPER_MEAS     0x0010
+/* Points of one acquisition, and its shortest and longest interval, s. */
+#define SIM_ACQ_POINTS       65536
+#define SIM_ACQ_MIN_INTERVAL 0.00001
+#define SIM_ACQ_MAX_INTERVAL 3600.0
+
+/**
+ * @brief SCPI model of an ITECH DC supply driving a resistive load.
+ *
+ * The supply regulates the output voltage (CV) until the load would draw more
+ * than the current setting, then it regulates the current (CC). All methods
+ * are thread safe, one simulator can be shared by several endpoints.
+ *
+ * The status registers follow IEEE 488.2 and SCPI: the standard event
+ * register (*ESR?, enabled by *ESE) and the questionable register
+ * (STAT:QUES?, enabled by STAT:QUES:ENAB) are summarized in the status
+ * byte, and the supply requests service when an enabled summary bit
+ * (*SRE) comes up.
+ *
+ * LIST mode follows the ITECH list subsystem: "LIST:STEP", "LIST:VOLT",
+ * "LIST:CURR" and "LIST:WID" edit a list of up to SIM_LIST_STEPS steps,
+ * "LIST:SAV" and "LIST:RCL" keep it in one of SIM_LIST_SLOTS slots. With
+ * "LIST:STAT ON" a trigger ("*TRG", "TRIG") runs the list "LIST:COUN"
+ * times; STAT:OPER:COND? has SIM_OPER_LIST set while it runs, after that
+ * the output holds the last step until "LIST:STAT OFF" or "ABOR".
+ *
+ * The acquisition digitizes "SENS:SWE:POIN" points "SENS:SWE:TINT" apart.
+ * "INIT:ACQ" starts it, or with "TRIG:ACQ:SOUR BUS" arms it for "TRIG:ACQ"
+ * or "*TRG"; STAT:OPER:COND? has SIM_OPER_WTG_MEAS set while it is armed
+ * and SIM_OPER_MEAS while it measures. Then "FETC:ARR:VOLT?" and
+ * "FETC:ARR:CURR?" return the points, in the "FORM" ASCii or REAL,32 (a
+ * definite length block of big endian floats). The points are measured when
+ * the next message or TripProtection arrives, with the state they had.
+ */
+class ItechSimulator
+{
+public:
+    ItechSimulator();
+
+    /*
+     * Process one program message. Several commands may be separated by ';'.
+     * The replies of all queries are appended to reply, each terminated by
+     * a line feed.
+     */
+    void Process(const std::string& message, std::string* reply);
+
+    /* Back to the power-on state, the configuration below is kept. */
+    void Reset();
+
+    void SetLoadResistance(double ohms);
+    /* Reject setting commands until "SYST:REM" was received (RS232 behaviour). */
+    void SetRequireRemote(bool required);
+    /* Time spent processing each program message. */
+    void SetResponseDelayUs(uint32_t microseconds);
+    /* Rise and fall of the output voltage in V/s, 0 (default): at once. */
+    void SetSlewRate(double voltsPerSecond);
+
+    double   MeasuredVoltage() const;
+    double   MeasuredCurrent() const;
+    bool     Output() const;
+    uint64_t MessageCount() const;
+
+    /* Trip protection (SIM_QUES_* bits): the output goes off until "OUTP:PROT:CLE". */
+    void TripProtection(uint16_t bits);
+    /* The supply asserts SRQ, until the status byte is read by a serial poll. */
+    bool ServiceRequested() const;
+    /* Serial poll: the status byte with RQS, clears the request. */
+    uint8_t SerialPoll();
+
+private:
+    struct Header;
+
+    typedef std::chrono::steady_clock::time_point Time;
+
+    enum AcquisitionState
+    {
+        kAcquisitionIdle,
+        kAcquisitionArmed,
+        kAcquisitionMeasuring,
+        kAcquisitionDone,
+    };
+
+    struct ListStep
+    {
+        double voltage;
+        double current;
+        double width; /* s */
+    };
+
+    void Execute(const std::string& command, std::string* reply);
+    void PushError(int code, const char* text);
+    bool CheckRemote();
+    void Measure(double* voltage, double* current, Time at) const;
+    double OutputVoltage(Time at) const;
+    void StartRamp(double from);
+    void AppendNumber(double value, std::string* reply) const;
+    void AppendInteger(int value, std::string* reply) const;
+    void AccessRegister(const Header& header, const std::string& parameter, uint8_t* value, std::string* reply);
+    uint8_t StatusByte() const;
+    void UpdateRequest();
+    bool ListSettings(double* voltage, double* current, Time at) const;
+    bool ListRunning(Time at) const;
+    void Trigger();
+    void EditList(const Header& header, const std::string& parameter, int field, std::string* reply);
+    void ResetAcquisition();
+    void Acquire(Time now);
+    void AppendArray(const std::vector<float>& points, std::string* reply) const;
+
+    mutable std::mutex      mMutex;
+    std::deque<std::string> mErrors;
+
+    double   mVoltageSetting;
+    double   mCurrentSetting;
+    bool     mOutput;
+    bool     mRemote;
+
+    uint8_t  mEventStatus;   /* *ESR?          */
+    uint8_t  mEventEnable;   /* *ESE           */
+    uint8_t  mServiceEnable; /* *SRE           */
+    uint16_t mQuesCondition; /* STAT:QUES:COND */
+    uint16_t mQuesEvent;     /* STAT:QUES?     */
+    uint16_t mQuesEnable;    /* STAT:QUES:ENAB */
+    bool     mSummary;       /* an enabled bit of the status byte is set */
+    bool     mRequest;       /* SRQ asserted, not polled yet */
+
+    double   mLoadResistance;
+    bool     mRequireRemote;
+    uint32_t mResponseDelayUs;
+    double   mSlewRate;
+
+    double   mRampFrom; /* the output voltage ramps from here to the setting */
+    std::chrono::steady_clock::time_point mRampStart;
+    uint64_t mMessageCount;
+
+    std::vector<ListStep> mListEdit;                /* edited by LIST:STEP/VOLT/CURR/WID */
+    std::vector<ListStep> mListSlots[SIM_LIST_SLOTS];
+    uint32_t              mListCount;               /* LIST:COUN */
+    bool                  mListOn;                  /* LIST:STAT */
+    std::vector<ListStep> mListRun;                 /* the list triggered last */
+    uint32_t              mListRunCount;
+    bool                  mListTriggered;
+    std::chrono::steady_clock::time_point mListStart;
+
+    uint32_t           mAcqPoints;   /* SENS:SWE:POIN */
+    double             mAcqInterval; /* SENS:SWE:TINT, s */
+    bool               mAcqBus;      /* TRIG:ACQ:SOUR BUS */
+    bool               mFormatReal;  /* FORM REAL,32 */
+    AcquisitionState   mAcqState;
+    Time               mAcqStart;
+    std::vector<float> mAcqVoltage;
+    std::vector<float> mAcqCurrent;
+};
+
+#endif
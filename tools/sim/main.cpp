@@ -0,0 +1,118 @@
+/**
+ * @file main.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief itechsim: serves a simulated ITECH DC supply on a pty and/or TCP port.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "itechsim.h"
+#include "simserver.h"
+
+static volatile sig_atomic_t gStop = 0;
+
+static void sOnSignal(int signal)
+{
+    (void)signal;
+    gStop = 1;
+}
+
+static void sUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--pty] [--tcp <port>] [--load <ohms>] [--delay-us <us>] [--slew <V/s>]\n"
+            "          [--require-remote]\n"
+            "  --pty             serve on a pseudo terminal\n"
+            "  --tcp <port>      serve on 127.0.0.1:<port>, 0 picks a free port\n"
+            "  --load <ohms>     resistive load on the output (default 10)\n"
+            "  --delay-us <us>   processing time per program message\n"
+            "  --slew <V/s>      rise and fall of the output voltage (default 0: at once)\n"
+            "  --require-remote  reject settings before SYST:REM, like the RS232 interface\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    bool pty = false;
+    int tcpPort = -1;
+    ItechSimulator simulator;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--pty") == 0)
+        {
+            pty = true;
+        }
+        else if (strcmp(argv[i], "--tcp") == 0 && i + 1 < argc)
+        {
+            tcpPort = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc)
+        {
+            simulator.SetLoadResistance(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--delay-us") == 0 && i + 1 < argc)
+        {
+            simulator.SetResponseDelayUs((uint32_t)strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--slew") == 0 && i + 1 < argc)
+        {
+            simulator.SetSlewRate(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--require-remote") == 0)
+        {
+            simulator.SetRequireRemote(true);
+        }
+        else
+        {
+            sUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!pty && tcpPort < 0)
+    {
+        sUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    SimServer server(&simulator);
+    if (pty)
+    {
+        std::string path = server.StartPty();
+        if (path.empty())
+        {
+            fprintf(stderr, "Could not open a pseudo terminal.\n");
+            return EXIT_FAILURE;
+        }
+        printf("ASRL%s::INSTR\n", path.c_str());
+    }
+    if (tcpPort >= 0)
+    {
+        int port = server.StartTcp(tcpPort);
+        if (port < 0)
+        {
+            fprintf(stderr, "Could not listen on port %d.\n", tcpPort);
+            return EXIT_FAILURE;
+        }
+        printf("TCPIP::127.0.0.1::%d::SOCKET\n", port);
+    }
+    fflush(stdout);
+
+    signal(SIGINT, sOnSignal);
+    signal(SIGTERM, sOnSignal);
+    while (!gStop)
+    {
+        pause();
+    }
+
+    server.Stop();
+    return EXIT_SUCCESS;
+}
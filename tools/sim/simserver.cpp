@@ -0,0 +1,234 @@
+/**
+ * @file simserver.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Serves the ITECH simulator on a pseudo terminal or a localhost TCP port.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "simserver.h"
+
+#define SIM_POLL_MS 100
+
+SimServer::SimServer(ItechSimulator* simulator)
+    : mSimulator(simulator),
+      mRunning(true),
+      mPtyMaster(-1),
+      mPtySlave(-1),
+      mListenFd(-1)
+{
+}
+
+SimServer::~SimServer()
+{
+    Stop();
+}
+
+void SimServer::ServeFd(int fd)
+{
+    std::string line;
+    std::string reply;
+
+    while (mRunning)
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ready = poll(&pfd, 1, SIM_POLL_MS);
+        if (ready < 0 && errno != EINTR)
+        {
+            break;
+        }
+        if (ready <= 0)
+        {
+            continue;
+        }
+
+        char chunk[256];
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0)
+        {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN))
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (ssize_t i = 0; i < n; i++)
+        {
+            if (chunk[i] == '\r')
+            {
+                continue;
+            }
+            if (chunk[i] != '\n')
+            {
+                line += chunk[i];
+                continue;
+            }
+
+            reply.clear();
+            mSimulator->Process(line, &reply);
+            line.clear();
+
+            size_t done = 0;
+            while (done < reply.size())
+            {
+                ssize_t w = write(fd, reply.data() + done, reply.size() - done);
+                if (w < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return;
+                }
+                done += (size_t)w;
+            }
+        }
+    }
+}
+
+std::string SimServer::StartPty()
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0)
+    {
+        return "";
+    }
+    if (grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        close(master);
+        return "";
+    }
+    std::string path(ptsname(master));
+
+    /*
+     * Raw mode, otherwise the line discipline echoes the commands back. The
+     * slave stays open until Stop: with no slave open the master reports a
+     * hang up and the server would end before the first client came.
+     */
+    int slave = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (slave < 0)
+    {
+        close(master);
+        return "";
+    }
+    struct termios tio;
+    if (tcgetattr(slave, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+    }
+
+    mPtyMaster = master;
+    mPtySlave = slave;
+    mThreads.push_back(std::thread(&SimServer::ServeFd, this, master));
+    return path;
+}
+
+int SimServer::StartTcp(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((uint16_t)port);
+    socklen_t length = sizeof(address);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 4) != 0
+        || getsockname(fd, (struct sockaddr*)&address, &length) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    mListenFd = fd;
+    mThreads.push_back(std::thread(&SimServer::AcceptLoop, this));
+    return ntohs(address.sin_port);
+}
+
+void SimServer::AcceptLoop()
+{
+    /*
+     * Every client gets a thread of its own: a node keeps its session open,
+     * and a call opening a second one would wait for it forever.
+     */
+    std::vector<std::thread> clients;
+    while (mRunning)
+    {
+        struct pollfd pfd;
+        pfd.fd = mListenFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, SIM_POLL_MS) <= 0)
+        {
+            continue;
+        }
+
+        int client = accept(mListenFd, nullptr, nullptr);
+        if (client < 0)
+        {
+            continue;
+        }
+        int one = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        clients.push_back(std::thread([this, client]() {
+            ServeFd(client);
+            close(client);
+        }));
+    }
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        clients[i].join();
+    }
+}
+
+void SimServer::Stop()
+{
+    mRunning = false;
+    for (size_t i = 0; i < mThreads.size(); i++)
+    {
+        mThreads[i].join();
+    }
+    mThreads.clear();
+
+    if (mPtyMaster >= 0)
+    {
+        close(mPtyMaster);
+        mPtyMaster = -1;
+    }
+    if (mPtySlave >= 0)
+    {
+        close(mPtySlave);
+        mPtySlave = -1;
+    }
+    if (mListenFd >= 0)
+    {
+        close(mListenFd);
+        mListenFd = -1;
+    }
+}
+
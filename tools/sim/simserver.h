@@ -0,0 +1,52 @@
+/**
+ * @file simserver.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Serves the ITECH simulator on a pseudo terminal or a localhost TCP port.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#ifndef SIMSERVER_H
+#define SIMSERVER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "itechsim.h"
+
+/**
+ * @brief Serves a simulator on a pseudo terminal and/or a localhost TCP port.
+ *
+ * Every endpoint and every TCP client runs its own thread. The protocol is
+ * line based: each line is one program message, replies are written back
+ * terminated by a line feed.
+ */
+class SimServer
+{
+public:
+    explicit SimServer(ItechSimulator* simulator);
+    ~SimServer();
+
+    /* Returns the slave device path, e.g. "/dev/pts/3", or "" on failure. */
+    std::string StartPty();
+    /* Port 0 picks a free port. Returns the port or -1 on failure. */
+    int StartTcp(int port);
+    void Stop();
+
+private:
+    void ServeFd(int fd);
+    void AcceptLoop();
+
+    ItechSimulator*          mSimulator;
+    std::atomic<bool>        mRunning;
+    int                      mPtyMaster;
+    int                      mPtySlave; /* kept open, see StartPty */
+    int                      mListenFd;
+    std::vector<std::thread> mThreads;
+};
+
+#endif
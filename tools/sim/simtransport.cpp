@@ -0,0 +1,389 @@
+/**
+ * @file simtransport.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Endpoints that connect the ITECH simulator to the transport layer.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <new>
+
+#include "simtransport.h"
+
+static ItechSimulator* gSimulator = nullptr;
+static std::string     gEndpoint;
+
+// ============================================================================
+// SimTransport
+// ============================================================================
+
+SimTransport::SimTransport(ItechSimulator* simulator, TransportKind kind)
+    : mSimulator(simulator),
+      mKind(kind)
+{
+}
+
+const char* SimTransport::CommandTerminator() const
+{
+    return mKind == kTransportSerial ? "\n" : "";
+}
+
+TransportStatus SimTransport::DoDiscover(std::vector<std::string>* resources)
+{
+    resources->push_back(mKind == kTransportSerial ? SIM_SERIAL_RESOURCE : SIM_USB_RESOURCE);
+    return kTransportOk;
+}
+
+TransportStatus SimTransport::DoOpen(const char* resource)
+{
+    const char* expected = (mKind == kTransportSerial) ? SIM_SERIAL_RESOURCE : SIM_USB_RESOURCE;
+    if (strcmp(resource, expected) != 0)
+    {
+        return kTransportErrorNotFound;
+    }
+    mPending.clear();
+    mReply.clear();
+    return kTransportOk;
+}
+
+TransportStatus SimTransport::DoWrite(const char* data, size_t length, size_t* written)
+{
+    *written = length;
+    if (mKind != kTransportSerial)
+    {
+        /* USBTMC: one write is one message, the terminator is optional. */
+        std::string message(data, length);
+        while (!message.empty() && (message[message.size() - 1] == '\n' || message[message.size() - 1] == '\r'))
+        {
+            message.erase(message.size() - 1);
+        }
+        mSimulator->Process(message, &mReply);
+        return kTransportOk;
+    }
+
+    mPending.append(data, length);
+    size_t end;
+    while ((end = mPending.find('\n')) != std::string::npos)
+    {
+        std::string message = mPending.substr(0, end);
+        if (!message.empty() && message[message.size() - 1] == '\r')
+        {
+            message.erase(message.size() - 1);
+        }
+        mSimulator->Process(message, &mReply);
+        mPending.erase(0, end + 1);
+    }
+    return kTransportOk;
+}
+
+TransportStatus SimTransport::DoReadUntil(char* buffer, size_t capacity, char termChar, size_t* count)
+{
+    if (mReply.empty())
+    {
+        /* Nothing queued: a real instrument would time out. */
+        return kTransportErrorTimeout;
+    }
+
+    size_t end = mReply.find(termChar);
+    size_t length = (end == std::string::npos) ? mReply.size() : end + 1;
+    if (length > capacity)
+    {
+        length = capacity;
+    }
+    memcpy(buffer, mReply.data(), length);
+    mReply.erase(0, length);
+    *count = length;
+    return kTransportOk;
+}
+
+TransportStatus SimTransport::DoRead(char* buffer, size_t length, size_t* count)
+{
+    size_t available = mReply.size() < length ? mReply.size() : length;
+    memcpy(buffer, mReply.data(), available);
+    mReply.erase(0, available);
+    *count = available;
+    return available == length ? kTransportOk : kTransportErrorTimeout;
+}
+
+TransportStatus SimTransport::DoFlush()
+{
+    mPending.clear();
+    mReply.clear();
+    return kTransportOk;
+}
+
+TransportStatus SimTransport::DoClose()
+{
+    return kTransportOk;
+}
+
+// ============================================================================
+// StreamTransport
+// ============================================================================
+
+StreamTransport::StreamTransport(const char* resource, uint32_t timeoutMs)
+    : mEndpoint(resource),
+      mTimeoutMs(timeoutMs),
+      mFd(-1)
+{
+}
+
+StreamTransport::~StreamTransport()
+{
+    Close();
+}
+
+TransportStatus StreamTransport::DoDiscover(std::vector<std::string>* resources)
+{
+    resources->push_back(mEndpoint);
+    return kTransportOk;
+}
+
+static int sConnectTcp(const std::string& host, const std::string& port)
+{
+    struct addrinfo hints;
+    struct addrinfo* list = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &list) != 0)
+    {
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo* entry = list; entry != nullptr; entry = entry->ai_next)
+    {
+        fd = socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (connect(fd, entry->ai_addr, entry->ai_addrlen) == 0)
+        {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(list);
+    return fd;
+}
+
+static int sOpenTerminal(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+TransportStatus StreamTransport::DoOpen(const char* resource)
+{
+    std::string text(resource);
+    const std::string tcpPrefix("TCPIP::");
+    const std::string asrlPrefix("ASRL");
+    const std::string instrSuffix("::INSTR");
+
+    if (text.compare(0, tcpPrefix.size(), tcpPrefix) == 0)
+    {
+        /* TCPIP::<host>::<port>::SOCKET */
+        size_t hostEnd = text.find("::", tcpPrefix.size());
+        size_t portEnd = (hostEnd == std::string::npos) ? std::string::npos : text.find("::", hostEnd + 2);
+        if (portEnd == std::string::npos)
+        {
+            return kTransportErrorNotFound;
+        }
+        mFd = sConnectTcp(text.substr(tcpPrefix.size(), hostEnd - tcpPrefix.size()),
+                          text.substr(hostEnd + 2, portEnd - hostEnd - 2));
+    }
+    else if (text.compare(0, asrlPrefix.size(), asrlPrefix) == 0 && text.size() > asrlPrefix.size() + instrSuffix.size()
+             && text.compare(text.size() - instrSuffix.size(), instrSuffix.size(), instrSuffix) == 0)
+    {
+        /* ASRL<device path>::INSTR */
+        mFd = sOpenTerminal(text.substr(asrlPrefix.size(), text.size() - asrlPrefix.size() - instrSuffix.size()));
+    }
+    else
+    {
+        return kTransportErrorNotFound;
+    }
+
+    mReceived.clear();
+    return mFd < 0 ? kTransportErrorNotFound : kTransportOk;
+}
+
+TransportStatus StreamTransport::DoWrite(const char* data, size_t length, size_t* written)
+{
+    *written = 0;
+    while (*written < length)
+    {
+        ssize_t n = write(mFd, data + *written, length - *written);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return kTransportErrorIo;
+        }
+        *written += (size_t)n;
+    }
+    return kTransportOk;
+}
+
+TransportStatus StreamTransport::DoReadUntil(char* buffer, size_t capacity, char termChar, size_t* count)
+{
+    for (;;)
+    {
+        size_t end = mReceived.find(termChar);
+        if (end != std::string::npos || mReceived.size() >= capacity)
+        {
+            size_t length = (end == std::string::npos) ? capacity : end + 1;
+            if (length > capacity)
+            {
+                length = capacity;
+            }
+            memcpy(buffer, mReceived.data(), length);
+            mReceived.erase(0, length);
+            *count = length;
+            return kTransportOk;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = mFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ready = poll(&pfd, 1, (int)mTimeoutMs);
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready <= 0)
+        {
+            return ready == 0 ? kTransportErrorTimeout : kTransportErrorIo;
+        }
+
+        char chunk[256];
+        ssize_t n = read(mFd, chunk, sizeof(chunk));
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return kTransportErrorIo;
+        }
+        mReceived.append(chunk, (size_t)n);
+    }
+}
+
+TransportStatus StreamTransport::DoRead(char* buffer, size_t length, size_t* count)
+{
+    while (mReceived.size() < length)
+    {
+        struct pollfd pfd;
+        pfd.fd = mFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ready = poll(&pfd, 1, (int)mTimeoutMs);
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready <= 0)
+        {
+            return ready == 0 ? kTransportErrorTimeout : kTransportErrorIo;
+        }
+
+        char chunk[4096];
+        ssize_t n = read(mFd, chunk, sizeof(chunk));
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return kTransportErrorIo;
+        }
+        mReceived.append(chunk, (size_t)n);
+    }
+    memcpy(buffer, mReceived.data(), length);
+    mReceived.erase(0, length);
+    *count = length;
+    return kTransportOk;
+}
+
+TransportStatus StreamTransport::DoFlush()
+{
+    mReceived.clear();
+    if (isatty(mFd))
+    {
+        tcflush(mFd, TCIOFLUSH);
+    }
+    return kTransportOk;
+}
+
+TransportStatus StreamTransport::DoClose()
+{
+    if (mFd >= 0)
+    {
+        close(mFd);
+        mFd = -1;
+    }
+    return kTransportOk;
+}
+
+TransportStatus StreamTransport::DoSetTimeout(uint32_t timeoutMs, uint32_t* previous)
+{
+    *previous = mTimeoutMs;
+    mTimeoutMs = timeoutMs;
+    return kTransportOk;
+}
+
+// ============================================================================
+// Transport factories
+// ============================================================================
+
+static Transport* sCreateSimTransport(TransportKind kind)
+{
+    return new (std::nothrow) SimTransport(gSimulator, kind);
+}
+
+static Transport* sCreateStreamTransport(TransportKind kind)
+{
+    (void)kind;
+    return new (std::nothrow) StreamTransport(gEndpoint.c_str(), 5000);
+}
+
+void AttachSimulator(ItechSimulator* simulator)
+{
+    gSimulator = simulator;
+    SetTransportFactory(simulator != nullptr ? sCreateSimTransport : nullptr);
+}
+
+void AttachStreamEndpoint(const char* resource)
+{
+    gEndpoint = (resource != nullptr) ? resource : "";
+    SetTransportFactory(resource != nullptr ? sCreateStreamTransport : nullptr);
+}
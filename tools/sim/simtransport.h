@@ -0,0 +1,89 @@
+/**
+ * @file simtransport.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Endpoints that connect the ITECH simulator to the transport layer.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#ifndef SIMTRANSPORT_H
+#define SIMTRANSPORT_H
+
+#include <string>
+#include <vector>
+
+#include "transport.h"
+#include "itechsim.h"
+
+/* Resource names reported by the in-memory endpoint. */
+#define SIM_USB_RESOURCE    "USB0::0x2EC7::0x6700::SIM0001::INSTR"
+#define SIM_SERIAL_RESOURCE "ASRL1::INSTR"
+
+/**
+ * @brief In-memory endpoint, the transport calls straight into the simulator.
+ *
+ * A USB endpoint treats every write as one program message like USBTMC does,
+ * a serial endpoint collects bytes until a line feed.
+ */
+class SimTransport : public Transport
+{
+public:
+    SimTransport(ItechSimulator* simulator, TransportKind kind);
+
+    virtual const char* CommandTerminator() const;
+
+protected:
+    virtual TransportStatus DoDiscover(std::vector<std::string>* resources);
+    virtual TransportStatus DoOpen(const char* resource);
+    virtual TransportStatus DoWrite(const char* data, size_t length, size_t* written);
+    virtual TransportStatus DoReadUntil(char* buffer, size_t capacity, char termChar, size_t* count);
+    virtual TransportStatus DoRead(char* buffer, size_t length, size_t* count);
+    virtual TransportStatus DoFlush();
+    virtual TransportStatus DoClose();
+
+private:
+    ItechSimulator* mSimulator;
+    TransportKind   mKind;
+    std::string     mPending;  /* serial: bytes of an unterminated message */
+    std::string     mReply;    /* replies not read yet */
+};
+
+/**
+ * @brief Client side of a pty or localhost TCP endpoint.
+ *
+ * Resources are "ASRL<device path>::INSTR" for a terminal device (for example
+ * "ASRL/dev/pts/3::INSTR") and "TCPIP::<host>::<port>::SOCKET" for TCP.
+ */
+class StreamTransport : public Transport
+{
+public:
+    StreamTransport(const char* resource, uint32_t timeoutMs);
+    virtual ~StreamTransport();
+
+    virtual const char* CommandTerminator() const { return "\n"; }
+
+protected:
+    virtual TransportStatus DoDiscover(std::vector<std::string>* resources);
+    virtual TransportStatus DoOpen(const char* resource);
+    virtual TransportStatus DoWrite(const char* data, size_t length, size_t* written);
+    virtual TransportStatus DoReadUntil(char* buffer, size_t capacity, char termChar, size_t* count);
+    virtual TransportStatus DoRead(char* buffer, size_t length, size_t* count);
+    virtual TransportStatus DoFlush();
+    virtual TransportStatus DoClose();
+    virtual TransportStatus DoSetTimeout(uint32_t timeoutMs, uint32_t* previous);
+
+private:
+    std::string mEndpoint;
+    uint32_t    mTimeoutMs;
+    int         mFd;
+    std::string mReceived; /* bytes read past the last termination character */
+};
+
+/* Route CreateTransport() to the in-memory simulator, nullptr detaches. */
+void AttachSimulator(ItechSimulator* simulator);
+/* Route CreateTransport() to a pty or TCP endpoint, nullptr detaches. */
+void AttachStreamEndpoint(const char* resource);
+
+#endif
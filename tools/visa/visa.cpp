@@ -0,0 +1,562 @@
+/**
+ * @file visa.cpp
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Stand-in VISA library that routes every session to a simulated instrument.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "visa.h"
+#include "visasim.h"
+
+/**
+ * @brief Any object a ViObject handle can refer to.
+ */
+struct VisaObject
+{
+    enum Type
+    {
+        kResourceManager,
+        kFindList,
+        kInstrument,
+        kEvent
+    };
+
+    VisaObject(Type objectType)
+        : type(objectType),
+          next(0),
+          simulator(nullptr),
+          serial(false),
+          termCharEnabled(false),
+          termChar('\n'),
+          endIn(VI_ASRL_END_TERMCHAR),
+          timeout(2000),
+          srqQueue(false)
+    {
+    }
+
+    Type type;
+    std::mutex mutex;
+
+    /* kFindList */
+    std::vector<std::string> found;
+    size_t next;
+
+    /* kInstrument */
+    std::string     resource;
+    ItechSimulator* simulator;
+    bool            serial;
+    std::string     pending;  /* serial: bytes of an unterminated message */
+    std::string     reply;    /* replies not read yet */
+    bool            termCharEnabled;
+    ViByte          termChar;
+    ViUInt16        endIn;    /* serial: VI_ASRL_END_TERMCHAR stops a read like termCharEnabled */
+    ViUInt32        timeout;
+    bool            srqQueue; /* VI_EVENT_SERVICE_REQ enabled for VI_QUEUE */
+};
+
+typedef std::shared_ptr<VisaObject> VisaObjectPtr;
+
+static std::mutex                              gMutex;
+static std::map<ViObject, VisaObjectPtr>       gObjects;
+static std::map<std::string, ItechSimulator*>  gBindings;
+static ViObject                                gNextObject = 1;
+
+static ViObject sAdd(const VisaObjectPtr& object)
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    ViObject handle = gNextObject++;
+    gObjects[handle] = object;
+    return handle;
+}
+
+static VisaObjectPtr sFind(ViObject handle, VisaObject::Type type)
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    std::map<ViObject, VisaObjectPtr>::iterator it = gObjects.find(handle);
+    if (it == gObjects.end() || it->second->type != type)
+    {
+        return VisaObjectPtr();
+    }
+    return it->second;
+}
+
+static bool sIsSerial(const std::string& resource)
+{
+    return resource.size() >= 4 && strncasecmp(resource.c_str(), "ASRL", 4) == 0;
+}
+
+/*
+ * VISA resource expressions: '?' matches one character, "?*" any sequence.
+ * The comparison is case insensitive.
+ */
+static bool sMatchExpression(const char* expression, const char* text)
+{
+    if (*expression == '\0')
+    {
+        return *text == '\0';
+    }
+    if (expression[0] == '?' && expression[1] == '*')
+    {
+        for (const char* rest = text;; rest++)
+        {
+            if (sMatchExpression(expression + 2, rest))
+            {
+                return true;
+            }
+            if (*rest == '\0')
+            {
+                return false;
+            }
+        }
+    }
+    if (*text == '\0')
+    {
+        return false;
+    }
+    if (*expression == '?' || toupper((unsigned char)*expression) == toupper((unsigned char)*text))
+    {
+        return sMatchExpression(expression + 1, text + 1);
+    }
+    return false;
+}
+
+void VisaSimBind(const char* resource, ItechSimulator* simulator)
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (simulator == nullptr)
+    {
+        gBindings.erase(resource);
+    }
+    else
+    {
+        gBindings[resource] = simulator;
+    }
+}
+
+void VisaSimUnbindAll()
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    gBindings.clear();
+}
+
+ViStatus _VI_FUNC viOpenDefaultRM(ViSession* vi)
+{
+    *vi = sAdd(std::make_shared<VisaObject>(VisaObject::kResourceManager));
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viFindRsrc(ViSession sesn, ViConstString expr, ViFindList* vi, ViUInt32* retCnt, ViChar desc[])
+{
+    if (!sFind(sesn, VisaObject::kResourceManager))
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+
+    VisaObjectPtr list = std::make_shared<VisaObject>(VisaObject::kFindList);
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        for (std::map<std::string, ItechSimulator*>::iterator it = gBindings.begin(); it != gBindings.end(); ++it)
+        {
+            if (!sIsSerial(it->first) && sMatchExpression(expr, it->first.c_str()))
+            {
+                list->found.push_back(it->first);
+            }
+        }
+    }
+
+    if (retCnt != nullptr)
+    {
+        *retCnt = (ViUInt32)list->found.size();
+    }
+    if (list->found.empty())
+    {
+        return VI_ERROR_RSRC_NFOUND;
+    }
+
+    strncpy(desc, list->found[0].c_str(), VI_FIND_BUFLEN - 1);
+    desc[VI_FIND_BUFLEN - 1] = '\0';
+    list->next = 1;
+    if (vi != nullptr)
+    {
+        *vi = sAdd(list);
+    }
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viFindNext(ViFindList vi, ViChar desc[])
+{
+    VisaObjectPtr list = sFind(vi, VisaObject::kFindList);
+    if (!list)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+    std::lock_guard<std::mutex> lock(list->mutex);
+    if (list->next >= list->found.size())
+    {
+        return VI_ERROR_RSRC_NFOUND;
+    }
+    strncpy(desc, list->found[list->next++].c_str(), VI_FIND_BUFLEN - 1);
+    desc[VI_FIND_BUFLEN - 1] = '\0';
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viOpen(ViSession sesn, ViConstRsrc name, ViAccessMode mode, ViUInt32 timeout, ViSession* vi)
+{
+    (void)mode;
+    (void)timeout;
+
+    if (!sFind(sesn, VisaObject::kResourceManager))
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+
+    VisaObjectPtr instr = std::make_shared<VisaObject>(VisaObject::kInstrument);
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        std::map<std::string, ItechSimulator*>::iterator it = gBindings.find(name);
+        if (it == gBindings.end())
+        {
+            return VI_ERROR_RSRC_NFOUND;
+        }
+        instr->simulator = it->second;
+    }
+    instr->resource = name;
+    instr->serial = sIsSerial(instr->resource);
+
+    *vi = sAdd(instr);
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viClose(ViObject vi)
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (gObjects.erase(vi) == 0)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viSetAttribute(ViObject vi, ViAttr attrName, ViAttrState attrValue)
+{
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+
+    std::lock_guard<std::mutex> lock(instr->mutex);
+    switch (attrName)
+    {
+    case VI_ATTR_TERMCHAR:
+        instr->termChar = (ViByte)attrValue;
+        return VI_SUCCESS;
+    case VI_ATTR_TERMCHAR_EN:
+        instr->termCharEnabled = (attrValue != VI_FALSE);
+        return VI_SUCCESS;
+    case VI_ATTR_TMO_VALUE:
+        instr->timeout = (ViUInt32)attrValue;
+        return VI_SUCCESS;
+    case VI_ATTR_ASRL_END_IN:
+        if (!instr->serial)
+        {
+            return VI_ERROR_NSUP_ATTR;
+        }
+        instr->endIn = (ViUInt16)attrValue;
+        return VI_SUCCESS;
+    case VI_ATTR_ASRL_BAUD:
+    case VI_ATTR_ASRL_DATA_BITS:
+    case VI_ATTR_ASRL_PARITY:
+    case VI_ATTR_ASRL_STOP_BITS:
+        return instr->serial ? VI_SUCCESS : VI_ERROR_NSUP_ATTR;
+    default:
+        return VI_ERROR_NSUP_ATTR;
+    }
+}
+
+ViStatus _VI_FUNC viGetAttribute(ViObject vi, ViAttr attrName, void* attrValue)
+{
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+
+    std::lock_guard<std::mutex> lock(instr->mutex);
+    switch (attrName)
+    {
+    case VI_ATTR_TERMCHAR:
+        *(ViUInt8*)attrValue = instr->termChar;
+        return VI_SUCCESS;
+    case VI_ATTR_TERMCHAR_EN:
+        *(ViBoolean*)attrValue = instr->termCharEnabled ? VI_TRUE : VI_FALSE;
+        return VI_SUCCESS;
+    case VI_ATTR_TMO_VALUE:
+        *(ViUInt32*)attrValue = instr->timeout;
+        return VI_SUCCESS;
+    default:
+        return VI_ERROR_NSUP_ATTR;
+    }
+}
+
+ViStatus _VI_FUNC viWrite(ViSession vi, ViConstBuf buf, ViUInt32 cnt, ViUInt32* retCnt)
+{
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+
+    std::lock_guard<std::mutex> lock(instr->mutex);
+    if (retCnt != nullptr)
+    {
+        *retCnt = cnt;
+    }
+
+    if (!instr->serial)
+    {
+        /* USBTMC: one write is one message, the terminator is optional. */
+        std::string message((const char*)buf, cnt);
+        while (!message.empty() && (message[message.size() - 1] == '\n' || message[message.size() - 1] == '\r'))
+        {
+            message.erase(message.size() - 1);
+        }
+        instr->simulator->Process(message, &instr->reply);
+        return VI_SUCCESS;
+    }
+
+    instr->pending.append((const char*)buf, cnt);
+    size_t end;
+    while ((end = instr->pending.find('\n')) != std::string::npos)
+    {
+        std::string message = instr->pending.substr(0, end);
+        if (!message.empty() && message[message.size() - 1] == '\r')
+        {
+            message.erase(message.size() - 1);
+        }
+        instr->simulator->Process(message, &instr->reply);
+        instr->pending.erase(0, end + 1);
+    }
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viRead(ViSession vi, ViBuf buf, ViUInt32 cnt, ViUInt32* retCnt)
+{
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+
+    std::lock_guard<std::mutex> lock(instr->mutex);
+    if (retCnt != nullptr)
+    {
+        *retCnt = 0;
+    }
+    if (instr->reply.empty())
+    {
+        /* Nothing queued: a real instrument would time out. */
+        return VI_ERROR_TMO;
+    }
+
+    /*
+     * Every reply line ends a USBTMC message (END), on a serial port the read
+     * only stops at the termination character if it is enabled or is the
+     * end of input (VI_ATTR_ASRL_END_IN, the default).
+     */
+    char term = instr->serial ? (char)instr->termChar : '\n';
+    bool stop = !instr->serial || instr->termCharEnabled || instr->endIn == VI_ASRL_END_TERMCHAR;
+    size_t end = stop ? instr->reply.find(term) : std::string::npos;
+    size_t length = (end == std::string::npos) ? instr->reply.size() : end + 1;
+    ViStatus status = (end != std::string::npos && instr->termCharEnabled) ? VI_SUCCESS_TERM_CHAR : VI_SUCCESS;
+    if (length > cnt)
+    {
+        length = cnt;
+        status = VI_SUCCESS_MAX_CNT;
+    }
+
+    memcpy(buf, instr->reply.data(), length);
+    instr->reply.erase(0, length);
+    if (retCnt != nullptr)
+    {
+        *retCnt = (ViUInt32)length;
+    }
+    return status;
+}
+
+ViStatus _VI_FUNC viFlush(ViSession vi, ViUInt16 mask)
+{
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+
+    std::lock_guard<std::mutex> lock(instr->mutex);
+    if (mask & VI_READ_BUF_DISCARD)
+    {
+        instr->reply.clear();
+    }
+    if (mask & VI_WRITE_BUF_DISCARD)
+    {
+        instr->pending.clear();
+    }
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viClear(ViSession vi)
+{
+    return viFlush(vi, VI_READ_BUF_DISCARD | VI_WRITE_BUF_DISCARD);
+}
+
+ViStatus _VI_FUNC viReadSTB(ViSession vi, ViUInt16* status)
+{
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+
+    std::lock_guard<std::mutex> lock(instr->mutex);
+    if (!instr->serial)
+    {
+        /* USBTMC READ_STATUS_BYTE on the control endpoint, it clears the request. */
+        *status = instr->simulator->SerialPoll();
+        return VI_SUCCESS;
+    }
+
+    /* No serial poll on RS232: VISA asks "*STB?" and parses the reply. */
+    std::string reply;
+    instr->simulator->Process("*STB?", &reply);
+    *status = (ViUInt16)strtoul(reply.c_str(), nullptr, 10);
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viEnableEvent(ViSession vi, ViEventType eventType, ViUInt16 mechanism, ViEventFilter context)
+{
+    (void)context;
+
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+    if (eventType != VI_EVENT_SERVICE_REQ || instr->serial)
+    {
+        return VI_ERROR_INV_EVENT; /* an RS232 supply has no SRQ line */
+    }
+    if (mechanism != VI_QUEUE)
+    {
+        return VI_ERROR_INV_MECH;
+    }
+
+    std::lock_guard<std::mutex> lock(instr->mutex);
+    if (instr->srqQueue)
+    {
+        return VI_SUCCESS_EVENT_EN;
+    }
+    instr->srqQueue = true;
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viDisableEvent(ViSession vi, ViEventType eventType, ViUInt16 mechanism)
+{
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+    if (eventType != VI_EVENT_SERVICE_REQ && eventType != VI_ALL_ENABLED_EVENTS)
+    {
+        return VI_ERROR_INV_EVENT;
+    }
+    if ((mechanism & VI_QUEUE) == 0)
+    {
+        return VI_ERROR_INV_MECH;
+    }
+
+    std::lock_guard<std::mutex> lock(instr->mutex);
+    if (!instr->srqQueue)
+    {
+        return VI_SUCCESS_EVENT_DIS;
+    }
+    instr->srqQueue = false;
+    return VI_SUCCESS;
+}
+
+ViStatus _VI_FUNC viDiscardEvents(ViSession vi, ViEventType eventType, ViUInt16 mechanism)
+{
+    (void)eventType;
+    (void)mechanism;
+
+    /* Nothing is queued: a request stays with the simulator until it is polled. */
+    return sFind(vi, VisaObject::kInstrument) ? VI_SUCCESS : VI_ERROR_INV_OBJECT;
+}
+
+/*
+ * The simulator raises a request from whichever thread talks to it, so the
+ * wait looks at it every millisecond the way the USB interrupt endpoint
+ * would be serviced.
+ */
+ViStatus _VI_FUNC viWaitOnEvent(ViSession vi, ViEventType inEventType, ViUInt32 timeout, ViEventType* outEventType,
+                                ViEvent* outContext)
+{
+    VisaObjectPtr instr = sFind(vi, VisaObject::kInstrument);
+    if (!instr)
+    {
+        return VI_ERROR_INV_OBJECT;
+    }
+    if (inEventType != VI_EVENT_SERVICE_REQ && inEventType != VI_ALL_ENABLED_EVENTS)
+    {
+        return VI_ERROR_INV_EVENT;
+    }
+    {
+        std::lock_guard<std::mutex> lock(instr->mutex);
+        if (!instr->srqQueue)
+        {
+            return VI_ERROR_NENABLED;
+        }
+    }
+
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    while (!instr->simulator->ServiceRequested())
+    {
+        if (timeout != VI_TMO_INFINITE && std::chrono::steady_clock::now() >= deadline)
+        {
+            return VI_ERROR_TMO;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (outEventType != nullptr)
+    {
+        *outEventType = VI_EVENT_SERVICE_REQ;
+    }
+    VisaObjectPtr event = std::make_shared<VisaObject>(VisaObject::kEvent);
+    ViEvent handle = sAdd(event);
+    if (outContext != nullptr)
+    {
+        *outContext = handle;
+    }
+    else
+    {
+        viClose(handle);
+    }
+    return VI_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file visa.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Stand-in for the VISA header, covering the part of the API this dll uses.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ * Only used by the host builds in tools/. The Windows build keeps using the
+ * visa.h shipped with NI-VISA. Type sizes, constants and function signatures
+ * are the ones of the VISA specification (VPP-4.3).
+ */
+#ifndef __VISA_HEADER__
+#define __VISA_HEADER__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define _VI_FUNC
+
+typedef uint32_t        ViUInt32;
+typedef int32_t         ViInt32;
+typedef uint16_t        ViUInt16;
+typedef int16_t         ViInt16;
+typedef uint8_t         ViUInt8;
+typedef uint64_t        ViUInt64;
+typedef ViUInt16        ViBoolean;
+typedef char            ViChar;
+typedef unsigned char   ViByte;
+typedef ViByte*         ViBuf;
+typedef const ViByte*   ViConstBuf;
+typedef ViChar*         ViString;
+typedef const ViChar*   ViConstString;
+typedef ViString        ViRsrc;
+typedef ViConstString   ViConstRsrc;
+typedef ViInt32         ViStatus;
+typedef ViUInt32        ViObject;
+typedef ViObject        ViSession;
+typedef ViObject        ViFindList;
+typedef ViObject        ViEvent;
+typedef ViUInt32        ViAttr;
+typedef ViUInt32        ViEventType;
+typedef ViUInt16        ViEventFilter;
+typedef ViUInt32        ViAccessMode;
+#if defined(_WIN64) || defined(__LP64__)
+typedef ViUInt64        ViAttrState;
+#else
+typedef ViUInt32        ViAttrState;
+#endif
+
+#define VI_NULL                 0
+#define VI_TRUE                 ((ViBoolean)1)
+#define VI_FALSE                ((ViBoolean)0)
+#define VI_FIND_BUFLEN          256
+#define VI_TMO_IMMEDIATE        0x00000000UL
+#define VI_TMO_INFINITE         0xFFFFFFFFUL
+
+/* Completion and error codes */
+#define VI_SUCCESS              0
+#define VI_SUCCESS_EVENT_EN     ((ViStatus)0x3FFF0002)
+#define VI_SUCCESS_EVENT_DIS    ((ViStatus)0x3FFF0003)
+#define VI_SUCCESS_TERM_CHAR    ((ViStatus)0x3FFF0005)
+#define VI_SUCCESS_MAX_CNT      ((ViStatus)0x3FFF0006)
+#define VI_ERROR_SYSTEM_ERROR   ((ViStatus)0xBFFF0000)
+#define VI_ERROR_INV_OBJECT     ((ViStatus)0xBFFF000E)
+#define VI_ERROR_RSRC_NFOUND    ((ViStatus)0xBFFF0011)
+#define VI_ERROR_INV_RSRC_NAME  ((ViStatus)0xBFFF0012)
+#define VI_ERROR_TMO            ((ViStatus)0xBFFF0015)
+#define VI_ERROR_NSUP_ATTR      ((ViStatus)0xBFFF001D)
+#define VI_ERROR_INV_EVENT      ((ViStatus)0xBFFF0026)
+#define VI_ERROR_INV_MECH       ((ViStatus)0xBFFF0027)
+#define VI_ERROR_NENABLED       ((ViStatus)0xBFFF0032)
+#define VI_ERROR_IO             ((ViStatus)0xBFFF003E)
+#define VI_ERROR_NSUP_OPER      ((ViStatus)0xBFFF0067)
+
+/* Attributes */
+#define VI_ATTR_TERMCHAR        0x3FFF0018UL
+#define VI_ATTR_TMO_VALUE       0x3FFF001AUL
+#define VI_ATTR_ASRL_BAUD       0x3FFF0021UL
+#define VI_ATTR_ASRL_DATA_BITS  0x3FFF0022UL
+#define VI_ATTR_ASRL_PARITY     0x3FFF0023UL
+#define VI_ATTR_ASRL_STOP_BITS  0x3FFF0024UL
+#define VI_ATTR_TERMCHAR_EN     0x3FFF0038UL
+#define VI_ATTR_ASRL_END_IN     0x3FFF00B3UL
+
+#define VI_ASRL_PAR_NONE        0
+#define VI_ASRL_PAR_ODD         1
+#define VI_ASRL_PAR_EVEN        2
+#define VI_ASRL_PAR_MARK        3
+#define VI_ASRL_PAR_SPACE       4
+
+#define VI_ASRL_STOP_ONE        10
+#define VI_ASRL_STOP_ONE5       15
+#define VI_ASRL_STOP_TWO        20
+
+#define VI_ASRL_END_NONE        0
+#define VI_ASRL_END_LAST_BIT    1
+#define VI_ASRL_END_TERMCHAR    2
+
+/* Events and the mechanisms they are delivered by */
+#define VI_EVENT_SERVICE_REQ    0x3FFF200BUL
+#define VI_ALL_ENABLED_EVENTS   0x3FFF7FFFUL
+#define VI_QUEUE                1
+#define VI_HNDLR                2
+#define VI_SUSPEND_HNDLR        4
+#define VI_ALL_MECH             0xFFFF
+
+/* viFlush masks */
+#define VI_READ_BUF             1
+#define VI_WRITE_BUF            2
+#define VI_READ_BUF_DISCARD     4
+#define VI_WRITE_BUF_DISCARD    8
+
+ViStatus _VI_FUNC viOpenDefaultRM(ViSession* vi);
+ViStatus _VI_FUNC viFindRsrc(ViSession sesn, ViConstString expr, ViFindList* vi, ViUInt32* retCnt, ViChar desc[]);
+ViStatus _VI_FUNC viFindNext(ViFindList vi, ViChar desc[]);
+ViStatus _VI_FUNC viOpen(ViSession sesn, ViConstRsrc name, ViAccessMode mode, ViUInt32 timeout, ViSession* vi);
+ViStatus _VI_FUNC viClose(ViObject vi);
+ViStatus _VI_FUNC viSetAttribute(ViObject vi, ViAttr attrName, ViAttrState attrValue);
+ViStatus _VI_FUNC viGetAttribute(ViObject vi, ViAttr attrName, void* attrValue);
+ViStatus _VI_FUNC viWrite(ViSession vi, ViConstBuf buf, ViUInt32 cnt, ViUInt32* retCnt);
+ViStatus _VI_FUNC viRead(ViSession vi, ViBuf buf, ViUInt32 cnt, ViUInt32* retCnt);
+ViStatus _VI_FUNC viFlush(ViSession vi, ViUInt16 mask);
+ViStatus _VI_FUNC viClear(ViSession vi);
+ViStatus _VI_FUNC viReadSTB(ViSession vi, ViUInt16* status);
+ViStatus _VI_FUNC viEnableEvent(ViSession vi, ViEventType eventType, ViUInt16 mechanism, ViEventFilter context);
+ViStatus _VI_FUNC viDisableEvent(ViSession vi, ViEventType eventType, ViUInt16 mechanism);
+ViStatus _VI_FUNC viDiscardEvents(ViSession vi, ViEventType eventType, ViUInt16 mechanism);
+ViStatus _VI_FUNC viWaitOnEvent(ViSession vi, ViEventType inEventType, ViUInt32 timeout, ViEventType* outEventType,
+                                ViEvent* outContext);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * @file visasim.h
+ * @author Huang Dong (dohuang@borgwarner.com)
+ * @brief Binds simulated instruments to resource names of the stand-in VISA.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023 MIT
+ *
+ */
+#ifndef VISASIM_H
+#define VISASIM_H
+
+#include "itechsim.h"
+
+/*
+ * Make a simulator reachable under a VISA resource name. USB resources are
+ * returned by viFindRsrc, serial ones ("ASRLn::INSTR") can only be opened.
+ * A nullptr simulator removes the binding.
+ */
+void VisaSimBind(const char* resource, ItechSimulator* simulator);
+/* Remove all bindings. */
+void VisaSimUnbindAll();
+
+#endif